@@ -43,6 +43,7 @@ class AdtfCoreMediaSampleSerializer: public SampleSerializer
         std::string getId() const override;
         void setStreamType(const StreamType& stream_type) override;
         void serialize(const WriteSample& sample, OutputStream& stream) override;
+        bool getSerializedSize(const WriteSample& sample, size_t& serialized_size) override;
 
     private:
         class Implementation;
@@ -42,6 +42,7 @@ class MediaDescriptionSerializer: public SampleSerializer
         std::string getId() const override;
         void setStreamType(const StreamType& stream_type) override;
         void serialize(const WriteSample& sample, OutputStream& stream) override;
+        bool getSerializedSize(const WriteSample& sample, size_t& serialized_size) override;
 
     private:
         class Implementation;
@@ -61,6 +62,7 @@ class MediaDescriptionSerializerNs: public SampleSerializer
         std::string getId() const override;
         void setStreamType(const StreamType& stream_type) override;
         void serialize(const WriteSample& sample, OutputStream& stream) override;
+        bool getSerializedSize(const WriteSample& sample, size_t& serialized_size) override;
 
     private:
         class Implementation;
@@ -37,6 +37,7 @@ class SampleCopySerializer: public SampleSerializer
         std::string getId() const override;
         void setStreamType(const StreamType& stream_type) override;
         void serialize(const WriteSample& sample, OutputStream& stream) override;
+        bool getSerializedSize(const WriteSample& sample, size_t& serialized_size) override;
 };
 
 class SampleCopySerializerNs: public SampleSerializer
@@ -48,6 +49,7 @@ class SampleCopySerializerNs: public SampleSerializer
         std::string getId() const override;
         void setStreamType(const StreamType& stream_type) override;
         void serialize(const WriteSample& sample, OutputStream& stream) override;
+        bool getSerializedSize(const WriteSample& sample, size_t& serialized_size) override;
 };
 
 
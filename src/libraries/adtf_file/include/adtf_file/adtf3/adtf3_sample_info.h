@@ -57,7 +57,8 @@ struct HashValueStorage   //16 Byte per key value pair
     HashValueStorage():
         storage_version(getVersion()),
         byte_size(0),
-        type(HashedValueType::hvt_invalid)
+        type(HashedValueType::hvt_invalid),
+        reserved{0}
     {
     }
 
@@ -71,6 +72,7 @@ struct HashValueStorage   //16 Byte per key value pair
 #pragma pack(pop)
 
 bool hasSampleInfo(const WriteSample& sample);
+size_t getSampleInfoSize(const WriteSample& sample);
 void serializeSampleInfo(const WriteSample& sample, OutputStream& stream);
 
 void deserializeSampleInfo(ReadSample& sample, InputStream& stream);
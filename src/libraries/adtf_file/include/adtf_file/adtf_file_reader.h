@@ -24,6 +24,7 @@
 #include <chrono>
 #include <memory>
 #include <vector>
+#include <set>
 #include <unordered_map>
 #include <istream>
 #include <string>
@@ -31,6 +32,7 @@
 #include "stream_item.h"
 #include "object.h"
 #include "default_sample.h"
+#include "sample_view.h"
 #include "stream_type.h"
 
 namespace adtf_file
@@ -58,6 +60,16 @@ class InputStream
     public:
         virtual void read(void* destination, size_t count) = 0;
 
+        /**
+         * Skips data and returns a pointer to it, if the stream is able to do so without a copy.
+         * @param count The amount of data.
+         * @return The data or nullptr if it has to be read instead.
+         */
+        virtual const void* borrow(size_t /*count*/)
+        {
+            return nullptr;
+        }
+
         template <typename T>
         InputStream& operator >>(T& value)
         {
@@ -121,6 +133,14 @@ class SampleDeserializer
         virtual void deserialize(ReadSample& sample, InputStream& stream) = 0;
 };
 
+/**
+ * Reads the buffer of a sample, without a copy if both the stream and the sample allow it.
+ * @param sample The sample.
+ * @param stream The stream to read from.
+ * @param buffer_size The size of the sample buffer.
+ */
+void readSampleBuffer(ReadSample& sample, InputStream& stream, size_t buffer_size);
+
 class SampleDeserializerFactory: public Object
 {
     public:
@@ -201,6 +221,17 @@ class FileItem
         std::shared_ptr<const StreamItem> stream_item;
 };
 
+/**
+ * An item that refers to data owned by the reader, it is only valid until the next item is read.
+ */
+class FileItemView
+{
+    public:
+        uint16_t stream_id;
+        std::chrono::nanoseconds time_stamp;
+        const StreamItem* stream_item;
+};
+
 class Reader
 {
     public:
@@ -227,6 +258,10 @@ class Reader
         const std::vector<Stream>& getStreams() const;
         uint64_t getItemCount() const;
 
+        /**
+         * @return The index of the first item at or after the given time. Seeking to this index
+         * via seekTo also skips the samples of container chunks that are earlier than the time.
+         */
         uint64_t getItemIndexForTimeStamp(std::chrono::nanoseconds time_stamp);
         uint64_t getItemIndexForStreamItemIndex(uint16_t stream_id, uint64_t stream_item_index);
         std::shared_ptr<const StreamType> getStreamTypeBefore(uint64_t item_index, uint16_t stream_id, bool update_sample_deserializer);
@@ -234,6 +269,21 @@ class Reader
         void seekTo(uint64_t item_index);
         FileItem getNextItem();
 
+        /**
+         * Reads the next item without allocating memory for it. Samples are reused and refer
+         * to the payload within the read buffer whenever possible. Stream types are built as
+         * with getNextItem.
+         * @return The item, it is only valid until the next item is read.
+         */
+        const FileItemView& getNextItemView();
+
+        /**
+         * Restricts getNextItem to the given streams. The data of all other chunks is skipped
+         * without being read.
+         * @param stream_ids The ids of the streams to read, an empty set selects all streams.
+         */
+        void setStreamFilter(const std::set<uint16_t>& stream_ids);
+
         /**
          * @return the index of the next item, or -1 if the file is empty.
          */
@@ -241,9 +291,15 @@ class Reader
 
     private:
         std::shared_ptr<const StreamType> buildType(const std::string& id, InputStream& stream);
+        std::shared_ptr<const StreamItem> buildSample(SampleDeserializer& sample_deserializer, InputStream& stream);
+        /// @return nullptr if the next item is a sample of a container, see nextPackedSample
+        ifhd::v500::ChunkHeader* queryNextItem(SampleDeserializer** sample_deserializer);
+        void readPackedSamples(ifhd::v500::ChunkHeader* chunk_header, SampleDeserializer* sample_deserializer);
+        bool hasPackedSample();
+        const void* nextPackedSample(size_t& data_size, timestamp_t& time_stamp);
         std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer>> getInitialTypeAndSampleDeserializer(uint16_t stream_id);
         std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer> > getInitialTypeAndSampleFactoryAdtf2(InputStream& stream);
-        std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer>> getInitialTypeAndSampleFactoryAdtf3(InputStream& stream);
+        std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer>> getInitialTypeAndSampleFactoryAdtf3(InputStream& stream, uint16_t stream_id);
         std::chrono::nanoseconds fromFileTimeStamp(timestamp_t time_stamp);
         timestamp_t toFileTimeStamp(std::chrono::nanoseconds time_stamp);
 
@@ -256,6 +312,29 @@ class Reader
         std::unordered_map<size_t, std::shared_ptr<SampleDeserializer>> _stream_sample_deserializers;
         std::shared_ptr<SampleFactory> _sample_factory;
         std::shared_ptr<StreamTypeFactory> _stream_type_factory;
+        FileItemView _item_view;
+        SampleView _sample_view;
+        Trigger _trigger;
+        std::shared_ptr<const StreamType> _item_view_type;
+
+        /// The container chunk whose samples are currently read
+        struct PackedSamples
+        {
+            std::vector<uint8_t> data;
+            uint16_t stream_id = 0;
+            SampleDeserializer* sample_deserializer = nullptr;
+            uint32_t sample_count = 0;
+            uint32_t next_sample = 0;
+            size_t next_data_offset = 0;
+            timestamp_t base_time_stamp = 0;
+        };
+
+        std::set<uint16_t> _packed_streams;
+        PackedSamples _packed_samples;
+        /// Samples of containers before this time are skipped after seeking to a timestamp
+        timestamp_t _skip_packed_samples_before;
+        uint64_t _time_stamp_seek_item_index;
+        timestamp_t _time_stamp_seek_time_stamp;
 };
 
 inline std::string getShortDescription(const std::string& description)
@@ -24,8 +24,11 @@
 #include <memory>
 #include <string>
 #include <chrono>
+#include <functional>
+#include <future>
 #include <unordered_map>
 #include <queue>
+#include <deque>
 #include <list>
 
 #include <ifhd/ifhd.h>
@@ -41,6 +44,16 @@ class OutputStream
     public:
         virtual void write(const void* data, size_t data_size) = 0;
 
+        /**
+         * Skips data and returns a pointer to its memory, so that it can be written in place.
+         * @param count The amount of data.
+         * @return The memory or nullptr if the data has to be written instead.
+         */
+        virtual void* reserveInPlace(size_t /*count*/)
+        {
+            return nullptr;
+        }
+
         template <typename T>
         OutputStream& operator<<(const T& value)
         {
@@ -113,6 +126,27 @@ class SampleSerializer
         virtual std::string getId() const = 0;
         virtual void setStreamType(const StreamType& stream_type) = 0;
         virtual void serialize(const WriteSample& sample, OutputStream& stream) = 0;
+
+        /**
+         * Determines the amount of data that @ref serialize will write for a sample, so that
+         * the destination can be allocated upfront. Support is optional.
+         * @param sample The sample.
+         * @param serialized_size The amount of data.
+         * @return Whether the serializer supports determining the size.
+         */
+        virtual bool getSerializedSize(const WriteSample& /*sample*/, size_t& /*serialized_size*/)
+        {
+            return false;
+        }
+
+        /**
+         * Serializes a sample into the given memory.
+         * @param sample The sample.
+         * @param destination The memory, its size has to be determined with @ref getSerializedSize.
+         * @param destination_size The size of the memory.
+         * @throw std::runtime_error if the serialized sample does not match the size of the memory.
+         */
+        void serializeInto(const WriteSample& sample, void* destination, size_t destination_size);
 };
 
 class SampleSerializerFactory: public Object
@@ -171,6 +205,13 @@ class Writer: private ifhd::v400::IndexedFileWriter::ChunkDroppedCallback
                 {
                     this->insert(end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + data_size);
                 }
+
+                void* reserveInPlace(size_t count) override
+                {
+                    size_t offset = size();
+                    resize(offset + count);
+                    return this->data() + offset;
+                }
         };
 
         class Chunk: public Buffer
@@ -199,6 +240,45 @@ class Writer: private ifhd::v400::IndexedFileWriter::ChunkDroppedCallback
             adtf3ns = 4
         };
 
+        /**
+         * Filters for the samples of containers, see setSamplePacking.
+         */
+        enum PackingFilter
+        {
+            packing_filter_none = 0x0,
+            /// every sample is stored as XOR with the previous one, unchanged bytes become zero
+            packing_filter_delta = 0x1,
+            /// the samples are transposed, so that the n-th bytes of all samples follow each other
+            packing_filter_shuffle = 0x2
+        };
+
+        /**
+         * Settings of the indexed files that are not covered by the constructor, see
+         * ifhd::v201_v301::IndexedFileWriter. They apply to all files of the writer, including
+         * the ones of setFileRolling and setPreTriggerBuffer.
+         */
+        struct IndexedFileSettings
+        {
+            IndexedFileSettings():
+                index_memory_limit(0),
+                index_journal_interval(std::chrono::seconds(1)),
+                progress_interval(std::chrono::milliseconds(100)),
+                live_tap_size(0)
+            {
+            }
+
+            /// see IndexedFileWriter::setIndexMemoryLimit, 0 for no limit
+            size_t index_memory_limit;
+            /// see IndexedFileWriter::setIndexJournalInterval, only used with om_index_journal
+            std::chrono::nanoseconds index_journal_interval;
+            /// see IndexedFileWriter::setProgressInterval, only used with om_publish_progress
+            std::chrono::nanoseconds progress_interval;
+            /// see IndexedFileWriter::setLiveTap, not supported in combination with several files
+            std::string live_tap_name;
+            /// the size of the ring buffer of the live tap
+            size_t live_tap_size;
+        };
+
     public:
         Writer() = delete;
         Writer(const std::string& file_name,
@@ -208,9 +288,22 @@ class Writer: private ifhd::v400::IndexedFileWriter::ChunkDroppedCallback
                size_t cache_size = 0,
                size_t cache_minimum_write_chunk_size = 0,
                size_t cache_maximum_write_chunk_size = 0,
-               uint32_t writer_flags = 0);
+               uint32_t writer_flags = 0,
+               const IndexedFileSettings& indexed_file_settings = IndexedFileSettings());
+
+        /**
+         * Calls close, errors are ignored.
+         */
         ~Writer();
 
+        /**
+         * Completes all files, including the ones that are still written or closed in the
+         * background, see setFileRolling and setPreTriggerBuffer. All files are completed even if
+         * one of them fails. The writer must not be used afterwards, further calls have no effect.
+         * @throw std::exception The first error that occurred while completing the files.
+         */
+        void close();
+
         Writer(const Writer&) = delete;
         Writer(Writer&&) = default;
 
@@ -222,6 +315,88 @@ class Writer: private ifhd::v400::IndexedFileWriter::ChunkDroppedCallback
         void write(size_t stream_id, std::chrono::nanoseconds time_stamp, const WriteSample& sample);
         void writeTrigger(size_t stream_id, std::chrono::nanoseconds time_stamp);
 
+        /**
+         * Packs the samples of a stream into container chunks, which saves the chunk and index
+         * overhead for streams with many small samples. A container is written as soon as one
+         * of the limits is reached, before stream types and triggers of the stream and when the
+         * file is closed. Readers see the samples of a container as a single item index.
+         * Only supported for ADTF 3 files and before the first sample of the stream is written.
+         * @param stream_id The stream.
+         * @param max_sample_count The maximum number of samples within a container.
+         * @param max_data_size The size of the serialized samples at which a container is written.
+         * @param max_duration The maximum time span of the samples within a container.
+         * @param filters PackingFilter flags, which make containers of fixed size samples (i.e. of
+         *                DDL structs) compress better, see setStreamCompression. They are only
+         *                applied to containers whose samples all have the same serialized size.
+         */
+        void setSamplePacking(size_t stream_id,
+                              size_t max_sample_count,
+                              size_t max_data_size,
+                              std::chrono::nanoseconds max_duration,
+                              uint32_t filters = packing_filter_none);
+
+        /**
+         * Compresses the chunks of a stream, readers decompress them transparently.
+         * Only supported for ADTF 3 files, see ifhd::v201_v301::IndexedFileWriter::setStreamCompression.
+         * @param stream_id The stream.
+         * @param codec The codec, see ifhd::v201_v301::isCompressionCodecAvailable.
+         * @param level The codec specific compression level, 0 selects the default.
+         */
+        void setStreamCompression(size_t stream_id,
+                                  ifhd::v400::CompressionCodec codec,
+                                  int level = 0);
+
+        /**
+         * Splits the recording into several files. As soon as one of the limits is reached, the
+         * current file is completed and the next item is written to a new file. Every file
+         * starts with the current stream types as initial types and contains all items written
+         * meanwhile. The following file is created in advance and the previous one is closed in
+         * the background, so that the switch does not block the writing thread.
+         * The files are named after the file given to the constructor with an appended part
+         * number, i.e. recording.dat, recording_001.dat, recording_002.dat and so on.
+         * Extensions are only stored in the last file.
+         * Not supported in combination with a history or a live tap.
+         * @param max_file_size The size of a file at which the next one is started, 0 for no limit.
+         * @param max_duration The time span of a file at which the next one is started, 0 for no limit.
+         */
+        void setFileRolling(uint64_t max_file_size, std::chrono::nanoseconds max_duration);
+
+        /**
+         * Keeps the items in memory instead of writing them to disk, only the items of the given
+         * time span or size before the latest one are retained, together with the stream types
+         * that are required to read them. Every call of @ref trigger writes the retained items
+         * and the ones of the following post-trigger window to a new file, so that the disk is
+         * only written around events. The windows of several events may overlap, every event
+         * gets a file of its own and the files are written by their own cache threads in parallel.
+         * The event files are named like the files of setFileRolling, the file given to the
+         * constructor only receives the stream information, the description and the extensions.
+         * Has to be set before the first sample is written, not supported in combination with
+         * a history, file rolling or a live tap.
+         * @param duration The time span of the items that are retained, 0 for no limit.
+         * @param max_size The size of the serialized items that are retained, 0 for no limit.
+         * @param post_trigger_duration The time span after the latest item at the time of the
+         *                              trigger whose items are added to the event file.
+         */
+        void setPreTriggerBuffer(std::chrono::nanoseconds duration,
+                                 size_t max_size,
+                                 std::chrono::nanoseconds post_trigger_duration);
+
+        /**
+         * Starts an event file with the items of the pre-trigger buffer, see setPreTriggerBuffer.
+         * The file is created and written by a thread of its own, so the call does not wait for
+         * the disk. The file is completed in the background as soon as an item after its
+         * post-trigger window is written, or when the writer is destroyed. Errors of the event
+         * file are reported by a later completion of an event or by close.
+         * @return The name of the event file.
+         */
+        std::string trigger();
+
+        /**
+         * @return The names of all files that have been started so far, see setFileRolling
+         *         and setPreTriggerBuffer.
+         */
+        std::vector<std::string> getFileNames() const;
+
         void quitHistory();
 
         std::shared_ptr<OutputStream> getExtensionStream(const std::string& name,
@@ -234,10 +409,78 @@ class Writer: private ifhd::v400::IndexedFileWriter::ChunkDroppedCallback
         void onChunkDropped(uint64_t index, uint16_t stream_id, uint16_t flags, timestamp_t time_stamp) override;
 
         Chunk serialize(size_t stream_id, std::chrono::nanoseconds time_stamp, const StreamType& type);
-        Chunk serialize(size_t stream_id, std::chrono::nanoseconds time_stamp, const WriteSample& sample);
         Chunk serializeTrigger(size_t stream_id, std::chrono::nanoseconds time_stamp);
 
         void write(const Chunk& chunk);
+        void checkChunkWrite() const;
+        void writePackedSample(size_t stream_id, timestamp_t time_stamp, const WriteSample& sample);
+        void writePackedSamples(size_t stream_id);
+        void writeAllPackedSamples();
+        timestamp_t getFileTimeStamp(std::chrono::nanoseconds time_stamp) const;
+
+        struct FileSettings
+        {
+            TargetADTFVersion adtf_version;
+            size_t cache_size;
+            size_t cache_minimum_write_chunk_size;
+            size_t cache_maximum_write_chunk_size;
+            uint32_t writer_flags;
+            IndexedFileSettings indexed_file;
+        };
+
+        static std::unique_ptr<CompatIndexedFileWriter> createFile(const std::string& file_name,
+                                                                   const FileSettings& settings,
+                                                                   std::chrono::nanoseconds history_duration,
+                                                                   ChunkDroppedCallback* drop_callback);
+        void prepareNextFile();
+        void rollFileIfRequired(timestamp_t time_stamp);
+
+        /// The name and the additional information of a stream, see getStreamInfos
+        struct StreamInfo
+        {
+            std::string name;
+            Buffer additional_info;
+        };
+
+        /**
+         * @param initial_types The initial types of the streams by stream id, streams without
+         *                      an entry use their current initial type.
+         * @return The information of all streams by stream id.
+         */
+        std::vector<StreamInfo> getStreamInfos(const std::vector<Buffer>& initial_types) const;
+        static void setStreamInfos(CompatIndexedFileWriter& file, const std::vector<StreamInfo>& stream_infos);
+
+        void closeInBackground(std::unique_ptr<CompatIndexedFileWriter> file);
+
+        /**
+         * Reports the error of the file that is completed in the background so far and keeps
+         * the given one instead, only one file is completed at a time.
+         */
+        void completeInBackground(std::future<void> completion);
+
+        /// A chunk of the pre-trigger buffer
+        struct BufferedChunk
+        {
+            uint16_t stream_id;
+            timestamp_t time_stamp;
+            uint32_t flags;
+            Buffer data;
+        };
+
+        void bufferChunk(BufferedChunk&& chunk);
+        void completeEvents(timestamp_t time_stamp);
+
+        /// The operations on an event file, run by the thread that writes the file
+        using EventTask = std::function<void(CompatIndexedFileWriter&)>;
+        struct EventQueue;
+
+        /**
+         * Waits for the prepared file and runs the tasks of an event on it until the event has
+         * been completed, then closes the file.
+         * @throw std::exception The first error of the file.
+         */
+        static void writeEventFile(std::shared_ptr<EventQueue> queue,
+                                   std::future<std::unique_ptr<CompatIndexedFileWriter>> next_file);
 
         void closeAdtf2();
         void closeAdtf3();
@@ -246,9 +489,11 @@ class Writer: private ifhd::v400::IndexedFileWriter::ChunkDroppedCallback
         std::unique_ptr<CompatIndexedFileWriter> _file;
         StreamTypeSerializers _type_serializers;
         TargetADTFVersion _target_adtf_version;
+        FileSettings _file_settings;
         size_t _stream_id_counter = 0;
         bool _history_active;
         bool _lock_chunk_write;
+        timestamp_t _last_time_stamp = 0;
 
         struct Stream
         {
@@ -257,11 +502,53 @@ class Writer: private ifhd::v400::IndexedFileWriter::ChunkDroppedCallback
             std::string adtf2_initial_type_id;
             std::shared_ptr<SampleSerializer> sample_serializer;
             std::list<Buffer> type_queue;
+            /// the last type written after the first sample, it becomes the initial type of the next file
+            Buffer current_type;
             bool has_samples = false;
+            ifhd::v400::CompressionCodec compression_codec = ifhd::v400::CompressionCodec::cc_none;
+            int compression_level = 0;
+
+            size_t packing_max_sample_count = 0;
+            size_t packing_max_data_size = 0;
+            timestamp_t packing_max_duration = 0;
+            Buffer packed_entries;
+            Buffer packed_data;
+            uint32_t packing_filters = packing_filter_none;
+            Buffer filtered_data;
+            uint32_t packed_sample_count = 0;
+            timestamp_t packed_base_time_stamp = 0;
         };
 
         std::vector<Stream> _streams;
         std::weak_ptr<OutputStream> _last_extension_stream;
+        std::string _description;
+
+        uint64_t _rolling_max_file_size = 0;
+        timestamp_t _rolling_max_duration = 0;
+        std::vector<std::string> _file_names;
+        timestamp_t _file_start_time_stamp = 0;
+        bool _file_has_chunks = false;
+        std::future<std::unique_ptr<CompatIndexedFileWriter>> _next_file;
+        std::future<void> _closing_file;
+
+        bool _pre_trigger_active = false;
+        timestamp_t _pre_trigger_duration = 0;
+        size_t _pre_trigger_max_size = 0;
+        timestamp_t _post_trigger_duration = 0;
+        /// shared with the event files whose writing threads have not written them yet
+        std::deque<std::shared_ptr<const BufferedChunk>> _pre_trigger_chunks;
+        size_t _pre_trigger_size = 0;
+
+        /// A file that receives the items of an event, see trigger
+        struct Event
+        {
+            std::shared_ptr<EventQueue> queue;
+            std::future<void> writing;
+            timestamp_t end_time_stamp;
+            /// the initial types at the time of the trigger, for streams that existed by then
+            std::vector<Buffer> initial_types;
+        };
+        std::list<Event> _events;
 };
 
 }
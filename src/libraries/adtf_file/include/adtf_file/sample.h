@@ -61,6 +61,18 @@ class ReadSample
         virtual void* beginBufferWrite(size_t size) = 0;
         virtual void endBufferWrite() = 0;
         virtual void addInfo(uint32_t key, DataType type, uint64_t raw_bytes) = 0;
+
+        /**
+         * Lets the sample refer to data of the reader instead of copying it via beginBufferWrite.
+         * The data is only valid until the next item is read.
+         * @param data The sample data.
+         * @param size The size of the sample data.
+         * @return Whether the sample refers to the data.
+         */
+        virtual bool referenceBuffer(const void* /*data*/, size_t /*size*/)
+        {
+            return false;
+        }
 };
 
 class WriteSample
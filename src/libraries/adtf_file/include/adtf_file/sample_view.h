@@ -0,0 +1,82 @@
+/**
+ * @file
+ * sample that refers to the data of the reader.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef ADTF_FILE_SAMPLE_VIEW
+#define ADTF_FILE_SAMPLE_VIEW
+
+#include "stream_item.h"
+#include "sample.h"
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace adtf_file
+{
+
+/**
+ * A sample that is reused for every item read by Reader::getNextItemView.
+ * Its buffer refers to the read buffer of the reader unless the data had to be converted.
+ */
+class SampleView: public Sample, public ReadSample, public WriteSample
+{
+    public:
+        void setTimeStamp(std::chrono::nanoseconds time_stamp) override;
+        void setSubStreamId(uint32_t substream_id) override;
+        void setFlags(uint32_t flags) override;
+        void* beginBufferWrite(size_t size) override;
+        void endBufferWrite() override;
+        void addInfo(uint32_t key, DataType type, uint64_t raw_bytes) override;
+        bool referenceBuffer(const void* data, size_t size) override;
+
+    public:
+        std::chrono::nanoseconds getTimeStamp() const override;
+        uint32_t getSubStreamId() const override;
+        uint32_t getFlags() const override;
+        std::pair<const void*, size_t> beginBufferRead() const override;
+        void endBufferRead() const override;
+        void iterateInfo(std::function<void(uint32_t key, DataType type, uint64_t raw_bytes)> functor) const override;
+
+    public:
+        /**
+         * Clears the sample for the next item, the allocated memory is kept.
+         */
+        void reset();
+
+    private:
+        struct Info
+        {
+            uint32_t key;
+            DataType type;
+            uint64_t raw_bytes;
+        };
+
+        std::chrono::nanoseconds _time_stamp = std::chrono::nanoseconds(0);
+        uint32_t _substream_id = 0;
+        uint32_t _flags = 0;
+        const void* _data = nullptr;
+        size_t _data_size = 0;
+        std::vector<uint8_t> _buffer;
+        std::vector<Info> _info;
+};
+
+}
+
+#endif
@@ -102,9 +102,7 @@ void AdtfCoreMediaSampleDeserializer::deserializeData(ReadSample& sample, InputS
     }
     else
     {
-        auto buffer = sample.beginBufferWrite(buffer_size);
-        stream.read(buffer, buffer_size);
-        sample.endBufferWrite();
+        readSampleBuffer(sample, stream, buffer_size);
     }
 }
 
@@ -45,6 +45,7 @@ class AdtfCoreMediaSampleSerializer::Implementation
 {
     public:
         ddl::CodecFactory codec_factory;
+        std::vector<uint8_t> serialized_buffer;
 };
 
 
@@ -82,15 +83,27 @@ void AdtfCoreMediaSampleSerializer::serialize(const WriteSample& sample, OutputS
                                                                     ddl::DataRepresentation::deserialized);
         A_UTIL5_RESULT_TO_EXCEPTION(decoder.isValid());
         auto serialized_size = decoder.getBufferSize(ddl::DataRepresentation::serialized);
-
-        std::vector<uint8_t> serialized_buffer(serialized_size);
-        auto codec = decoder.makeCodecFor(serialized_buffer.data(), serialized_size,
-                                          ddl::DataRepresentation::serialized);
-        A_UTIL5_RESULT_TO_EXCEPTION(ddl::serialization::transform(decoder, codec));
         stream << static_cast<uint32_t>(serialized_size)
                << static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sample.getTimeStamp()).count())
                << static_cast<uint32_t>(sample.getFlags());
-        stream.write(serialized_buffer.data(), serialized_size);
+
+        // transform in place if possible, otherwise via a buffer that is reused for all samples
+        auto serialized_data = static_cast<uint8_t*>(stream.reserveInPlace(serialized_size));
+        const bool in_place = serialized_data != nullptr;
+        if (!in_place)
+        {
+            _implementation->serialized_buffer.resize(serialized_size);
+            serialized_data = _implementation->serialized_buffer.data();
+        }
+
+        auto codec = decoder.makeCodecFor(serialized_data, serialized_size,
+                                          ddl::DataRepresentation::serialized);
+        A_UTIL5_RESULT_TO_EXCEPTION(ddl::serialization::transform(decoder, codec));
+
+        if (!in_place)
+        {
+            stream.write(serialized_data, serialized_size);
+        }
     }
     else
     {
@@ -101,6 +114,8 @@ void AdtfCoreMediaSampleSerializer::serialize(const WriteSample& sample, OutputS
         stream.write(buffer.first, buffer.second);
     }
 
+    sample.endBufferRead();
+
     //@todo sample_info will be hard to create info indexes for hash keys.
     uint32_t map_size = 0;
     stream << map_size;
@@ -109,6 +124,30 @@ void AdtfCoreMediaSampleSerializer::serialize(const WriteSample& sample, OutputS
     stream << sample_log_trace_present;
 }
 
+bool AdtfCoreMediaSampleSerializer::getSerializedSize(const WriteSample& sample, size_t& serialized_size)
+{
+    auto buffer = sample.beginBufferRead();
+
+    size_t data_size = buffer.second;
+    if (a_util::result::isOk(_implementation->codec_factory.isValid()))
+    {
+        auto decoder = _implementation->codec_factory.makeDecoderFor(buffer.first,
+                                                                    buffer.second,
+                                                                    ddl::DataRepresentation::deserialized);
+        A_UTIL5_RESULT_TO_EXCEPTION(decoder.isValid());
+        data_size = decoder.getBufferSize(ddl::DataRepresentation::serialized);
+    }
+
+    sample.endBufferRead();
+
+    serialized_size = sizeof(uint8_t) +
+                      sizeof(uint32_t) + sizeof(int64_t) + sizeof(uint32_t) +
+                      data_size +
+                      sizeof(uint32_t) +
+                      sizeof(uint8_t);
+    return true;
+}
+
 
 }
 }
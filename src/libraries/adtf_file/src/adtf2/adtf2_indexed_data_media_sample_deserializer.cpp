@@ -49,9 +49,7 @@ void IndexedDataMediaSampleDeserializer::deserialize(ReadSample& sample, InputSt
 
         buffer_size -= sizeof(nDataId);
 
-        auto buffer = sample.beginBufferWrite(buffer_size);
-        stream.read(buffer, buffer_size);
-        sample.endBufferWrite();
+        readSampleBuffer(sample, stream, buffer_size);
     }
 }
 
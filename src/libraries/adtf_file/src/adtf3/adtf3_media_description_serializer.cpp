@@ -60,6 +60,24 @@ class MediaDescriptionSerializerImplementation
             }
         }
 
+        size_t getSerializedSize(const WriteSample& sample)
+        {
+            auto buffer = sample.beginBufferRead();
+            size_t serialized_size = 0;
+            {
+                auto decoder = codec_factory.makeDecoderFor(buffer.first,
+                                                            buffer.second,
+                                                            ddl::DataRepresentation::deserialized);
+                serialized_size = decoder.getBufferSize(ddl::DataRepresentation::serialized);
+            }
+            sample.endBufferRead();
+
+            return sizeof(int64_t) +
+                   sizeof(uint32_t) +
+                   sizeof(uint64_t) + serialized_size +
+                   getSampleInfoSize(sample);
+        }
+
         void serialize(const WriteSample& sample, OutputStream& stream, int64_t time_stamp)
         {
             bool has_info = hasSampleInfo(sample);
@@ -80,13 +98,25 @@ class MediaDescriptionSerializerImplementation
                                                             buffer.second,
                                                             ddl::DataRepresentation::deserialized);
                 auto serialized_size = decoder.getBufferSize(ddl::DataRepresentation::serialized);
+                stream << static_cast<uint64_t>(serialized_size);
 
-                std::vector<uint8_t> serialized_buffer(serialized_size);
-                auto codec = decoder.makeCodecFor(serialized_buffer.data(), serialized_size,
+                // transform in place if possible, otherwise via a buffer that is reused for all samples
+                auto serialized_data = static_cast<uint8_t*>(stream.reserveInPlace(serialized_size));
+                const bool in_place = serialized_data != nullptr;
+                if (!in_place)
+                {
+                    serialized_buffer.resize(serialized_size);
+                    serialized_data = serialized_buffer.data();
+                }
+
+                auto codec = decoder.makeCodecFor(serialized_data, serialized_size,
                                                   ddl::DataRepresentation::serialized);
                 ddl::serialization::transform(decoder, codec);
-                stream << static_cast<uint64_t>(serialized_size);
-                stream.write(serialized_buffer.data(), serialized_size);
+
+                if (!in_place)
+                {
+                    stream.write(serialized_data, serialized_size);
+                }
             }
 
             sample.endBufferRead();
@@ -99,6 +129,7 @@ class MediaDescriptionSerializerImplementation
 
     private:
         ddl::CodecFactory codec_factory;
+        std::vector<uint8_t> serialized_buffer;
 };
 
 }
@@ -131,6 +162,12 @@ void MediaDescriptionSerializer::serialize(const WriteSample& sample, OutputStre
     _implementation->serialize(sample, stream, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sample.getTimeStamp()).count()));
 }
 
+bool MediaDescriptionSerializer::getSerializedSize(const WriteSample& sample, size_t& serialized_size)
+{
+    serialized_size = _implementation->getSerializedSize(sample);
+    return true;
+}
+
 class MediaDescriptionSerializerNs::Implementation: public MediaDescriptionSerializerImplementation
 {
 };
@@ -159,6 +196,12 @@ void MediaDescriptionSerializerNs::serialize(const WriteSample& sample, OutputSt
     _implementation->serialize(sample, stream, sample.getTimeStamp().count());
 }
 
+bool MediaDescriptionSerializerNs::getSerializedSize(const WriteSample& sample, size_t& serialized_size)
+{
+    serialized_size = _implementation->getSerializedSize(sample);
+    return true;
+}
+
 
 }
 }
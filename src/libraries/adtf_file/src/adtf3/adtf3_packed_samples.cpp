@@ -0,0 +1,257 @@
+/**
+ * @file
+ * adtf3 packed sample containers.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+#include "adtf3_packed_samples.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <tuple>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace adtf_file
+{
+
+namespace adtf3
+{
+
+namespace
+{
+
+/**
+ * Encodes the bytes [first_byte, end_byte) of the samples [first_sample, end_sample).
+ */
+void encodeRange(const uint8_t* samples, uint8_t* destination, size_t sample_size, size_t sample_count,
+                 bool delta, bool shuffle,
+                 size_t first_sample, size_t end_sample, size_t first_byte, size_t end_byte)
+{
+    for (size_t byte = first_byte; byte < end_byte; ++byte)
+    {
+        for (size_t sample = first_sample; sample < end_sample; ++sample)
+        {
+            uint8_t value = samples[sample * sample_size + byte];
+            if (delta && sample > 0)
+            {
+                value ^= samples[(sample - 1) * sample_size + byte];
+            }
+            destination[shuffle ? byte * sample_count + sample : sample * sample_size + byte] = value;
+        }
+    }
+}
+
+/**
+ * Decodes the bytes [first_byte, end_byte) of the samples [first_sample, end_sample).
+ * With the delta filter all previous samples have to be decoded already.
+ */
+void decodeRange(const uint8_t* encoded_samples, uint8_t* destination, size_t sample_size, size_t sample_count,
+                 bool delta, bool shuffle,
+                 size_t first_sample, size_t end_sample, size_t first_byte, size_t end_byte)
+{
+    for (size_t byte = first_byte; byte < end_byte; ++byte)
+    {
+        for (size_t sample = first_sample; sample < end_sample; ++sample)
+        {
+            uint8_t value = encoded_samples[shuffle ? byte * sample_count + sample : sample * sample_size + byte];
+            if (delta && sample > 0)
+            {
+                value ^= destination[(sample - 1) * sample_size + byte];
+            }
+            destination[sample * sample_size + byte] = value;
+        }
+    }
+}
+
+#ifdef __SSE2__
+
+/**
+ * Transposes a 16x16 byte matrix. Every round rotates the bits of the byte index by one,
+ * so that row and column are swapped after four rounds.
+ */
+inline void transpose16x16(__m128i (&rows)[16])
+{
+    __m128i interleaved[16];
+    for (int round = 0; round < 4; ++round)
+    {
+        for (int row = 0; row < 8; ++row)
+        {
+            interleaved[2 * row] = _mm_unpacklo_epi8(rows[row], rows[row + 8]);
+            interleaved[2 * row + 1] = _mm_unpackhi_epi8(rows[row], rows[row + 8]);
+        }
+        std::copy(std::begin(interleaved), std::end(interleaved), std::begin(rows));
+    }
+}
+
+/**
+ * Encodes blocks of 16 samples by 16 bytes, returns the amount of samples and bytes
+ * that have been processed.
+ */
+std::pair<size_t, size_t> encodeBlocks(const uint8_t* samples, uint8_t* destination, size_t sample_size,
+                                       size_t sample_count, bool delta)
+{
+    const size_t block_samples = sample_count - sample_count % 16;
+    const size_t block_bytes = sample_size - sample_size % 16;
+
+    __m128i rows[16];
+    for (size_t sample = 0; sample < block_samples; sample += 16)
+    {
+        for (size_t byte = 0; byte < block_bytes; byte += 16)
+        {
+            const uint8_t* source = samples + sample * sample_size + byte;
+            __m128i previous = delta && sample > 0 ?
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(source - sample_size)) :
+                _mm_setzero_si128();
+            for (size_t row = 0; row < 16; ++row)
+            {
+                __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + row * sample_size));
+                rows[row] = delta ? _mm_xor_si128(current, previous) : current;
+                previous = current;
+            }
+
+            transpose16x16(rows);
+
+            for (size_t column = 0; column < 16; ++column)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + (byte + column) * sample_count + sample),
+                                 rows[column]);
+            }
+        }
+    }
+
+    return {block_samples, block_bytes};
+}
+
+/**
+ * Decodes blocks of 16 samples by 16 bytes, returns the amount of samples and bytes
+ * that have been processed.
+ */
+std::pair<size_t, size_t> decodeBlocks(const uint8_t* encoded_samples, uint8_t* destination, size_t sample_size,
+                                       size_t sample_count, bool delta)
+{
+    const size_t block_samples = sample_count - sample_count % 16;
+    const size_t block_bytes = sample_size - sample_size % 16;
+
+    __m128i rows[16];
+    for (size_t sample = 0; sample < block_samples; sample += 16)
+    {
+        for (size_t byte = 0; byte < block_bytes; byte += 16)
+        {
+            for (size_t column = 0; column < 16; ++column)
+            {
+                rows[column] = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(encoded_samples + (byte + column) * sample_count + sample));
+            }
+
+            transpose16x16(rows);
+
+            uint8_t* target = destination + sample * sample_size + byte;
+            __m128i previous = delta && sample > 0 ?
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(target - sample_size)) :
+                _mm_setzero_si128();
+            for (size_t row = 0; row < 16; ++row)
+            {
+                if (delta)
+                {
+                    rows[row] = _mm_xor_si128(rows[row], previous);
+                    previous = rows[row];
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(target + row * sample_size), rows[row]);
+            }
+        }
+    }
+
+    return {block_samples, block_bytes};
+}
+
+#endif
+
+}
+
+void encodePackedSamples(const uint8_t* samples,
+                         uint8_t* destination,
+                         size_t sample_size,
+                         size_t sample_count,
+                         uint32_t filters)
+{
+    const bool delta = (filters & psf_delta) != 0;
+    const bool shuffle = (filters & psf_shuffle) != 0;
+
+    if (!shuffle)
+    {
+        // a plain loop over the whole buffer, which is vectorized by the compiler
+        const size_t data_size = sample_size * sample_count;
+        std::memcpy(destination, samples, std::min(sample_size, data_size));
+        for (size_t offset = sample_size; offset < data_size; ++offset)
+        {
+            destination[offset] = delta ? samples[offset] ^ samples[offset - sample_size] : samples[offset];
+        }
+        return;
+    }
+
+    size_t block_samples = 0;
+    size_t block_bytes = 0;
+#ifdef __SSE2__
+    std::tie(block_samples, block_bytes) = encodeBlocks(samples, destination, sample_size, sample_count, delta);
+#endif
+
+    encodeRange(samples, destination, sample_size, sample_count, delta, shuffle,
+                0, block_samples, block_bytes, sample_size);
+    encodeRange(samples, destination, sample_size, sample_count, delta, shuffle,
+                block_samples, sample_count, 0, sample_size);
+}
+
+void decodePackedSamples(const uint8_t* encoded_samples,
+                         uint8_t* destination,
+                         size_t sample_size,
+                         size_t sample_count,
+                         uint32_t filters)
+{
+    const bool delta = (filters & psf_delta) != 0;
+    const bool shuffle = (filters & psf_shuffle) != 0;
+
+    if (!shuffle)
+    {
+        const size_t data_size = sample_size * sample_count;
+        std::memcpy(destination, encoded_samples, data_size);
+        if (delta)
+        {
+            for (size_t offset = sample_size; offset < data_size; ++offset)
+            {
+                destination[offset] ^= destination[offset - sample_size];
+            }
+        }
+        return;
+    }
+
+    size_t block_samples = 0;
+    size_t block_bytes = 0;
+#ifdef __SSE2__
+    std::tie(block_samples, block_bytes) = decodeBlocks(encoded_samples, destination, sample_size, sample_count, delta);
+#endif
+
+    // the remaining bytes of the block samples only depend on the same bytes of previous samples
+    decodeRange(encoded_samples, destination, sample_size, sample_count, delta, shuffle,
+                0, block_samples, block_bytes, sample_size);
+    decodeRange(encoded_samples, destination, sample_size, sample_count, delta, shuffle,
+                block_samples, sample_count, 0, sample_size);
+}
+
+}
+}
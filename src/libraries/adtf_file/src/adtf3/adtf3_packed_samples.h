@@ -0,0 +1,101 @@
+/**
+ * @file
+ * adtf3 packed sample containers.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef ADTF_FILE_ADTF3_PACKED_SAMPLES
+#define ADTF_FILE_ADTF3_PACKED_SAMPLES
+
+#include <cstdint>
+#include <cstddef>
+
+namespace adtf_file
+{
+
+namespace adtf3
+{
+
+/**
+ * Serialization id of streams whose data chunks are sample containers. The id of the serializer
+ * of the contained samples follows it within the additional stream info. Readers that do not
+ * know about containers consider such streams as unsupported.
+ *
+ * A container consists of a PackedSamplesHeader, a PackedSampleEntry for every sample and the
+ * serialized samples one after another. If the filters of the header are set, the serialized
+ * samples all have the same size and are stored as encoded by encodePackedSamples.
+ */
+static constexpr const char* packed_samples_id = "packed_samples.serialization.adtf_file.cid";
+
+/**
+ * Filters that are applied to the serialized samples of a container.
+ */
+enum PackedSamplesFilter
+{
+    psf_none = 0x0,
+    psf_delta = 0x1,    // every sample is XORed with the previous one
+    psf_shuffle = 0x2   // byte n of all samples is stored before byte n + 1 of all samples
+};
+
+#pragma pack(push)
+#pragma pack(1)
+struct PackedSamplesHeader
+{
+    uint32_t sample_count;
+    int64_t  base_time_stamp;   // file timestamp the offsets of the entries refer to
+    uint32_t filters;           // PackedSamplesFilter flags
+};
+
+struct PackedSampleEntry
+{
+    uint32_t data_size;
+    uint32_t time_offset;
+};
+#pragma pack(pop)
+
+/**
+ * Applies filters to samples of equal size.
+ * @param samples The serialized samples one after another.
+ * @param destination Receives the encoded samples, the same size as the samples.
+ * @param sample_size The size of every sample.
+ * @param sample_count The amount of samples.
+ * @param filters The PackedSamplesFilter flags.
+ */
+void encodePackedSamples(const uint8_t* samples,
+                         uint8_t* destination,
+                         size_t sample_size,
+                         size_t sample_count,
+                         uint32_t filters);
+
+/**
+ * Restores samples that have been encoded with encodePackedSamples.
+ * @param encoded_samples The encoded samples.
+ * @param destination Receives the serialized samples one after another.
+ * @param sample_size The size of every sample.
+ * @param sample_count The amount of samples.
+ * @param filters The PackedSamplesFilter flags the samples have been encoded with.
+ */
+void decodePackedSamples(const uint8_t* encoded_samples,
+                         uint8_t* destination,
+                         size_t sample_size,
+                         size_t sample_count,
+                         uint32_t filters);
+
+}
+}
+
+#endif
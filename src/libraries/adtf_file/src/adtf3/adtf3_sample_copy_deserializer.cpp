@@ -40,9 +40,7 @@ int64_t copy_deserialize(ReadSample& sample, InputStream& stream)
 
     if (buffer_size)
     {
-        void* buffer = sample.beginBufferWrite(buffer_size);
-        stream.read(buffer, buffer_size);
-        sample.endBufferWrite();
+        readSampleBuffer(sample, stream, buffer_size);
     }
 
     if (flags & InternalSampleFlags::sf_sample_info_present)
@@ -70,6 +70,25 @@ void copy_serialize(const WriteSample& sample,
     }
 }
 
+size_t copy_serialized_size(const WriteSample& sample, bool sub_streams)
+{
+    auto buffer = sample.beginBufferRead();
+    sample.endBufferRead();
+
+    size_t serialized_size = sizeof(int64_t) +
+                             sizeof(uint32_t) +
+                             sizeof(buffer.second) + buffer.second +
+                             getSampleInfoSize(sample);
+
+    if (sub_streams &&
+        sample.getSubStreamId() > 0)
+    {
+        serialized_size += sizeof(uint32_t);
+    }
+
+    return serialized_size;
+}
+
 }
 
 std::string SampleCopySerializer::getId() const
@@ -89,6 +108,12 @@ void SampleCopySerializer::serialize(const WriteSample& sample, OutputStream& st
                    false);
 }
 
+bool SampleCopySerializer::getSerializedSize(const WriteSample& sample, size_t& serialized_size)
+{
+    serialized_size = copy_serialized_size(sample, false);
+    return true;
+}
+
 std::string SampleCopySerializerNs::getId() const
 {
     return id;
@@ -103,5 +128,11 @@ void SampleCopySerializerNs::serialize(const WriteSample& sample, OutputStream&
     copy_serialize(sample, stream, static_cast<int64_t>(sample.getTimeStamp().count()), true);
 }
 
+bool SampleCopySerializerNs::getSerializedSize(const WriteSample& sample, size_t& serialized_size)
+{
+    serialized_size = copy_serialized_size(sample, true);
+    return true;
+}
+
 }
 }
@@ -74,6 +74,28 @@ bool hasSampleInfo(const WriteSample& sample)
     return has_info;
 }
 
+size_t getSampleInfoSize(const WriteSample& sample)
+{
+    size_t data_size = 0;
+    auto raw_sample_info = dynamic_cast<const WriteRawSampleInfo*>(&sample);
+    if (raw_sample_info)
+    {
+        raw_sample_info->getRawSampleInfo([&](const void* data, size_t raw_data_size, uint8_t layout_version)
+        {
+            data_size = raw_data_size;
+        });
+    }
+    else
+    {
+        sample.iterateInfo([&](uint32_t key, DataType type, uint64_t raw_bytes)
+        {
+            data_size += sizeof(HashValueStorage);
+        });
+    }
+
+    return data_size ? sizeof(uint8_t) + sizeof(uint32_t) + data_size : 0;
+}
+
 void serializeSampleInfo(const WriteSample& sample, OutputStream& stream)
 {
     auto raw_sample_info = dynamic_cast<const WriteRawSampleInfo*>(&sample);
@@ -88,7 +110,14 @@ void serializeSampleInfo(const WriteSample& sample, OutputStream& stream)
     else
     {
         stream << HashValueStorage::getVersion();
-        std::vector<HashValueStorage> buffer;
+
+        // the values are counted first, so that they can be streamed without a temporary buffer
+        uint32_t data_size = 0;
+        sample.iterateInfo([&](uint32_t key, DataType type, uint64_t raw_bytes)
+        {
+            data_size += sizeof(HashValueStorage);
+        });
+        stream << data_size;
 
         sample.iterateInfo([&](uint32_t key, DataType type, uint64_t raw_bytes)
         {
@@ -97,12 +126,8 @@ void serializeSampleInfo(const WriteSample& sample, OutputStream& stream)
             memcpy(value.storage, &raw_bytes, 8);
             value.type = serialization_type_map[type].first;
             value.byte_size = serialization_type_map[type].second;
-            buffer.push_back(value);
+            stream << value;
         });
-
-        uint32_t data_size = buffer.size() * sizeof(HashValueStorage);
-        stream << data_size;
-        stream.write(buffer.data(), data_size);
     }
 }
 
@@ -27,6 +27,8 @@
 #include <adtf_file/adtf_file_reader.h>
 #include <adtf_file/sample.h>
 #include <adtf_file/stream_type.h>
+#include <limits>
+#include "adtf3/adtf3_packed_samples.h"
 
 #define A_UTIL5_RESULT_TO_EXCEPTION(__exp)\
 {\
@@ -57,12 +59,28 @@ InputStream& adtf_file::InputStream::operator>>(std::string& value)
 }
 
 
+void readSampleBuffer(ReadSample& sample, InputStream& stream, size_t buffer_size)
+{
+    const void* data = stream.borrow(buffer_size);
+    if (!data)
+    {
+        stream.read(sample.beginBufferWrite(buffer_size), buffer_size);
+        sample.endBufferWrite();
+    }
+    else if (!sample.referenceBuffer(data, buffer_size))
+    {
+        memcpy(sample.beginBufferWrite(buffer_size), data, buffer_size);
+        sample.endBufferWrite();
+    }
+}
+
 class BufferInputStream: public InputStream
 {
     public:
-        BufferInputStream(const void* buffer, size_t size):
+        BufferInputStream(const void* buffer, size_t size, bool allow_borrow = false):
             _buffer(static_cast<const char*>(buffer)),
-            _data_left(size)
+            _data_left(size),
+            _allow_borrow(allow_borrow)
         {
 
         }
@@ -80,9 +98,28 @@ class BufferInputStream: public InputStream
             _data_left -=count;
         }
 
+        const void* borrow(size_t count) override
+        {
+            if (!_allow_borrow)
+            {
+                return nullptr;
+            }
+
+            if (count > _data_left)
+            {
+                throw std::runtime_error("not enough data");
+            }
+
+            const void* data = _buffer;
+            _buffer += count;
+            _data_left -= count;
+            return data;
+        }
+
     private:
         const char* _buffer;
         size_t _data_left;
+        bool _allow_borrow;
 
 };
 
@@ -120,7 +157,10 @@ Reader::Reader(const std::string& file_name,
     _type_factories(type_factories),
     _sample_deserializer_factories(sample_deserializer_factories),
     _sample_factory(sample_factory),
-    _stream_type_factory(stream_type_factory)
+    _stream_type_factory(stream_type_factory),
+    _skip_packed_samples_before(std::numeric_limits<timestamp_t>::min()),
+    _time_stamp_seek_item_index(std::numeric_limits<uint64_t>::max()),
+    _time_stamp_seek_time_stamp(0)
 {
     _file->open(file_name);
 
@@ -228,7 +268,7 @@ std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer>
     }
     else
     {
-        return getInitialTypeAndSampleFactoryAdtf3(stream);
+        return getInitialTypeAndSampleFactoryAdtf3(stream, stream_id);
     }
 }
 
@@ -272,13 +312,20 @@ std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer>
     return std::make_pair(type, deserializer);
 }
 
-std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer>> Reader::getInitialTypeAndSampleFactoryAdtf3(InputStream& stream)
+std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer>> Reader::getInitialTypeAndSampleFactoryAdtf3(InputStream& stream, uint16_t stream_id)
 {
     auto type = buildType("", stream);
 
     std::string serialization_class_id;
     stream >> serialization_class_id;
 
+    if (serialization_class_id == adtf3::packed_samples_id)
+    {
+        // the id of the serializer of the samples within the containers follows
+        stream >> serialization_class_id;
+        _packed_streams.insert(stream_id);
+    }
+
     auto deserializer = _sample_deserializer_factories.build(serialization_class_id);
 
     return std::make_pair(type, deserializer);
@@ -286,7 +333,7 @@ std::pair<std::shared_ptr<const StreamType>, std::shared_ptr<SampleDeserializer>
 
 std::chrono::nanoseconds Reader::fromFileTimeStamp(timestamp_t time_stamp)
 {
-    if (_file->getVersionId() == v500::version_id)
+    if (_file->getVersionId() >= v500::version_id)
     {
         return std::chrono::nanoseconds{time_stamp};
     }
@@ -298,7 +345,7 @@ std::chrono::nanoseconds Reader::fromFileTimeStamp(timestamp_t time_stamp)
 
 timestamp_t Reader::toFileTimeStamp(std::chrono::nanoseconds time_stamp)
 {
-    if (_file->getVersionId() == v500::version_id)
+    if (_file->getVersionId() >= v500::version_id)
     {
         return time_stamp.count();
     }
@@ -421,7 +468,11 @@ uint64_t Reader::getItemCount() const
 
 uint64_t Reader::getItemIndexForTimeStamp(std::chrono::nanoseconds time_stamp)
 {
-    return _file->seek(0, toFileTimeStamp(time_stamp), TimeFormat::tf_chunk_time);
+    // the time of a container chunk is never earlier than the times of its samples, so all
+    // containers with samples at or after the time are located at or after the found item
+    _time_stamp_seek_time_stamp = toFileTimeStamp(time_stamp);
+    _time_stamp_seek_item_index = _file->seek(0, _time_stamp_seek_time_stamp, TimeFormat::tf_chunk_time);
+    return _time_stamp_seek_item_index;
 }
 
 uint64_t Reader::getItemIndexForStreamItemIndex(uint16_t stream_id, uint64_t stream_item_index)
@@ -463,6 +514,12 @@ std::shared_ptr<const StreamType> Reader::getStreamTypeBefore(uint64_t item_inde
 
 void Reader::seekTo(uint64_t item_index)
 {
+    _packed_samples.sample_count = 0;
+    _packed_samples.next_sample = 0;
+    _skip_packed_samples_before = item_index == _time_stamp_seek_item_index ?
+                                  _time_stamp_seek_time_stamp :
+                                  std::numeric_limits<timestamp_t>::min();
+
     if (_file->getCurrentPos(TimeFormat::tf_chunk_index) != static_cast<int64_t>(item_index))
     {
         if (item_index < static_cast<uint64_t>(_file->getChunkCount()))
@@ -476,52 +533,245 @@ void Reader::seekTo(uint64_t item_index)
     }
 }
 
-FileItem Reader::getNextItem()
+ChunkHeader* Reader::queryNextItem(SampleDeserializer** sample_deserializer)
 {
     for (;;)
     {
-        std::shared_ptr<const StreamItem> stream_item;
+        if (hasPackedSample())
+        {
+            *sample_deserializer = _packed_samples.sample_deserializer;
+            return nullptr;
+        }
 
+        // query the header first so that we do not read data we are going to drop anyway
         ChunkHeader* chunk_header;
-        const void* chunk_data;
-        _file->readNextChunk(&chunk_header, const_cast<void**>(&chunk_data));
+        _file->queryChunkInfo(&chunk_header);
+
+        if (!_file->isStreamSelected(chunk_header->stream_id))
+        {
+            _file->skipChunk();
+            continue;
+        }
 
         if (chunk_header->flags & ChunkType::ct_trigger)
         {
-            stream_item = std::make_shared<Trigger>();
+            _file->skipChunk();
+            *sample_deserializer = nullptr;
+            return chunk_header;
         }
-        else
+
+        auto stream_sample_deserializer = _stream_sample_deserializers.find(chunk_header->stream_id);
+        if (stream_sample_deserializer == _stream_sample_deserializers.end())
         {
-            auto sample_deserializer = _stream_sample_deserializers.find(chunk_header->stream_id);
-            if (sample_deserializer == _stream_sample_deserializers.end())
-            {
-                continue;
-            }
+            _file->skipChunk();
+            continue;
+        }
 
-            BufferInputStream stream(chunk_data, chunk_header->size  - sizeof(ChunkHeader));
+        if ((chunk_header->flags & ChunkType::ct_type) == 0 &&
+            _packed_streams.count(chunk_header->stream_id))
+        {
+            readPackedSamples(chunk_header, stream_sample_deserializer->second.get());
+            continue;
+        }
 
-            if (chunk_header->flags & ChunkType::ct_type)
-            {
-                auto type = buildType("", stream);
-                sample_deserializer->second->setStreamType(*type);
-                stream_item = type;
-            }
-            else
-            {
-                auto sample = _sample_factory->build();
-                auto read_sample = std::dynamic_pointer_cast<ReadSample>(sample);
-                if (!read_sample)
-                {
-                    throw std::runtime_error("sample factory builds samples that do not implement the ReadSample interface");
-                }
-
-                sample_deserializer->second->deserialize(*read_sample, stream);
-                stream_item = sample;
-            }
+        *sample_deserializer = stream_sample_deserializer->second.get();
+        return chunk_header;
+    }
+}
+
+void Reader::readPackedSamples(ChunkHeader* chunk_header, SampleDeserializer* sample_deserializer)
+{
+    const void* chunk_data;
+    _file->readChunk(const_cast<void**>(&chunk_data));
+
+    // the chunk data is copied, as it would be invalidated by seeking within the file
+    size_t data_size = chunk_header->size - sizeof(ChunkHeader);
+    _packed_samples.data.resize(data_size);
+
+    adtf3::PackedSamplesHeader header;
+    if (data_size < sizeof(header))
+    {
+        throw std::runtime_error("invalid sample container");
+    }
+    memcpy(&header, chunk_data, sizeof(header));
+
+    size_t samples_offset = sizeof(header) + static_cast<size_t>(header.sample_count) * sizeof(adtf3::PackedSampleEntry);
+    if (samples_offset > data_size)
+    {
+        throw std::runtime_error("invalid sample container");
+    }
+
+    if (header.filters == adtf3::psf_none)
+    {
+        memcpy(_packed_samples.data.data(), chunk_data, data_size);
+    }
+    else
+    {
+        // filtered samples are decoded while they are copied
+        memcpy(_packed_samples.data.data(), chunk_data, samples_offset);
+        size_t sample_size = header.sample_count > 0 ? (data_size - samples_offset) / header.sample_count : 0;
+        if (sample_size * header.sample_count != data_size - samples_offset)
+        {
+            throw std::runtime_error("invalid sample container");
+        }
+        adtf3::decodePackedSamples(static_cast<const uint8_t*>(chunk_data) + samples_offset,
+                                   _packed_samples.data.data() + samples_offset,
+                                   sample_size, header.sample_count, header.filters);
+    }
+
+    _packed_samples.stream_id = chunk_header->stream_id;
+    _packed_samples.sample_deserializer = sample_deserializer;
+    _packed_samples.sample_count = header.sample_count;
+    _packed_samples.next_sample = 0;
+    _packed_samples.next_data_offset = samples_offset;
+    _packed_samples.base_time_stamp = header.base_time_stamp;
+}
+
+bool Reader::hasPackedSample()
+{
+    if (_packed_samples.next_sample < _packed_samples.sample_count &&
+        !_file->isStreamSelected(_packed_samples.stream_id))
+    {
+        _packed_samples.sample_count = 0;
+    }
+
+    while (_packed_samples.next_sample < _packed_samples.sample_count)
+    {
+        adtf3::PackedSampleEntry entry;
+        memcpy(&entry, _packed_samples.data.data() + sizeof(adtf3::PackedSamplesHeader) +
+                       _packed_samples.next_sample * sizeof(adtf3::PackedSampleEntry), sizeof(entry));
+
+        if (_packed_samples.base_time_stamp + entry.time_offset >= _skip_packed_samples_before)
+        {
+            return true;
+        }
+
+        _packed_samples.next_data_offset += entry.data_size;
+        ++_packed_samples.next_sample;
+    }
+
+    return false;
+}
+
+const void* Reader::nextPackedSample(size_t& data_size, timestamp_t& time_stamp)
+{
+    adtf3::PackedSampleEntry entry;
+    memcpy(&entry, _packed_samples.data.data() + sizeof(adtf3::PackedSamplesHeader) +
+                   _packed_samples.next_sample * sizeof(adtf3::PackedSampleEntry), sizeof(entry));
+
+    if (entry.data_size > _packed_samples.data.size() - _packed_samples.next_data_offset)
+    {
+        throw std::runtime_error("invalid sample container");
+    }
+
+    const void* data = _packed_samples.data.data() + _packed_samples.next_data_offset;
+    data_size = entry.data_size;
+    time_stamp = _packed_samples.base_time_stamp + entry.time_offset;
+
+    _packed_samples.next_data_offset += entry.data_size;
+    ++_packed_samples.next_sample;
+
+    return data;
+}
+
+FileItem Reader::getNextItem()
+{
+    std::shared_ptr<const StreamItem> stream_item;
+
+    SampleDeserializer* sample_deserializer;
+    ChunkHeader* chunk_header = queryNextItem(&sample_deserializer);
+
+    if (!chunk_header)
+    {
+        size_t data_size;
+        timestamp_t time_stamp;
+        const void* data = nextPackedSample(data_size, time_stamp);
+
+        BufferInputStream stream(data, data_size);
+        return {_packed_samples.stream_id, fromFileTimeStamp(time_stamp), buildSample(*sample_deserializer, stream)};
+    }
+
+    if (!sample_deserializer)
+    {
+        stream_item = std::make_shared<Trigger>();
+    }
+    else
+    {
+        const void* chunk_data;
+        _file->readChunk(const_cast<void**>(&chunk_data));
+
+        BufferInputStream stream(chunk_data, chunk_header->size  - sizeof(ChunkHeader));
+
+        if (chunk_header->flags & ChunkType::ct_type)
+        {
+            auto type = buildType("", stream);
+            sample_deserializer->setStreamType(*type);
+            stream_item = type;
         }
+        else
+        {
+            stream_item = buildSample(*sample_deserializer, stream);
+        }
+    }
+
+    return {chunk_header->stream_id, fromFileTimeStamp(chunk_header->time_stamp), stream_item};
+}
+
+const FileItemView& Reader::getNextItemView()
+{
+    SampleDeserializer* sample_deserializer;
+    ChunkHeader* chunk_header = queryNextItem(&sample_deserializer);
+
+    if (!chunk_header)
+    {
+        size_t data_size;
+        timestamp_t time_stamp;
+        const void* data = nextPackedSample(data_size, time_stamp);
+
+        // the container data stays valid until the next container is read
+        BufferInputStream stream(data, data_size, true);
+        _sample_view.reset();
+        sample_deserializer->deserialize(_sample_view, stream);
+        _item_view.stream_item = &_sample_view;
+        _item_view.stream_id = _packed_samples.stream_id;
+        _item_view.time_stamp = fromFileTimeStamp(time_stamp);
+        return _item_view;
+    }
+
+    if (!sample_deserializer)
+    {
+        _item_view.stream_item = &_trigger;
+    }
+    else
+    {
+        const void* chunk_data;
+        _file->readChunk(const_cast<void**>(&chunk_data));
+
+        // the chunk data stays valid until the next chunk is read, so samples may refer to it
+        BufferInputStream stream(chunk_data, chunk_header->size  - sizeof(ChunkHeader), true);
 
-        return {chunk_header->stream_id, fromFileTimeStamp(chunk_header->time_stamp), stream_item};
+        if (chunk_header->flags & ChunkType::ct_type)
+        {
+            _item_view_type = buildType("", stream);
+            sample_deserializer->setStreamType(*_item_view_type);
+            _item_view.stream_item = _item_view_type.get();
+        }
+        else
+        {
+            _sample_view.reset();
+            sample_deserializer->deserialize(_sample_view, stream);
+            _item_view.stream_item = &_sample_view;
+        }
     }
+
+    _item_view.stream_id = chunk_header->stream_id;
+    _item_view.time_stamp = fromFileTimeStamp(chunk_header->time_stamp);
+    return _item_view;
+}
+
+void Reader::setStreamFilter(const std::set<uint16_t>& stream_ids)
+{
+    _file->setStreamFilter(stream_ids);
 }
 
 int64_t Reader::getNextItemIndex()
@@ -529,6 +779,19 @@ int64_t Reader::getNextItemIndex()
     return _file->getCurrentPos(TimeFormat::tf_chunk_index);
 }
 
+std::shared_ptr<const StreamItem> Reader::buildSample(SampleDeserializer& sample_deserializer, InputStream& stream)
+{
+    auto sample = _sample_factory->build();
+    auto read_sample = std::dynamic_pointer_cast<ReadSample>(sample);
+    if (!read_sample)
+    {
+        throw std::runtime_error("sample factory builds samples that do not implement the ReadSample interface");
+    }
+
+    sample_deserializer.deserialize(*read_sample, stream);
+    return sample;
+}
+
 std::shared_ptr<const StreamType> Reader::buildType(const std::string& id, InputStream& stream)
 {
     auto type = _stream_type_factory->build();
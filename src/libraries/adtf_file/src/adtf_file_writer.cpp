@@ -20,6 +20,13 @@
 
 #include <adtf_file/adtf_file_writer.h>
 #include <ifhd/ifhd.h>
+#include <limits>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <iomanip>
+#include <sstream>
+#include "adtf3/adtf3_packed_samples.h"
 
 using namespace ifhd;
 using namespace ifhd::v500;
@@ -36,6 +43,53 @@ OutputStream& OutputStream::operator<<(const std::string& value)
     return *this;
 }
 
+class MemoryOutputStream: public OutputStream
+{
+    public:
+        MemoryOutputStream(void* buffer, size_t size):
+            _buffer(static_cast<uint8_t*>(buffer)),
+            _space_left(size)
+        {
+        }
+
+        void write(const void* data, size_t data_size) override
+        {
+            a_util::memory::copy(reserveInPlace(data_size), data_size, data, data_size);
+        }
+
+        void* reserveInPlace(size_t count) override
+        {
+            if (count > _space_left)
+            {
+                throw std::runtime_error("not enough space");
+            }
+
+            void* memory = _buffer;
+            _buffer += count;
+            _space_left -= count;
+            return memory;
+        }
+
+        size_t getSpaceLeft() const
+        {
+            return _space_left;
+        }
+
+    private:
+        uint8_t* _buffer;
+        size_t _space_left;
+};
+
+void SampleSerializer::serializeInto(const WriteSample& sample, void* destination, size_t destination_size)
+{
+    MemoryOutputStream stream(destination, destination_size);
+    serialize(sample, stream);
+    if (stream.getSpaceLeft() != 0)
+    {
+        throw std::runtime_error("serialized sample is smaller than the given memory");
+    }
+}
+
 class CompatIndexedFileWriter: public v500::IndexedFileWriter
 {
     public:
@@ -48,6 +102,71 @@ class CompatIndexedFileWriter: public v500::IndexedFileWriter
         {
             return _extensions.back()->file_extension;
         }
+
+        FilePos GetFilePos() const
+        {
+            return _file_pos;
+        }
+};
+
+/**
+ * @return The name of a file of a rolling recording, i.e. recording_001.dat for recording.dat.
+ */
+static std::string getPartFileName(const std::string& file_name, size_t part_index)
+{
+    auto name_start = file_name.find_last_of("/\\");
+    auto extension_start = file_name.find_last_of('.');
+    if (extension_start == std::string::npos ||
+        (name_start != std::string::npos && extension_start < name_start))
+    {
+        extension_start = file_name.size();
+    }
+
+    std::ostringstream part_file_name;
+    part_file_name << file_name.substr(0, extension_start) << "_"
+                   << std::setw(3) << std::setfill('0') << part_index
+                   << file_name.substr(extension_start);
+    return part_file_name.str();
+}
+
+/**
+ * The tasks of an event file. The writing thread never waits for the event file, the tasks are
+ * queued until the thread of the event file has run them.
+ */
+struct Writer::EventQueue
+{
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<EventTask> tasks;
+    bool completed = false;
+
+    void post(EventTask task)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+        changed.notify_one();
+    }
+
+    void complete()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        completed = true;
+        changed.notify_one();
+    }
+
+    /// @return false as soon as the event has been completed and all tasks have been run.
+    bool pop(EventTask& task)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return completed || !tasks.empty(); });
+        if (tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        return true;
+    }
 };
 
 Writer::Writer(const std::string& file_name,
@@ -57,30 +176,48 @@ Writer::Writer(const std::string& file_name,
                size_t cache_size,
                size_t cache_minimum_write_chunk_size,
                size_t cache_maximum_write_chunk_size,
-               uint32_t writer_flags):
-    _file(new CompatIndexedFileWriter),
+               uint32_t writer_flags,
+               const IndexedFileSettings& indexed_file_settings):
     _type_serializers(type_serializers),
     _target_adtf_version(adtf_version),
+    _file_settings{adtf_version, cache_size, cache_minimum_write_chunk_size, cache_maximum_write_chunk_size, writer_flags,
+                   indexed_file_settings},
     _history_active(history_duration.count() > 0),
     _lock_chunk_write(false)
 {
     _streams.resize(1);
+    _file = createFile(file_name, _file_settings, history_duration, this);
+    _file_names.push_back(file_name);
+}
+
+std::unique_ptr<CompatIndexedFileWriter> Writer::createFile(const std::string& file_name,
+                                                            const FileSettings& settings,
+                                                            std::chrono::nanoseconds history_duration,
+                                                            ChunkDroppedCallback* drop_callback)
+{
+    std::unique_ptr<CompatIndexedFileWriter> file(new CompatIndexedFileWriter);
+
+    auto& indexed_file = settings.indexed_file;
+    file->setIndexMemoryLimit(indexed_file.index_memory_limit);
+    file->setIndexJournalInterval(std::chrono::duration_cast<std::chrono::microseconds>(indexed_file.index_journal_interval).count());
+    file->setProgressInterval(std::chrono::duration_cast<std::chrono::microseconds>(indexed_file.progress_interval).count());
+    file->setLiveTap(indexed_file.live_tap_name, indexed_file.live_tap_size);
 
     std::chrono::seconds index_delay{1};
-    timestamp_t file_index_delay = adtf_version < adtf3ns ? std::chrono::duration_cast<std::chrono::microseconds>(index_delay).count() :
-                                                            std::chrono::duration_cast<std::chrono::nanoseconds>(index_delay).count();
+    timestamp_t file_index_delay = settings.adtf_version < adtf3ns ? std::chrono::duration_cast<std::chrono::microseconds>(index_delay).count() :
+                                                                     std::chrono::duration_cast<std::chrono::nanoseconds>(index_delay).count();
 
-    _file->create(file_name, cache_size, writer_flags, 0, history_duration.count(), 0,
-                  cache_minimum_write_chunk_size, cache_maximum_write_chunk_size, this,
-                  file_index_delay);
+    file->create(file_name, settings.cache_size, settings.writer_flags, 0, history_duration.count(), 0,
+                 settings.cache_minimum_write_chunk_size, settings.cache_maximum_write_chunk_size, drop_callback,
+                 file_index_delay);
 
     FileHeader* header;
-    _file->getHeaderRef(&header);
-    switch (adtf_version)
+    file->getHeaderRef(&header);
+    switch (settings.adtf_version)
     {
         case adtf2:
         {
-            if (_history_active)
+            if (history_duration.count() > 0)
             {
                 header->version_id = ifhd::v201_v301::version_id_with_history_end_offset;
             }
@@ -101,6 +238,8 @@ Writer::Writer(const std::string& file_name,
             break;
         }
     }
+
+    return file;
 }
 
 size_t Writer::createStream(const std::string& name, const StreamType& initial_type, const std::shared_ptr<SampleSerializer>& serializer)
@@ -132,8 +271,12 @@ void Writer::write(size_t stream_id, std::chrono::nanoseconds time_stamp, const
     }
     else
     {
+        rollFileIfRequired(getFileTimeStamp(time_stamp));
+        writePackedSamples(stream_id);
+
         auto chunk = serialize(stream_id, time_stamp, type);
         write(chunk);
+        stream.current_type.assign(chunk.begin(), chunk.end());
 
         if (_history_active)
         {
@@ -142,11 +285,298 @@ void Writer::write(size_t stream_id, std::chrono::nanoseconds time_stamp, const
     }
 }
 
+class SizeCountingStream: public OutputStream
+{
+    public:
+        size_t size = 0;
+
+    public:
+        void write(const void* /*data*/, size_t data_size) override
+        {
+            size += data_size;
+        }
+};
+
+class ReservationStream: public OutputStream
+{
+    private:
+        v500::IndexedFileWriter::ChunkReservation& _reservation;
+        size_t _piece;
+        size_t _piece_offset;
+
+    public:
+        ReservationStream(v500::IndexedFileWriter::ChunkReservation& reservation):
+            _reservation(reservation),
+            _piece(0),
+            _piece_offset(0)
+        {
+        }
+
+        void write(const void* data, size_t data_size) override
+        {
+            const uint8_t* source = static_cast<const uint8_t*>(data);
+            while (data_size > 0)
+            {
+                if (_piece_offset == _reservation.data_size[_piece])
+                {
+                    if (_piece == 1)
+                    {
+                        throw std::runtime_error("sample serializer wrote more data than announced");
+                    }
+                    ++_piece;
+                    _piece_offset = 0;
+                    continue;
+                }
+
+                size_t piece_size = std::min(data_size, _reservation.data_size[_piece] - _piece_offset);
+                a_util::memory::copy(static_cast<uint8_t*>(_reservation.data[_piece]) + _piece_offset, piece_size, source, piece_size);
+                source += piece_size;
+                data_size -= piece_size;
+                _piece_offset += piece_size;
+            }
+        }
+
+        void* reserveInPlace(size_t count) override
+        {
+            if (_piece_offset == _reservation.data_size[_piece] && _piece == 0)
+            {
+                ++_piece;
+                _piece_offset = 0;
+            }
+
+            // memory that wraps around the end of the cache has to be written piecewise
+            if (count > _reservation.data_size[_piece] - _piece_offset)
+            {
+                return nullptr;
+            }
+
+            void* memory = static_cast<uint8_t*>(_reservation.data[_piece]) + _piece_offset;
+            _piece_offset += count;
+            return memory;
+        }
+
+        size_t getSize() const
+        {
+            return _piece == 0 ? _piece_offset : _reservation.data_size[0] + _piece_offset;
+        }
+};
+
+static_assert(static_cast<uint32_t>(Writer::packing_filter_delta) == adtf3::psf_delta &&
+              static_cast<uint32_t>(Writer::packing_filter_shuffle) == adtf3::psf_shuffle,
+              "the packing filters have to match the container format");
+
+/**
+ * @return Whether all entries of a container refer to samples of the given size.
+ */
+static bool hasEqualSampleSizes(const std::vector<uint8_t>& entries, size_t sample_size)
+{
+    for (size_t offset = 0; offset < entries.size(); offset += sizeof(adtf3::PackedSampleEntry))
+    {
+        adtf3::PackedSampleEntry entry;
+        memcpy(&entry, entries.data() + offset, sizeof(entry));
+        if (entry.data_size != sample_size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 void Writer::write(size_t stream_id, std::chrono::nanoseconds time_stamp, const WriteSample& sample)
 {
-    auto chunk = serialize(stream_id, time_stamp, sample);
-    write(chunk);
-    _streams.at(stream_id).has_samples = true;
+    checkChunkWrite();
+    auto& stream = _streams.at(stream_id);
+    auto file_time_stamp = getFileTimeStamp(time_stamp);
+    rollFileIfRequired(file_time_stamp);
+    _last_time_stamp = std::max(_last_time_stamp, file_time_stamp);
+
+    // the post-trigger windows also end for samples that are packed into containers first
+    completeEvents(_last_time_stamp);
+
+    if (stream.packing_max_sample_count > 0)
+    {
+        writePackedSample(stream_id, file_time_stamp, sample);
+        return;
+    }
+
+    if (_pre_trigger_active)
+    {
+        BufferedChunk chunk{static_cast<uint16_t>(stream_id), file_time_stamp, 0, {}};
+        size_t serialized_size = 0;
+        if (stream.sample_serializer->getSerializedSize(sample, serialized_size))
+        {
+            chunk.data.reserve(serialized_size);
+        }
+        stream.sample_serializer->serialize(sample, chunk.data);
+        stream.has_samples = true;
+        bufferChunk(std::move(chunk));
+        return;
+    }
+
+    // the sample is serialized directly into the cache of the file writer, serializers that
+    // cannot determine the size upfront are run twice, the first time to count the size
+    size_t serialized_size = 0;
+    if (!stream.sample_serializer->getSerializedSize(sample, serialized_size))
+    {
+        SizeCountingStream size_counter;
+        stream.sample_serializer->serialize(sample, size_counter);
+        serialized_size = size_counter.size;
+    }
+
+    v500::IndexedFileWriter::ChunkReservation reservation;
+    _file->reserveChunk(static_cast<uint32_t>(serialized_size), reservation);
+    ReservationStream reservation_stream(reservation);
+    stream.sample_serializer->serialize(sample, reservation_stream);
+    if (reservation_stream.getSize() != serialized_size)
+    {
+        throw std::runtime_error("sample serializer wrote less data than announced");
+    }
+
+    _file->commitChunk(static_cast<uint16_t>(stream_id), file_time_stamp, 0);
+    stream.has_samples = true;
+}
+
+void Writer::setSamplePacking(size_t stream_id,
+                              size_t max_sample_count,
+                              size_t max_data_size,
+                              std::chrono::nanoseconds max_duration,
+                              uint32_t filters)
+{
+    if (_target_adtf_version == adtf2)
+    {
+        throw std::invalid_argument("Invalid version for SetSamplePacking call (ADTF 2 does not support packed samples)");
+    }
+
+    auto& stream = _streams.at(stream_id);
+    if (stream.has_samples)
+    {
+        throw std::logic_error("sample packing has to be set before the first sample of the stream is written");
+    }
+
+    stream.packing_max_sample_count = max_sample_count;
+    stream.packing_max_data_size = max_data_size;
+    stream.packing_max_duration = getFileTimeStamp(max_duration);
+    stream.packing_filters = filters;
+}
+
+void Writer::setStreamCompression(size_t stream_id, ifhd::v400::CompressionCodec codec, int level)
+{
+    if (_target_adtf_version == adtf2)
+    {
+        throw std::invalid_argument("Invalid version for SetStreamCompression call (ADTF 2 does not support compressed chunks)");
+    }
+
+    if (stream_id == 0 || stream_id >= _streams.size())
+    {
+        throw std::out_of_range("invalid stream id");
+    }
+
+    _file->setStreamCompression(static_cast<uint16_t>(stream_id), codec, level);
+    for (auto& event: _events)
+    {
+        event.queue->post([stream_id, codec, level](CompatIndexedFileWriter& file)
+        {
+            file.setStreamCompression(static_cast<uint16_t>(stream_id), codec, level);
+        });
+    }
+    _streams[stream_id].compression_codec = codec;
+    _streams[stream_id].compression_level = level;
+}
+
+void Writer::writePackedSample(size_t stream_id, timestamp_t time_stamp, const WriteSample& sample)
+{
+    auto& stream = _streams[stream_id];
+
+    // the time offsets within a container are limited to 32 bit
+    if (stream.packed_sample_count > 0 &&
+        (time_stamp < stream.packed_base_time_stamp ||
+         time_stamp - stream.packed_base_time_stamp > std::min<timestamp_t>(stream.packing_max_duration,
+                                                                            std::numeric_limits<uint32_t>::max())))
+    {
+        writePackedSamples(stream_id);
+    }
+
+    if (stream.packed_sample_count == 0)
+    {
+        stream.packed_base_time_stamp = time_stamp;
+    }
+
+    size_t data_size = stream.packed_data.size();
+    stream.sample_serializer->serialize(sample, stream.packed_data);
+
+    adtf3::PackedSampleEntry entry;
+    entry.data_size = static_cast<uint32_t>(stream.packed_data.size() - data_size);
+    entry.time_offset = static_cast<uint32_t>(time_stamp - stream.packed_base_time_stamp);
+    stream.packed_entries << entry;
+    ++stream.packed_sample_count;
+    stream.has_samples = true;
+
+    if (stream.packed_sample_count >= stream.packing_max_sample_count ||
+        stream.packed_data.size() >= stream.packing_max_data_size)
+    {
+        writePackedSamples(stream_id);
+    }
+}
+
+void Writer::writePackedSamples(size_t stream_id)
+{
+    auto& stream = _streams[stream_id];
+    if (stream.packed_sample_count == 0)
+    {
+        return;
+    }
+
+    adtf3::PackedSamplesHeader header;
+    header.sample_count = stream.packed_sample_count;
+    header.base_time_stamp = stream.packed_base_time_stamp;
+    header.filters = adtf3::psf_none;
+
+    const Buffer* samples = &stream.packed_data;
+    size_t sample_size = stream.packed_data.size() / stream.packed_sample_count;
+    if (stream.packing_filters != packing_filter_none &&
+        stream.packed_sample_count > 1 &&
+        hasEqualSampleSizes(stream.packed_entries, sample_size))
+    {
+        header.filters = stream.packing_filters;
+        stream.filtered_data.resize(stream.packed_data.size());
+        adtf3::encodePackedSamples(stream.packed_data.data(), stream.filtered_data.data(),
+                                   sample_size, stream.packed_sample_count, header.filters);
+        samples = &stream.filtered_data;
+    }
+
+    // the container gets the latest time written so far, so that the chunk times stay ascending
+    size_t container_size = sizeof(header) + stream.packed_entries.size() + samples->size();
+    if (_pre_trigger_active)
+    {
+        BufferedChunk chunk{static_cast<uint16_t>(stream_id), _last_time_stamp, 0, {}};
+        chunk.data.reserve(container_size);
+        chunk.data << header;
+        chunk.data.write(stream.packed_entries.data(), stream.packed_entries.size());
+        chunk.data.write(samples->data(), samples->size());
+        bufferChunk(std::move(chunk));
+    }
+    else
+    {
+        v500::IndexedFileWriter::ChunkReservation reservation;
+        _file->reserveChunk(static_cast<uint32_t>(container_size), reservation);
+        ReservationStream reservation_stream(reservation);
+        reservation_stream << header;
+        reservation_stream.write(stream.packed_entries.data(), stream.packed_entries.size());
+        reservation_stream.write(samples->data(), samples->size());
+        _file->commitChunk(static_cast<uint16_t>(stream_id), _last_time_stamp, 0);
+    }
+
+    stream.packed_entries.clear();
+    stream.packed_data.clear();
+    stream.packed_sample_count = 0;
+}
+
+void Writer::writeAllPackedSamples()
+{
+    for (size_t stream_id = 1; stream_id < _streams.size(); ++stream_id)
+    {
+        writePackedSamples(stream_id);
+    }
 }
 
 void Writer::writeTrigger(size_t stream_id, std::chrono::nanoseconds time_stamp)
@@ -155,10 +585,364 @@ void Writer::writeTrigger(size_t stream_id, std::chrono::nanoseconds time_stamp)
     {
         throw std::invalid_argument("Invalid version for WriteTrigger call (ADTF 2 does not support Triggers)");
     }
+    rollFileIfRequired(getFileTimeStamp(time_stamp));
+    writePackedSamples(stream_id);
     auto chunk = serializeTrigger(stream_id, time_stamp);
     write(chunk);
 }
 
+void Writer::setFileRolling(uint64_t max_file_size, std::chrono::nanoseconds max_duration)
+{
+    if (_history_active)
+    {
+        throw std::logic_error("file rolling is not supported in combination with a history");
+    }
+
+    if (_pre_trigger_active)
+    {
+        throw std::logic_error("file rolling is not supported in combination with a pre-trigger buffer");
+    }
+
+    if (!_file_settings.indexed_file.live_tap_name.empty())
+    {
+        throw std::logic_error("file rolling is not supported in combination with a live tap");
+    }
+
+    _rolling_max_file_size = max_file_size;
+    _rolling_max_duration = getFileTimeStamp(max_duration);
+    if (!_next_file.valid())
+    {
+        prepareNextFile();
+    }
+}
+
+void Writer::setPreTriggerBuffer(std::chrono::nanoseconds duration,
+                                 size_t max_size,
+                                 std::chrono::nanoseconds post_trigger_duration)
+{
+    if (_history_active)
+    {
+        throw std::logic_error("a pre-trigger buffer is not supported in combination with a history");
+    }
+
+    if (_next_file.valid() && !_pre_trigger_active)
+    {
+        throw std::logic_error("a pre-trigger buffer is not supported in combination with file rolling");
+    }
+
+    if (!_file_settings.indexed_file.live_tap_name.empty())
+    {
+        throw std::logic_error("a pre-trigger buffer is not supported in combination with a live tap");
+    }
+
+    for (auto& stream: _streams)
+    {
+        if (stream.has_samples)
+        {
+            throw std::logic_error("the pre-trigger buffer has to be set before the first sample is written");
+        }
+    }
+
+    _pre_trigger_duration = getFileTimeStamp(duration);
+    _pre_trigger_max_size = max_size;
+    _post_trigger_duration = getFileTimeStamp(post_trigger_duration);
+    _pre_trigger_active = true;
+    if (!_next_file.valid())
+    {
+        prepareNextFile();
+    }
+}
+
+void Writer::writeEventFile(std::shared_ptr<EventQueue> queue,
+                            std::future<std::unique_ptr<CompatIndexedFileWriter>> next_file)
+{
+    // the tasks are taken from the queue after an error as well, so that their chunks are released
+    std::exception_ptr error;
+    std::unique_ptr<CompatIndexedFileWriter> file;
+    try
+    {
+        file = next_file.get();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    EventTask task;
+    while (queue->pop(task))
+    {
+        if (!error)
+        {
+            try
+            {
+                task(*file);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        }
+        task = nullptr;
+    }
+
+    if (file)
+    {
+        try
+        {
+            file->close();
+        }
+        catch (...)
+        {
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+std::string Writer::trigger()
+{
+    if (!_pre_trigger_active)
+    {
+        throw std::logic_error("no pre-trigger buffer has been set");
+    }
+    checkChunkWrite();
+
+    // pending containers belong to the time before the trigger
+    writeAllPackedSamples();
+    completeEvents(_last_time_stamp);
+
+    Event event;
+    event.queue = std::make_shared<EventQueue>();
+    event.end_time_stamp = _last_time_stamp + _post_trigger_duration;
+    _file_names.push_back(getPartFileName(_file_names.front(), _file_names.size()));
+
+    std::vector<std::pair<ifhd::v400::CompressionCodec, int>> compression;
+    for (auto& stream: _streams)
+    {
+        event.initial_types.push_back(stream.initial_type);
+        compression.emplace_back(stream.compression_codec, stream.compression_level);
+    }
+
+    // the event file is prepared, filled with the retained chunks and written by its own thread
+    auto description = _description;
+    std::vector<std::shared_ptr<const BufferedChunk>> chunks(_pre_trigger_chunks.begin(), _pre_trigger_chunks.end());
+    event.queue->post([description, compression, chunks](CompatIndexedFileWriter& file)
+    {
+        if (!description.empty())
+        {
+            file.setDescription(description);
+        }
+
+        for (size_t stream_id = 0; stream_id < compression.size(); ++stream_id)
+        {
+            if (compression[stream_id].first != ifhd::v400::CompressionCodec::cc_none)
+            {
+                file.setStreamCompression(static_cast<uint16_t>(stream_id), compression[stream_id].first,
+                                          compression[stream_id].second);
+            }
+        }
+
+        for (auto& chunk: chunks)
+        {
+            file.writeChunk(chunk->stream_id, chunk->data.data(), static_cast<uint32_t>(chunk->data.size()),
+                            chunk->time_stamp, chunk->flags);
+        }
+    });
+    event.writing = std::async(std::launch::async, writeEventFile, event.queue, std::move(_next_file));
+
+    _events.push_back(std::move(event));
+    prepareNextFile();
+    return _file_names.back();
+}
+
+void Writer::bufferChunk(BufferedChunk&& chunk)
+{
+    completeEvents(chunk.time_stamp);
+
+    auto buffered_chunk = std::make_shared<const BufferedChunk>(std::move(chunk));
+    for (auto& event: _events)
+    {
+        event.queue->post([buffered_chunk](CompatIndexedFileWriter& file)
+        {
+            file.writeChunk(buffered_chunk->stream_id, buffered_chunk->data.data(),
+                            static_cast<uint32_t>(buffered_chunk->data.size()),
+                            buffered_chunk->time_stamp, buffered_chunk->flags);
+        });
+    }
+
+    _pre_trigger_size += buffered_chunk->data.size();
+    _pre_trigger_chunks.push_back(std::move(buffered_chunk));
+
+    // the latest chunk is always retained, dropped stream types become the initial types
+    while (_pre_trigger_chunks.size() > 1)
+    {
+        auto& oldest = *_pre_trigger_chunks.front();
+        bool size_exceeded = _pre_trigger_max_size > 0 && _pre_trigger_size > _pre_trigger_max_size;
+        bool duration_exceeded = _pre_trigger_duration > 0 &&
+                                 _pre_trigger_chunks.back()->time_stamp - oldest.time_stamp > _pre_trigger_duration;
+        if (!size_exceeded && !duration_exceeded)
+        {
+            break;
+        }
+
+        _pre_trigger_size -= oldest.data.size();
+        if (oldest.flags & ChunkType::ct_type)
+        {
+            _streams[oldest.stream_id].initial_type = oldest.data;
+        }
+        _pre_trigger_chunks.pop_front();
+    }
+}
+
+void Writer::completeEvents(timestamp_t time_stamp)
+{
+    for (auto event = _events.begin(); event != _events.end();)
+    {
+        if (time_stamp <= event->end_time_stamp)
+        {
+            ++event;
+            continue;
+        }
+
+        // the event is completed even if collecting its stream information fails, streams that
+        // have been created after the trigger start with their current initial type
+        Event completed_event = std::move(*event);
+        event = _events.erase(event);
+
+        std::exception_ptr error;
+        try
+        {
+            auto stream_infos = getStreamInfos(completed_event.initial_types);
+            completed_event.queue->post([stream_infos](CompatIndexedFileWriter& file)
+            {
+                setStreamInfos(file, stream_infos);
+            });
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        completed_event.queue->complete();
+        completeInBackground(std::move(completed_event.writing));
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+std::vector<std::string> Writer::getFileNames() const
+{
+    return _file_names;
+}
+
+void Writer::prepareNextFile()
+{
+    auto file_name = getPartFileName(_file_names.front(), _file_names.size());
+    auto settings = _file_settings;
+    _next_file = std::async(std::launch::async, [file_name, settings]()
+    {
+        return createFile(file_name, settings, std::chrono::nanoseconds(0), nullptr);
+    });
+}
+
+void Writer::rollFileIfRequired(timestamp_t time_stamp)
+{
+    if (!_next_file.valid() || _pre_trigger_active)
+    {
+        return;
+    }
+
+    if (!_file_has_chunks)
+    {
+        _file_start_time_stamp = time_stamp;
+        _file_has_chunks = true;
+        return;
+    }
+
+    bool size_reached = _rolling_max_file_size > 0 &&
+                        static_cast<uint64_t>(_file->GetFilePos()) >= _rolling_max_file_size;
+    bool duration_reached = _rolling_max_duration > 0 &&
+                            time_stamp - _file_start_time_stamp >= _rolling_max_duration;
+    if (!size_reached && !duration_reached)
+    {
+        return;
+    }
+
+    // all pending data belongs to the current file, the item that triggered the switch is the
+    // first one of the next file
+    writeAllPackedSamples();
+    setStreamInfos(*_file, getStreamInfos({}));
+
+    std::unique_ptr<CompatIndexedFileWriter> previous_file = std::move(_file);
+    _file = _next_file.get();
+    _file_names.push_back(getPartFileName(_file_names.front(), _file_names.size()));
+    _file_start_time_stamp = time_stamp;
+
+    if (!_description.empty())
+    {
+        _file->setDescription(_description);
+    }
+
+    for (size_t stream_id = 1; stream_id < _streams.size(); ++stream_id)
+    {
+        auto& stream = _streams[stream_id];
+        if (!stream.current_type.empty())
+        {
+            stream.initial_type = std::move(stream.current_type);
+            stream.current_type.clear();
+        }
+
+        if (stream.compression_codec != ifhd::v400::CompressionCodec::cc_none)
+        {
+            _file->setStreamCompression(static_cast<uint16_t>(stream_id), stream.compression_codec, stream.compression_level);
+        }
+    }
+
+    closeInBackground(std::move(previous_file));
+    prepareNextFile();
+}
+
+void Writer::closeInBackground(std::unique_ptr<CompatIndexedFileWriter> file)
+{
+    completeInBackground(std::async(std::launch::async, [](CompatIndexedFileWriter* file)
+    {
+        std::unique_ptr<CompatIndexedFileWriter> closing_file(file);
+        closing_file->close();
+    }, file.release()));
+}
+
+void Writer::completeInBackground(std::future<void> completion)
+{
+    // only one file is completed at a time, this also reports errors of the previous one
+    std::exception_ptr error;
+    if (_closing_file.valid())
+    {
+        try
+        {
+            _closing_file.get();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+    }
+    _closing_file = std::move(completion);
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
 void Writer::quitHistory()
 {
     _file->quitHistory();
@@ -202,6 +986,7 @@ std::shared_ptr<OutputStream> Writer::getExtensionStream(const std::string& name
 
     if (!_lock_chunk_write)
     {
+        writeAllPackedSamples();
         _file->stopAndFlushCache();
         _lock_chunk_write = true;
     }
@@ -229,38 +1014,117 @@ Writer::Chunk Writer::serialize(size_t stream_id, std::chrono::nanoseconds time_
     return chunk;
 }
 
-Writer::Chunk Writer::serialize(size_t stream_id, std::chrono::nanoseconds time_stamp, const WriteSample& sample)
-{
-    auto stream = _streams.at(stream_id);
-    Chunk chunk(stream_id, time_stamp, 0);
-    stream.sample_serializer->serialize(sample, chunk);
-    return chunk;
-}
-
 Writer::Chunk Writer::serializeTrigger(size_t stream_id, std::chrono::nanoseconds time_stamp)
 {
     return Chunk(stream_id, time_stamp, ChunkType::ct_trigger);
 }
 
 void Writer::write(const Writer::Chunk& chunk)
+{
+    checkChunkWrite();
+    auto time_stamp = getFileTimeStamp(chunk.time_stamp);
+    _last_time_stamp = std::max(_last_time_stamp, time_stamp);
+    if (_pre_trigger_active)
+    {
+        BufferedChunk buffered_chunk{static_cast<uint16_t>(chunk.stream_id), time_stamp, chunk.flags, {}};
+        buffered_chunk.data.write(chunk.data(), chunk.size());
+        bufferChunk(std::move(buffered_chunk));
+        return;
+    }
+    _file->writeChunk(static_cast<uint16_t>(chunk.stream_id), chunk.data(), static_cast<uint32_t>(chunk.size()), time_stamp, chunk.flags);
+}
+
+void Writer::checkChunkWrite() const
 {
     if (_lock_chunk_write)
     {
        throw std::runtime_error("Can not add data after GetExtensionStream was used");
     }
-    timestamp_t time_stamp = _target_adtf_version == adtf3ns ? chunk.time_stamp.count() : std::chrono::duration_cast<std::chrono::microseconds>(chunk.time_stamp).count();
-    _file->writeChunk(static_cast<uint16_t>(chunk.stream_id), chunk.data(), static_cast<uint32_t>(chunk.size()), time_stamp, chunk.flags);
+}
+
+timestamp_t Writer::getFileTimeStamp(std::chrono::nanoseconds time_stamp) const
+{
+    return _target_adtf_version == adtf3ns ? time_stamp.count() : std::chrono::duration_cast<std::chrono::microseconds>(time_stamp).count();
 }
 
 Writer::~Writer()
 {
-    if (_target_adtf_version >= adtf3)
+    try
     {
-        closeAdtf3();
+        close();
     }
-    else
+    catch (...)
     {
-        closeAdtf2();
+    }
+}
+
+void Writer::close()
+{
+    if (!_file)
+    {
+        return;
+    }
+
+    // every step is done even if a previous one failed, the first error is reported at the end
+    std::exception_ptr error;
+    auto run = [&error](const std::function<void()>& step)
+    {
+        try
+        {
+            step();
+        }
+        catch (...)
+        {
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    run([&]
+    {
+        if (_target_adtf_version >= adtf3)
+        {
+            closeAdtf3();
+        }
+        else
+        {
+            closeAdtf2();
+        }
+    });
+    _file.reset();
+
+    // events whose post-trigger window has not ended yet are completed with the items so far
+    while (!_events.empty())
+    {
+        run([&]
+        {
+            completeEvents(std::numeric_limits<timestamp_t>::max());
+        });
+    }
+
+    if (_closing_file.valid())
+    {
+        run([&]
+        {
+            _closing_file.get();
+        });
+    }
+
+    // the file prepared for rolling is not needed anymore
+    if (_next_file.valid())
+    {
+        run([&]
+        {
+            _next_file.get()->close();
+            a_util::filesystem::remove(getPartFileName(_file_names.front(), _file_names.size()));
+        });
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
     }
 }
 
@@ -279,46 +1143,74 @@ std::string strip_compatibility_postfix(const std::string& id)
     }
 }
 
-void Writer::closeAdtf2()
+std::vector<Writer::StreamInfo> Writer::getStreamInfos(const std::vector<Buffer>& initial_types) const
 {
+    std::vector<StreamInfo> stream_infos(_streams.size());
     for (size_t stream_id = 1; stream_id < _streams.size(); ++stream_id)
     {
         auto& stream = _streams[stream_id];
-        _file->setStreamName(static_cast<uint16_t>(stream_id), stream.name.c_str());
+        auto& initial_type = stream_id < initial_types.size() ? initial_types[stream_id] : stream.initial_type;
+        auto& stream_info = stream_infos[stream_id];
+        stream_info.name = stream.name;
+
+        if (_target_adtf_version >= adtf3)
+        {
+            stream_info.additional_info = initial_type;
+            if (stream.packing_max_sample_count > 0)
+            {
+                stream_info.additional_info << std::string(adtf3::packed_samples_id);
+            }
+            stream_info.additional_info << stream.sample_serializer->getId();
+        }
+        else
+        {
+            std::string sample_id = strip_compatibility_postfix(stream.sample_serializer->getId());
+            sample_id.resize(UCOM_MAX_IDENTIFIER_SIZE, '\0');
 
-        std::string sample_id = strip_compatibility_postfix(stream.sample_serializer->getId());
-        sample_id.resize(UCOM_MAX_IDENTIFIER_SIZE, '\0');
+            std::string type_id = strip_compatibility_postfix(stream.adtf2_initial_type_id);
+            type_id.resize(UCOM_MAX_IDENTIFIER_SIZE, '\0');
 
-        std::string type_id = strip_compatibility_postfix(stream.adtf2_initial_type_id);
-        type_id.resize(UCOM_MAX_IDENTIFIER_SIZE, '\0');
+            stream_info.additional_info.write(sample_id.data(), sample_id.size());
+            stream_info.additional_info.write(type_id.data(), type_id.size());
+            stream_info.additional_info.write(initial_type.data(), initial_type.size());
+        }
+    }
 
-        Buffer additional_data_stream;
-        additional_data_stream.write(sample_id.data(), sample_id.size());
-        additional_data_stream.write(type_id.data(), type_id.size());
-        additional_data_stream.write(stream.initial_type.data(), stream.initial_type.size());
+    return stream_infos;
+}
 
-        _file->setAdditionalStreamInfo(static_cast<uint16_t>(stream_id), additional_data_stream.data(), static_cast<uint32_t>(additional_data_stream.size()));
+void Writer::setStreamInfos(CompatIndexedFileWriter& file, const std::vector<StreamInfo>& stream_infos)
+{
+    for (size_t stream_id = 1; stream_id < stream_infos.size(); ++stream_id)
+    {
+        auto& stream_info = stream_infos[stream_id];
+        file.setStreamName(static_cast<uint16_t>(stream_id), stream_info.name.c_str());
+        file.setAdditionalStreamInfo(static_cast<uint16_t>(stream_id), stream_info.additional_info.data(),
+                                     static_cast<uint32_t>(stream_info.additional_info.size()));
     }
+}
 
+void Writer::closeAdtf2()
+{
+    setStreamInfos(*_file, getStreamInfos({}));
     _file->close();
 }
 
 void Writer::closeAdtf3()
 {
-    for (size_t stream_id = 1; stream_id < _streams.size(); ++stream_id)
+    if (!_lock_chunk_write)
     {
-        auto& stream = _streams[stream_id];
-        _file->setStreamName(stream_id, stream.name.c_str());
-        stream.initial_type << stream.sample_serializer->getId();
-        _file->setAdditionalStreamInfo(static_cast<uint16_t>(stream_id), stream.initial_type.data(), static_cast<uint32_t>(stream.initial_type.size()));
+        writeAllPackedSamples();
     }
 
+    setStreamInfos(*_file, getStreamInfos({}));
     _file->close();
 }
 
 void Writer::setFileDescription(const std::string& description)
 {
     _file->setDescription(description);
+    _description = description;
 }
 
 
@@ -0,0 +1,118 @@
+/**
+ * @file
+ * sample that refers to the data of the reader.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <adtf_file/sample_view.h>
+
+namespace adtf_file
+{
+
+void SampleView::setTimeStamp(std::chrono::nanoseconds time_stamp)
+{
+    _time_stamp = time_stamp;
+}
+
+void SampleView::setSubStreamId(uint32_t substream_id)
+{
+    _substream_id = substream_id;
+}
+
+void SampleView::setFlags(uint32_t flags)
+{
+    _flags = flags;
+}
+
+void* SampleView::beginBufferWrite(size_t size)
+{
+    // the capacity is kept, so this allocates only for the largest sample
+    _buffer.resize(size);
+    _data = _buffer.data();
+    _data_size = size;
+    return _buffer.data();
+}
+
+void SampleView::endBufferWrite()
+{
+}
+
+void SampleView::addInfo(uint32_t key, DataType type, uint64_t raw_bytes)
+{
+    for (auto& info: _info)
+    {
+        if (info.key == key)
+        {
+            info.type = type;
+            info.raw_bytes = raw_bytes;
+            return;
+        }
+    }
+
+    _info.push_back({key, type, raw_bytes});
+}
+
+bool SampleView::referenceBuffer(const void* data, size_t size)
+{
+    _data = data;
+    _data_size = size;
+    return true;
+}
+
+std::chrono::nanoseconds SampleView::getTimeStamp() const
+{
+    return _time_stamp;
+}
+
+uint32_t SampleView::getSubStreamId() const
+{
+    return _substream_id;
+}
+
+uint32_t SampleView::getFlags() const
+{
+    return _flags;
+}
+
+std::pair<const void*, size_t> SampleView::beginBufferRead() const
+{
+    return std::make_pair(_data, _data_size);
+}
+
+void SampleView::endBufferRead() const
+{
+}
+
+void SampleView::iterateInfo(std::function<void(uint32_t key, DataType type, uint64_t raw_bytes)> functor) const
+{
+    for (auto& info: _info)
+    {
+        functor(info.key, info.type, info.raw_bytes);
+    }
+}
+
+void SampleView::reset()
+{
+    _time_stamp = std::chrono::nanoseconds(0);
+    _substream_id = 0;
+    _flags = 0;
+    _data = nullptr;
+    _data_size = 0;
+    _info.clear();
+}
+
+}
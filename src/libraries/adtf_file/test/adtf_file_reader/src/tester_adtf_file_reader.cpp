@@ -348,6 +348,115 @@ GTEST_TEST(TestSeekAndGetIndex, AdtfFileReader)
     ASSERT_EQ(reader.getNextItem().time_stamp, time_stamp_1);
 }
 
+GTEST_TEST(TestStreamFilter, AdtfFileReader)
+{
+    Reader reader(TEST_FILES_DIR "/test_stop_signal.dat", StandardTypeDeserializers(), StandardSampleDeserializers());
+
+    for (auto& stream: reader.getStreams())
+    {
+        reader.setStreamFilter({stream.stream_id});
+        reader.seekTo(0);
+
+        uint64_t item_count = 0;
+        for (;; ++item_count)
+        {
+            try
+            {
+                auto item = reader.getNextItem();
+                ASSERT_EQ(item.stream_id, stream.stream_id);
+            }
+            catch (const exceptions::EndOfFile&)
+            {
+                break;
+            }
+        }
+
+        ASSERT_EQ(item_count, stream.item_count);
+    }
+
+    reader.setStreamFilter({});
+    reader.seekTo(0);
+
+    uint64_t item_count = 0;
+    for (;; ++item_count)
+    {
+        try
+        {
+            reader.getNextItem();
+        }
+        catch (const exceptions::EndOfFile&)
+        {
+            break;
+        }
+    }
+
+    ASSERT_EQ(item_count, reader.getItemCount());
+}
+
+GTEST_TEST(TestNextItemView, AdtfFileReader)
+{
+    for (auto file_name: {TEST_FILES_DIR "/test_stop_signal.dat",
+                          TEST_FILES_DIR "/example_test_file.dat",
+                          TEST_FILES_DIR "/adtf2/test_sample_info.dat"})
+    {
+        Reader reader(file_name, StandardTypeDeserializers(), StandardSampleDeserializers());
+        Reader view_reader(file_name, StandardTypeDeserializers(), StandardSampleDeserializers());
+
+        uint64_t item_count = 0;
+        for (;; ++item_count)
+        {
+            FileItem item;
+            try
+            {
+                item = reader.getNextItem();
+            }
+            catch (const exceptions::EndOfFile&)
+            {
+                ASSERT_THROW(view_reader.getNextItemView(), exceptions::EndOfFile);
+                break;
+            }
+
+            auto& view = view_reader.getNextItemView();
+            ASSERT_EQ(view.stream_id, item.stream_id);
+            ASSERT_EQ(view.time_stamp, item.time_stamp);
+
+            auto sample = std::dynamic_pointer_cast<const DefaultSample>(item.stream_item);
+            if (sample)
+            {
+                auto sample_view = dynamic_cast<const SampleView*>(view.stream_item);
+                ASSERT_TRUE(sample_view);
+                ASSERT_EQ(sample_view->getTimeStamp(), sample->getTimeStamp());
+                ASSERT_EQ(sample_view->getFlags(), sample->getFlags());
+                ASSERT_EQ(sample_view->getSubStreamId(), sample->getSubStreamId());
+
+                auto buffer = sample->beginBufferRead();
+                auto view_buffer = sample_view->beginBufferRead();
+                ASSERT_EQ(view_buffer.second, buffer.second);
+                ASSERT_EQ(memcmp(view_buffer.first, buffer.first, buffer.second), 0);
+
+                size_t info_count = 0;
+                sample_view->iterateInfo([&](uint32_t key, DataType type, uint64_t raw_bytes)
+                {
+                    ASSERT_EQ(sample->GetInfo().at(key).first, type);
+                    ASSERT_EQ(sample->GetInfo().at(key).second, raw_bytes);
+                    ++info_count;
+                });
+                ASSERT_EQ(info_count, sample->GetInfo().size());
+            }
+            else if (std::dynamic_pointer_cast<const Trigger>(item.stream_item))
+            {
+                ASSERT_TRUE(dynamic_cast<const Trigger*>(view.stream_item));
+            }
+            else
+            {
+                ASSERT_TRUE(dynamic_cast<const StreamType*>(view.stream_item));
+            }
+        }
+
+        ASSERT_EQ(item_count, reader.getItemCount());
+    }
+}
+
 static constexpr const char* adtf2_core_media_type_cid = "adtf.core.media_type.adtf2_support.serialization.adtf.cid";
 static constexpr const char* test_meta_type = "test_meta_type";
 
@@ -19,6 +19,7 @@
  */
 
 #include "gtest/gtest.h"
+#include <cstring>
 #include <adtf_file/adtf_file_writer.h>
 #include <adtf_file/adtf_file_reader.h>
 #include <adtf_file/standard_factories.h>
@@ -324,3 +325,484 @@ GTEST_TEST(TestInitialType, AdtfFileWriter)
 
     check_property(stream.initial_type, "counter", "2");
 }
+
+class CollectingOutputStream: public OutputStream
+{
+    public:
+        void write(const void* data, size_t data_size) override
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            written.insert(written.end(), bytes, bytes + data_size);
+        }
+
+    public:
+        std::vector<uint8_t> written;
+};
+
+void check_serialized_size(SampleSerializer& serializer, const WriteSample& sample)
+{
+    CollectingOutputStream stream;
+    serializer.serialize(sample, stream);
+
+    size_t serialized_size = 0;
+    ASSERT_TRUE(serializer.getSerializedSize(sample, serialized_size));
+    ASSERT_EQ(serialized_size, stream.written.size());
+
+    std::vector<uint8_t> memory(serialized_size);
+    serializer.serializeInto(sample, memory.data(), memory.size());
+    ASSERT_EQ(memory, stream.written);
+
+    memory.resize(serialized_size + 1);
+    ASSERT_THROW(serializer.serializeInto(sample, memory.data(), memory.size()), std::runtime_error);
+    ASSERT_THROW(serializer.serializeInto(sample, memory.data(), serialized_size - 1), std::runtime_error);
+}
+
+GTEST_TEST(TestSerializedSize, AdtfFileWriter)
+{
+    DefaultStreamType stream_type("adtf/anonymous");
+    std::vector<std::shared_ptr<SampleSerializer>> serializers{std::make_shared<adtf3::SampleCopySerializer>(),
+                                                               std::make_shared<adtf3::SampleCopySerializerNs>()};
+
+    for (auto& serializer: serializers)
+    {
+        serializer->setStreamType(stream_type);
+
+        DefaultSample sample;
+        sample.setTimeStamp(std::chrono::microseconds(17));
+        sample.setContent(uint64_t(42));
+        check_serialized_size(*serializer, sample);
+
+        sample.setSubStreamId(3);
+        check_serialized_size(*serializer, sample);
+
+        sample.addInfo(1, DataType::uint32, 5);
+        sample.addInfo(2, DataType::float64, 6);
+        check_serialized_size(*serializer, sample);
+    }
+}
+
+void check_serialized_size_with_sample_info(SampleSerializer& serializer, const StreamType& stream_type)
+{
+    serializer.setStreamType(stream_type);
+
+    DefaultSample sample;
+    sample.setTimeStamp(std::chrono::microseconds(17));
+    sample.setContent(uint32_t(42));
+    check_serialized_size(serializer, sample);
+
+    sample.addInfo(1, DataType::uint32, 5);
+    sample.addInfo(2, DataType::float64, 6);
+    check_serialized_size(serializer, sample);
+}
+
+GTEST_TEST(TestMediaDescriptionSerializedSize, AdtfFileWriter)
+{
+    DefaultStreamType stream_type("adtf/anonymous");
+    stream_type.setProperty("md_struct", "cString", "test");
+    stream_type.setProperty("md_definitions", "cString", R"(
+                            <struct name="test" version="1">
+                            <element name="sample_index" type="tUInt32" arraysize="1" alignment="1">
+                                <serialized bytepos="0" byteorder="LE"/>
+                                <deserialized alignment="1"/>
+                            </element>
+                            </struct>)");
+
+    adtf3::MediaDescriptionSerializer serializer;
+    check_serialized_size_with_sample_info(serializer, stream_type);
+
+    adtf3::MediaDescriptionSerializerNs serializer_ns;
+    check_serialized_size_with_sample_info(serializer_ns, stream_type);
+}
+
+GTEST_TEST(TestAdtfCoreMediaSampleSerializedSize, AdtfFileWriter)
+{
+    DefaultStreamType stream_type("adtf2/legacy");
+    stream_type.setProperty("major", "tInt", "0");
+    stream_type.setProperty("sub", "tInt", "0");
+    stream_type.setProperty("flags", "tInt", "0");
+
+    adtf2::AdtfCoreMediaSampleSerializer raw_serializer;
+    check_serialized_size_with_sample_info(raw_serializer, stream_type);
+
+    stream_type.setProperty("md_struct", "cString", "test");
+    stream_type.setProperty("md_definitions", "cString", R"(
+                            <struct name="test" version="1">
+                                <element name="sample_index" type="tUInt32" alignment="1" arraysize="1" alignment="1" bytepos="0" byteorder="LE"/>
+                            </struct>)");
+
+    adtf2::AdtfCoreMediaSampleSerializer serializer;
+    check_serialized_size_with_sample_info(serializer, stream_type);
+}
+
+GTEST_TEST(TestPackedSamples, AdtfFileWriter)
+{
+    const size_t sample_count = 1000;
+    {
+        Writer writer(TEST_FILES_DIR "/test_packed_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers());
+
+        DefaultStreamType stream_type("adtf/anonymous");
+        auto packed_stream_id = writer.createStream("packed", stream_type, std::make_shared<adtf3::SampleCopySerializerNs>());
+        auto stream_id = writer.createStream("unpacked", stream_type, std::make_shared<adtf3::SampleCopySerializerNs>());
+        writer.setSamplePacking(packed_stream_id, 16, 4096, std::chrono::milliseconds(50));
+
+        for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
+        {
+            std::chrono::milliseconds time_stamp(sample_index);
+
+            DefaultSample sample;
+            sample.setTimeStamp(time_stamp);
+            sample.setContent(sample_index);
+            writer.write(packed_stream_id, time_stamp, sample);
+
+            if (sample_index % 10 == 0)
+            {
+                writer.write(stream_id, time_stamp, sample);
+            }
+
+            if (sample_index == sample_count / 2)
+            {
+                writer.write(packed_stream_id, time_stamp, stream_type);
+            }
+        }
+
+        ASSERT_THROW(writer.setSamplePacking(packed_stream_id, 16, 4096, std::chrono::milliseconds(50)), std::logic_error);
+    }
+
+    {
+        TestFile file(TEST_FILES_DIR "/test_packed_adtf3.dat");
+        ASSERT_EQ(file.streams.size(), 2);
+        auto& stream = file.streams["packed"];
+        ASSERT_EQ(stream.samples.size(), sample_count);
+        ASSERT_EQ(stream.types.size(), 1);
+        for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
+        {
+            ASSERT_EQ(stream.sample_timestamps[sample_index], sample_index * 1000000);
+            ASSERT_EQ(*static_cast<const size_t*>(stream.samples[sample_index]->beginBufferRead().first), sample_index);
+            stream.samples[sample_index]->endBufferRead();
+        }
+        ASSERT_EQ(file.streams["unpacked"].samples.size(), sample_count / 10);
+    }
+
+    Reader reader(TEST_FILES_DIR "/test_packed_adtf3.dat", StandardTypeDeserializers(), StandardSampleDeserializers());
+    EXPECT_LT(reader.getItemCount(), sample_count);
+
+    size_t view_sample_count = 0;
+    try
+    {
+        for (;;)
+        {
+            auto& item = reader.getNextItemView();
+            auto sample = dynamic_cast<const WriteSample*>(item.stream_item);
+            if (sample && item.stream_id == 1)
+            {
+                ASSERT_EQ(item.time_stamp, std::chrono::milliseconds(view_sample_count));
+                ASSERT_EQ(*static_cast<const size_t*>(sample->beginBufferRead().first), view_sample_count);
+                sample->endBufferRead();
+                ++view_sample_count;
+            }
+        }
+    }
+    catch (const exceptions::EndOfFile&)
+    {
+    }
+    ASSERT_EQ(view_sample_count, sample_count);
+
+    for (size_t seek_index: {0, 123, 500, 999})
+    {
+        reader.seekTo(reader.getItemIndexForTimeStamp(std::chrono::milliseconds(seek_index)));
+        for (;;)
+        {
+            auto item = reader.getNextItem();
+            if (item.stream_id == 1 && std::dynamic_pointer_cast<const DefaultSample>(item.stream_item))
+            {
+                ASSERT_EQ(item.time_stamp, std::chrono::milliseconds(seek_index));
+                break;
+            }
+        }
+    }
+}
+
+GTEST_TEST(TestPackedSampleFilters, AdtfFileWriter)
+{
+    struct Content
+    {
+        uint64_t counter;
+        double value;
+        uint32_t flags;
+        uint8_t bytes[13];
+    };
+
+    const size_t sample_count = 1000;
+    const std::vector<std::pair<std::string, uint32_t>> filters =
+    {
+        {"delta", Writer::packing_filter_delta},
+        {"shuffle", Writer::packing_filter_shuffle},
+        {"delta_shuffle", Writer::packing_filter_delta | Writer::packing_filter_shuffle},
+        {"variable_size", Writer::packing_filter_delta | Writer::packing_filter_shuffle}
+    };
+
+    auto get_content = [](size_t sample_index)
+    {
+        Content content;
+        memset(&content, 0, sizeof(content));
+        content.counter = sample_index;
+        content.value = sample_index * 0.5;
+        content.flags = sample_index % 3 == 0 ? 0xAA55 : 0;
+        content.bytes[sample_index % sizeof(content.bytes)] = static_cast<uint8_t>(sample_index);
+        return content;
+    };
+
+    {
+        Writer writer(TEST_FILES_DIR "/test_packed_filters_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers());
+
+        DefaultStreamType stream_type("adtf/anonymous");
+        std::vector<size_t> stream_ids;
+        for (auto& filter: filters)
+        {
+            stream_ids.push_back(writer.createStream(filter.first, stream_type, std::make_shared<adtf3::SampleCopySerializerNs>()));
+            writer.setSamplePacking(stream_ids.back(), 37, 65536, std::chrono::seconds(1), filter.second);
+        }
+
+        for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
+        {
+            std::chrono::milliseconds time_stamp(sample_index);
+            DefaultSample sample;
+            sample.setTimeStamp(time_stamp);
+            sample.setContent(get_content(sample_index));
+            for (size_t stream_index = 0; stream_index < 3; ++stream_index)
+            {
+                writer.write(stream_ids[stream_index], time_stamp, sample);
+            }
+
+            if (sample_index % 100 == 0)
+            {
+                sample.setContent(sample_index);
+            }
+            writer.write(stream_ids[3], time_stamp, sample);
+        }
+    }
+
+    TestFile file(TEST_FILES_DIR "/test_packed_filters_adtf3.dat");
+    ASSERT_EQ(file.streams.size(), filters.size());
+    for (auto& filter: filters)
+    {
+        auto& stream = file.streams[filter.first];
+        ASSERT_EQ(stream.samples.size(), sample_count);
+        for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
+        {
+            ASSERT_EQ(stream.sample_timestamps[sample_index], sample_index * 1000000);
+            auto buffer = stream.samples[sample_index]->beginBufferRead();
+            if (filter.first == "variable_size" && sample_index % 100 == 0)
+            {
+                ASSERT_EQ(buffer.second, sizeof(size_t));
+                ASSERT_EQ(*static_cast<const size_t*>(buffer.first), sample_index);
+            }
+            else
+            {
+                auto content = get_content(sample_index);
+                ASSERT_EQ(buffer.second, sizeof(content));
+                ASSERT_EQ(memcmp(buffer.first, &content, sizeof(content)), 0);
+            }
+            stream.samples[sample_index]->endBufferRead();
+        }
+    }
+}
+
+GTEST_TEST(TestFileRolling, AdtfFileWriter)
+{
+    const size_t sample_count = 1000;
+    std::vector<std::string> file_names;
+    {
+        Writer writer(TEST_FILES_DIR "/test_rolling_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers());
+
+        DefaultStreamType stream_type("adtf/anonymous");
+        stream_type.setProperty("counter", "tUInt", "1");
+        auto stream_id = writer.createStream("samples", stream_type, std::make_shared<adtf3::SampleCopySerializerNs>());
+        auto packed_stream_id = writer.createStream("packed", stream_type, std::make_shared<adtf3::SampleCopySerializerNs>());
+        writer.setSamplePacking(packed_stream_id, 16, 4096, std::chrono::milliseconds(50));
+        writer.setFileRolling(0, std::chrono::milliseconds(100));
+
+        for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
+        {
+            std::chrono::milliseconds time_stamp(sample_index);
+            DefaultSample sample;
+            sample.setTimeStamp(time_stamp);
+            sample.setContent(sample_index);
+            writer.write(stream_id, time_stamp, sample);
+            writer.write(packed_stream_id, time_stamp, sample);
+
+            if (sample_index == 250)
+            {
+                stream_type.setProperty("counter", "tUInt", "2");
+                writer.write(stream_id, time_stamp, stream_type);
+            }
+        }
+
+        file_names = writer.getFileNames();
+    }
+
+    ASSERT_EQ(file_names.size(), sample_count / 100);
+    ASSERT_EQ(file_names[0], TEST_FILES_DIR "/test_rolling_adtf3.dat");
+    ASSERT_EQ(file_names[1], TEST_FILES_DIR "/test_rolling_adtf3_001.dat");
+    ASSERT_FALSE(a_util::filesystem::exists(TEST_FILES_DIR "/test_rolling_adtf3_010.dat"));
+
+    for (size_t file_index = 0; file_index < file_names.size(); ++file_index)
+    {
+        TestFile file(file_names[file_index]);
+        for (std::string stream_name: {"samples", "packed"})
+        {
+            auto& stream = file.streams[stream_name];
+            check_property(stream.initial_type, "counter", stream_name == "samples" && file_index >= 3 ? "2" : "1");
+            ASSERT_EQ(stream.samples.size(), 100);
+            for (size_t sample_index = 0; sample_index < stream.samples.size(); ++sample_index)
+            {
+                ASSERT_EQ(stream.sample_timestamps[sample_index], (file_index * 100 + sample_index) * 1000000);
+            }
+        }
+        ASSERT_EQ(file.streams["samples"].types.size(), file_index == 2 ? 1 : 0);
+    }
+}
+
+GTEST_TEST(TestPreTriggerBuffer, AdtfFileWriter)
+{
+    std::vector<std::string> file_names;
+    {
+        Writer writer(TEST_FILES_DIR "/test_pre_trigger_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers());
+
+        DefaultStreamType stream_type("adtf/anonymous");
+        stream_type.setProperty("counter", "tUInt", "1");
+        auto stream_id = writer.createStream("samples", stream_type, std::make_shared<adtf3::SampleCopySerializerNs>());
+        auto packed_stream_id = writer.createStream("packed", stream_type, std::make_shared<adtf3::SampleCopySerializerNs>());
+        writer.setSamplePacking(packed_stream_id, 16, 4096, std::chrono::milliseconds(50));
+        writer.setPreTriggerBuffer(std::chrono::milliseconds(100), 0, std::chrono::milliseconds(50));
+
+        for (size_t sample_index = 0; sample_index < 1000; ++sample_index)
+        {
+            std::chrono::milliseconds time_stamp(sample_index);
+            DefaultSample sample;
+            sample.setTimeStamp(time_stamp);
+            sample.setContent(sample_index);
+            writer.write(stream_id, time_stamp, sample);
+            writer.write(packed_stream_id, time_stamp, sample);
+
+            if (sample_index == 150 || sample_index == 310)
+            {
+                stream_type.setProperty("counter", "tUInt", sample_index == 150 ? "2" : "3");
+                writer.write(stream_id, time_stamp, stream_type);
+            }
+
+            // the windows of the first two events overlap
+            if (sample_index == 300 || sample_index == 320 || sample_index == 800)
+            {
+                writer.trigger();
+            }
+        }
+
+        file_names = writer.getFileNames();
+    }
+
+    ASSERT_EQ(file_names.size(), 4);
+    ASSERT_EQ(file_names[1], TEST_FILES_DIR "/test_pre_trigger_adtf3_001.dat");
+    ASSERT_FALSE(a_util::filesystem::exists(TEST_FILES_DIR "/test_pre_trigger_adtf3_004.dat"));
+
+    {
+        TestFile file(file_names[0]);
+        ASSERT_EQ(file.streams["samples"].samples.size(), 0);
+    }
+
+    const std::vector<size_t> trigger_indices{300, 320, 800};
+    for (size_t event_index = 0; event_index < trigger_indices.size(); ++event_index)
+    {
+        TestFile file(file_names[event_index + 1]);
+        auto& stream = file.streams["samples"];
+        check_property(stream.initial_type, "counter", event_index < 2 ? "2" : "3");
+        ASSERT_EQ(stream.types.size(), event_index < 2 ? 1 : 0);
+
+        // 100 ms before and 50 ms after the trigger
+        ASSERT_EQ(stream.samples.size(), 151);
+        for (size_t sample_index = 0; sample_index < stream.samples.size(); ++sample_index)
+        {
+            size_t expected_index = trigger_indices[event_index] - 100 + sample_index;
+            ASSERT_EQ(stream.sample_timestamps[sample_index], expected_index * 1000000);
+            auto buffer = stream.samples[sample_index]->beginBufferRead();
+            ASSERT_EQ(buffer.second, sizeof(size_t));
+            ASSERT_EQ(*static_cast<const size_t*>(buffer.first), expected_index);
+            stream.samples[sample_index]->endBufferRead();
+        }
+
+        // the containers of the packed stream are buffered as a whole
+        auto& packed_stream = file.streams["packed"];
+        ASSERT_GT(packed_stream.samples.size(), 0);
+        for (size_t sample_index = 0; sample_index < packed_stream.samples.size(); ++sample_index)
+        {
+            size_t expected_index = static_cast<size_t>(packed_stream.sample_timestamps[sample_index] / 1000000);
+            if (sample_index > 0)
+            {
+                ASSERT_EQ(packed_stream.sample_timestamps[sample_index], packed_stream.sample_timestamps[sample_index - 1] + 1000000);
+            }
+            auto buffer = packed_stream.samples[sample_index]->beginBufferRead();
+            ASSERT_EQ(buffer.second, sizeof(size_t));
+            ASSERT_EQ(*static_cast<const size_t*>(buffer.first), expected_index);
+            packed_stream.samples[sample_index]->endBufferRead();
+        }
+        ASSERT_LE(packed_stream.sample_timestamps.back(), (trigger_indices[event_index] + 50) * 1000000);
+    }
+}
+
+GTEST_TEST(TestClose, AdtfFileWriter)
+{
+    DefaultStreamType stream_type("adtf/anonymous");
+    {
+        Writer writer(TEST_FILES_DIR "/test_close_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers());
+        auto stream_id = writer.createStream("test", stream_type, std::make_shared<adtf3::SampleCopySerializerNs>());
+        write_samples(writer, stream_id, std::chrono::milliseconds(0), std::chrono::milliseconds(900), std::chrono::milliseconds(100));
+        ASSERT_NO_THROW(writer.close());
+        ASSERT_NO_THROW(writer.close());
+    }
+
+    {
+        TestFile file(TEST_FILES_DIR "/test_close_adtf3.dat");
+        ASSERT_EQ(file.streams["test"].samples.size(), 10);
+    }
+
+    // the next file of the rolling recording can not be created
+    const std::string blocking_directory = TEST_FILES_DIR "/test_close_error_adtf3_001.dat";
+    a_util::filesystem::createDirectory(blocking_directory);
+    {
+        Writer writer(TEST_FILES_DIR "/test_close_error_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers());
+        writer.setFileRolling(0, std::chrono::seconds(1));
+        ASSERT_ANY_THROW(writer.close());
+        ASSERT_NO_THROW(writer.close());
+    }
+
+    {
+        // the destructor ignores the error
+        Writer writer(TEST_FILES_DIR "/test_close_error_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers());
+        writer.setFileRolling(0, std::chrono::seconds(1));
+    }
+    a_util::filesystem::removeDirectory(blocking_directory);
+
+    // the event file is created by its own thread, the error is reported by close
+    const std::string blocking_event_directory = TEST_FILES_DIR "/test_close_event_error_adtf3_001.dat";
+    a_util::filesystem::createDirectory(blocking_event_directory);
+    {
+        Writer writer(TEST_FILES_DIR "/test_close_event_error_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers());
+        auto stream_id = writer.createStream("test", stream_type, std::make_shared<adtf3::SampleCopySerializerNs>());
+        writer.setPreTriggerBuffer(std::chrono::seconds(1), 0, std::chrono::seconds(1));
+        write_samples(writer, stream_id, std::chrono::milliseconds(0), std::chrono::milliseconds(900), std::chrono::milliseconds(100));
+        ASSERT_NO_THROW(writer.trigger());
+        ASSERT_ANY_THROW(writer.close());
+    }
+    a_util::filesystem::removeDirectory(blocking_event_directory);
+
+    {
+        // the live tap can not be shared by several files
+        Writer::IndexedFileSettings settings;
+        settings.live_tap_name = "adtf_file_test_close";
+        settings.live_tap_size = 64 * 1024;
+        Writer writer(TEST_FILES_DIR "/test_close_tap_adtf3.dat", std::chrono::nanoseconds(0), adtf3::StandardTypeSerializers(),
+                      Writer::adtf3ns, 0, 0, 0, 0, settings);
+        ASSERT_THROW(writer.setFileRolling(0, std::chrono::seconds(1)), std::logic_error);
+        ASSERT_THROW(writer.setPreTriggerBuffer(std::chrono::seconds(1), 0, std::chrono::seconds(1)), std::logic_error);
+    }
+}
@@ -65,10 +65,23 @@ public:
      */
     void process(std::function<bool(double)> progress_handler);
 
+    /**
+     * Enables pipelined processing. The items are read in the calling thread and dispatched to
+     * one worker thread per processor, so that each processor receives the items of its stream
+     * in order.
+     * @param [in] item_count The maximum number of items queued for each processor, 0 (the
+     *             default) processes all items in the calling thread.
+     */
+    void setWorkerQueueSize(size_t item_count);
+
+private:
+    void processPipelined(std::function<bool(double)> progress_handler);
+
 private:
     std::shared_ptr<Reader> _reader;
     const ProcessorFactories& _processor_factories;
     std::unordered_map<uint16_t, std::shared_ptr<Processor>> _processors;
+    size_t _worker_queue_size;
 };
 }
 
@@ -18,6 +18,7 @@
 #include <string>
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 #include <adtf_file/adtf_file_writer.h>
 
@@ -122,13 +123,19 @@ public:
      */
     void process(std::function<bool(double)> progress_handler);
 
-private:
-    double calculateProgress();
+    /**
+     * Sets the number of items that are read ahead from each reader by a separate thread,
+     * so that a slow reader does not stall the others.
+     * @param [in] item_count The maximum number of items per reader, 0 disables read-ahead.
+     */
+    void setReadAhead(size_t item_count);
 
 private:
     adtf_file::Writer _writer;
     bool _skip_stream_types_and_triggers;
-    std::unordered_map<std::shared_ptr<Reader>, std::unordered_map<uint16_t, size_t>>
+    size_t _read_ahead_item_count;
+    /// stream mappings of all readers in the order of addStream, the merge relies on this order
+    std::vector<std::pair<std::shared_ptr<Reader>, std::unordered_map<uint16_t, size_t>>>
         _stream_mapping;
 };
 }
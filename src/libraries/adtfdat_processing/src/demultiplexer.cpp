@@ -15,6 +15,11 @@
 
 #include <adtfdat_processing/demultiplexer.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 namespace adtf
 {
 namespace dat
@@ -22,9 +27,130 @@ namespace dat
 namespace ant
 {
 
+namespace
+{
+
+/**
+ * Feeds a processor with items from a bounded queue in a separate thread.
+ */
+class ProcessorWorker
+{
+public:
+    ProcessorWorker(const std::shared_ptr<Processor>& processor, size_t queue_size)
+        : _processor(processor),
+          _queue_size(queue_size),
+          _stop(false),
+          _drain(false)
+    {
+        _thread = std::thread(&ProcessorWorker::run, this);
+    }
+
+    ~ProcessorWorker()
+    {
+        if (_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _cond_filled.notify_one();
+            _thread.join();
+        }
+    }
+
+    /**
+     * Queues an item, blocks while the queue is full.
+     * @param [in] item The item.
+     * @throws The exception of the processor if it failed.
+     */
+    void push(adtf_file::FileItem&& item)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond_freed.wait(lock, [&] { return _items.size() < _queue_size || _error; });
+        if (_error)
+        {
+            std::rethrow_exception(_error);
+        }
+
+        _items.push_back(std::move(item));
+        if (_items.size() == 1)
+        {
+            _cond_filled.notify_one();
+        }
+    }
+
+    /**
+     * Stops the worker.
+     * @param [in] drain Whether to process all queued items first.
+     * @return The exception of the processor if it failed.
+     */
+    std::exception_ptr stop(bool drain)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+            _drain = drain;
+        }
+        _cond_filled.notify_one();
+        _thread.join();
+
+        return _error;
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            _cond_filled.wait(lock, [&] { return !_items.empty() || _stop; });
+            if (_items.empty() || (_stop && !_drain))
+            {
+                return;
+            }
+
+            auto item = std::move(_items.front());
+            _items.pop_front();
+            if (_items.size() + 1 == _queue_size)
+            {
+                _cond_freed.notify_one();
+            }
+
+            lock.unlock();
+            try
+            {
+                _processor->process(item);
+            }
+            catch (...)
+            {
+                lock.lock();
+                _error = std::current_exception();
+                _items.clear();
+                _cond_freed.notify_one();
+                return;
+            }
+            lock.lock();
+        }
+    }
+
+private:
+    std::shared_ptr<Processor> _processor;
+    size_t _queue_size;
+    std::deque<adtf_file::FileItem> _items;
+    bool _stop;
+    bool _drain;
+    std::exception_ptr _error;
+    std::mutex _mutex;
+    std::condition_variable _cond_filled;
+    std::condition_variable _cond_freed;
+    std::thread _thread;
+};
+
+}
+
 Demultiplexer::Demultiplexer(std::shared_ptr<Reader> reader,
                              const ProcessorFactories& processor_factories)
-    : _reader(reader), _processor_factories(processor_factories)
+    : _reader(reader), _processor_factories(processor_factories), _worker_queue_size(0)
 {
 }
 
@@ -40,8 +166,19 @@ void Demultiplexer::addProcessor(const std::string& stream_name,
     _processors[stream.stream_id] = processor;
 }
 
+void Demultiplexer::setWorkerQueueSize(size_t item_count)
+{
+    _worker_queue_size = item_count;
+}
+
 void Demultiplexer::process(std::function<bool(double)> progress_handler)
 {
+    if (_worker_queue_size > 0)
+    {
+        processPipelined(progress_handler);
+        return;
+    }
+
     for (;;)
     {
         adtf_file::FileItem item;
@@ -70,6 +207,65 @@ void Demultiplexer::process(std::function<bool(double)> progress_handler)
         }
     }
 }
+
+void Demultiplexer::processPipelined(std::function<bool(double)> progress_handler)
+{
+    std::unordered_map<uint16_t, std::unique_ptr<ProcessorWorker>> workers;
+    for (auto& processor : _processors)
+    {
+        workers[processor.first].reset(new ProcessorWorker(processor.second, _worker_queue_size));
+    }
+
+    // all workers are stopped before the first error of a processor is rethrown
+    auto stop_workers = [&workers](bool drain) {
+        std::exception_ptr first_error;
+        for (auto& worker : workers)
+        {
+            auto error = worker.second->stop(drain);
+            if (error && !first_error)
+            {
+                first_error = error;
+            }
+        }
+
+        if (first_error)
+        {
+            std::rethrow_exception(first_error);
+        }
+    };
+
+    for (;;)
+    {
+        adtf_file::FileItem item;
+
+        try
+        {
+            item = _reader->getNextItem();
+        }
+        catch (const adtf_file::exceptions::EndOfFile&)
+        {
+            break;
+        }
+
+        auto worker = workers.find(item.stream_id);
+        if (worker != workers.end())
+        {
+            worker->second->push(std::move(item));
+        }
+
+        if (progress_handler)
+        {
+            if (!progress_handler(_reader->getProgress()))
+            {
+                // queued items are dropped, just like the remaining items of the reader
+                stop_workers(false);
+                return;
+            }
+        }
+    }
+
+    stop_workers(true);
+}
 }
 }
 }
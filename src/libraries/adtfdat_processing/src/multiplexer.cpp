@@ -15,6 +15,12 @@
 #include <adtf_file/standard_factories.h>
 #include <adtfdat_processing/multiplexer.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 namespace adtf
 {
 namespace dat
@@ -119,6 +125,154 @@ adtf_file::FileItem OffsetReaderWrapper::getNextItem()
     return item;
 }
 
+namespace
+{
+
+/**
+ * A reader taking part in the merge, optionally with a thread that reads ahead.
+ */
+class MergeSource
+{
+public:
+    MergeSource(const std::shared_ptr<Reader>& reader,
+                const std::unordered_map<uint16_t, size_t>& stream_mapping,
+                size_t read_ahead_item_count)
+        : stream_mapping(stream_mapping),
+          _reader(reader),
+          _read_ahead_item_count(read_ahead_item_count),
+          _progress(0.0),
+          _end_of_file(false),
+          _stop(false)
+    {
+        if (_read_ahead_item_count > 0)
+        {
+            _thread = std::thread(&MergeSource::readAhead, this);
+        }
+    }
+
+    ~MergeSource()
+    {
+        if (_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _cond_freed.notify_one();
+            _thread.join();
+        }
+    }
+
+    /**
+     * @param [out] item The next item.
+     * @return false at the end of the reader.
+     */
+    bool getNextItem(adtf_file::FileItem& item)
+    {
+        if (!_thread.joinable())
+        {
+            try
+            {
+                item = _reader->getNextItem();
+                _progress = _reader->getProgress();
+                return true;
+            }
+            catch (const adtf_file::exceptions::EndOfFile&)
+            {
+                _progress = _reader->getProgress();
+                return false;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond_filled.wait(lock, [&] { return !_items.empty() || _end_of_file || _error; });
+
+        if (_items.empty())
+        {
+            if (_error)
+            {
+                std::rethrow_exception(_error);
+            }
+            return false;
+        }
+
+        item = std::move(_items.front().first);
+        _progress = _items.front().second;
+        _items.pop_front();
+        if (_items.size() + 1 == _read_ahead_item_count)
+        {
+            _cond_freed.notify_one();
+        }
+
+        return true;
+    }
+
+    /**
+     * @return The progress of the reader up to the last item returned by getNextItem.
+     */
+    double getProgress() const
+    {
+        return _progress;
+    }
+
+public:
+    const std::unordered_map<uint16_t, size_t>& stream_mapping;
+
+private:
+    void readAhead()
+    {
+        try
+        {
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _cond_freed.wait(lock, [&] { return _stop || _items.size() < _read_ahead_item_count; });
+                    if (_stop)
+                    {
+                        return;
+                    }
+                }
+
+                // the progress is queried here, the reader must only be accessed by this thread
+                auto item = _reader->getNextItem();
+                auto progress = _reader->getProgress();
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                _items.emplace_back(std::move(item), progress);
+                _cond_filled.notify_one();
+            }
+        }
+        catch (const adtf_file::exceptions::EndOfFile&)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _end_of_file = true;
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _error = std::current_exception();
+        }
+
+        _cond_filled.notify_one();
+    }
+
+private:
+    std::shared_ptr<Reader> _reader;
+    size_t _read_ahead_item_count;
+    double _progress;
+    std::deque<std::pair<adtf_file::FileItem, double>> _items;
+    bool _end_of_file;
+    bool _stop;
+    std::exception_ptr _error;
+    std::mutex _mutex;
+    std::condition_variable _cond_filled;
+    std::condition_variable _cond_freed;
+    std::thread _thread;
+};
+
+}
+
 adtf_file::StreamTypeSerializers get_stream_type_serializers(adtf_file::Writer::TargetADTFVersion target_adtf_version)
 {
     switch (target_adtf_version)
@@ -142,7 +296,8 @@ Multiplexer::Multiplexer(const std::string& destination_file_name,
               std::chrono::seconds(0),
               get_stream_type_serializers(target_adtf_version),
               target_adtf_version),
-      _skip_stream_types_and_triggers(skip_stream_types_and_triggers)
+      _skip_stream_types_and_triggers(skip_stream_types_and_triggers),
+      _read_ahead_item_count(256)
 {
 }
 
@@ -156,7 +311,17 @@ void Multiplexer::addStream(const std::shared_ptr<Reader> reader,
     {
         throw std::runtime_error("there is no stream type deserializer for the stream type of stream '" + stream_name + "'");
     }
-    _stream_mapping[reader][stream.stream_id] =
+    auto reader_mapping = std::find_if(_stream_mapping.begin(), _stream_mapping.end(),
+                                       [&](const decltype(_stream_mapping)::value_type& mapping) {
+                                           return mapping.first == reader;
+                                       });
+    if (reader_mapping == _stream_mapping.end())
+    {
+        _stream_mapping.emplace_back(reader, std::unordered_map<uint16_t, size_t>());
+        reader_mapping = std::prev(_stream_mapping.end());
+    }
+
+    reader_mapping->second[stream.stream_id] =
         _writer.createStream(destination_stream_name, *stream.initial_type, serializer);
 }
 
@@ -171,35 +336,60 @@ void Multiplexer::addExtension(const std::string& name,
     stream->write(extension_data, extension_size);
 }
 
+void Multiplexer::setReadAhead(size_t item_count)
+{
+    _read_ahead_item_count = item_count;
+}
+
 void Multiplexer::process(std::function<bool(double)> progress_handler)
 {
-    std::deque<std::pair<std::shared_ptr<Reader>, adtf_file::FileItem>> queue;
+    std::vector<std::unique_ptr<MergeSource>> sources;
     for (auto& reader : _stream_mapping)
     {
-        try
+        sources.emplace_back(new MergeSource(reader.first, reader.second, _read_ahead_item_count));
+    }
+
+    // min-heap of the next item of every source, ties are resolved by the order of the sources
+    std::vector<std::pair<adtf_file::FileItem, size_t>> heap;
+    heap.reserve(sources.size());
+    auto heap_functor = [](const std::pair<adtf_file::FileItem, size_t>& first,
+                           const std::pair<adtf_file::FileItem, size_t>& second) {
+        if (first.first.time_stamp != second.first.time_stamp)
         {
-            queue.push_back(std::make_pair(reader.first, reader.first->getNextItem()));
+            return first.first.time_stamp > second.first.time_stamp;
         }
-        catch (const adtf_file::exceptions::EndOfFile&)
+        return first.second > second.second;
+    };
+
+    adtf_file::FileItem item;
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index)
+    {
+        if (sources[source_index]->getNextItem(item))
         {
+            heap.emplace_back(std::move(item), source_index);
+            std::push_heap(heap.begin(), heap.end(), heap_functor);
         }
     }
 
-    auto sort_functor = [](const decltype(queue)::value_type& first,
-                           const decltype(queue)::value_type& second) {
-        return first.second.time_stamp < second.second.time_stamp;
+    // only the progress of the source that has been read from changes, so the sum is kept up to date
+    auto sum_progress = [&sources]() {
+        double progress_sum = 0.0;
+        for (auto& current_source : sources)
+        {
+            progress_sum += current_source->getProgress();
+        }
+        return progress_sum;
     };
+    double progress_sum = sum_progress();
 
-    while (!queue.empty())
+    while (!heap.empty())
     {
-        std::sort(queue.begin(), queue.end(), sort_functor);
-
-        auto current_reader = queue.front().first;
-        auto item = queue.front().second;
-        queue.pop_front();
+        std::pop_heap(heap.begin(), heap.end(), heap_functor);
+        item = std::move(heap.back().first);
+        auto& source = *sources[heap.back().second];
 
-        auto destination_stream_id = _stream_mapping[current_reader].find(item.stream_id);
-        if (destination_stream_id != _stream_mapping[current_reader].end())
+        auto destination_stream_id = source.stream_mapping.find(item.stream_id);
+        if (destination_stream_id != source.stream_mapping.end())
         {
             auto write_sample =
                 std::dynamic_pointer_cast<const adtf_file::WriteSample>(item.stream_item);
@@ -227,34 +417,29 @@ void Multiplexer::process(std::function<bool(double)> progress_handler)
             }
         }
 
-        try
+        // the slot of the current source is reused for its next item
+        const double previous_progress = source.getProgress();
+        if (source.getNextItem(heap.back().first))
         {
-            queue.push_back(std::make_pair(current_reader, current_reader->getNextItem()));
+            std::push_heap(heap.begin(), heap.end(), heap_functor);
+            progress_sum += source.getProgress() - previous_progress;
         }
-        catch (const adtf_file::exceptions::EndOfFile&)
+        else
         {
+            heap.pop_back();
+            // once per source, this discards the rounding errors of the incremental updates
+            progress_sum = sum_progress();
         }
 
         if (progress_handler)
         {
-            if (!progress_handler(calculateProgress()))
+            if (!progress_handler(progress_sum / sources.size()))
             {
                 break;
             }
         }
     }
 }
-
-double Multiplexer::calculateProgress()
-{
-    auto reader_count = _stream_mapping.size();
-    double progress = 0.0;
-    for (auto& reader : _stream_mapping)
-    {
-        progress += reader.first->getProgress() / reader_count;
-    }
-    return progress;
-}
 }
 }
 }
@@ -2,6 +2,8 @@
 #include <adtfdat_processing/demultiplexer.h>
 #include "test_reader.h"
 #include "test_processor.h"
+#include <atomic>
+#include <thread>
 
 using namespace adtf::dat;
 
@@ -38,3 +40,144 @@ GTEST_TEST(Demultiplexer, make)
     checkProcessorItems(1);
     checkProcessorItems(2);
 }
+
+GTEST_TEST(Demultiplexer, processPipelined)
+{
+    for (size_t queue_size: {1, 4, 100})
+    {
+        // the workers only access their own entry
+        processor_items.clear();
+        processor_items[1];
+        processor_items[2];
+
+        {
+            ProcessorFactories factories;
+            factories.add(std::make_shared<ProcessorFactoryImplementation<TestProcessor<1>>>());
+            factories.add(std::make_shared<ProcessorFactoryImplementation<TestProcessor<2>>>());
+
+            auto test_reader = std::make_shared<TestReader<0>>();
+            test_reader->open("compatible");
+
+            Demultiplexer test_demultiplexer(test_reader, factories);
+            test_demultiplexer.setWorkerQueueSize(queue_size);
+            test_demultiplexer.addProcessor("stream1", "test_1", "", Configuration());
+            test_demultiplexer.addProcessor("stream2", "test_2", "", Configuration());
+
+            double last_progress = 0.0;
+            test_demultiplexer.process([&](double progress)
+            {
+                EXPECT_GE(progress, last_progress);
+                last_progress = progress;
+                return true;
+            });
+            ASSERT_EQ(last_progress, 1.0);
+        }
+
+        ASSERT_EQ(processor_items.size(), 2);
+
+        checkProcessorItems(1);
+        checkProcessorItems(2);
+    }
+}
+
+GTEST_TEST(Demultiplexer, processPipelinedCancel)
+{
+    processor_items.clear();
+    processor_items[1];
+    processor_items[2];
+
+    ProcessorFactories factories;
+    factories.add(std::make_shared<ProcessorFactoryImplementation<TestProcessor<1>>>());
+    factories.add(std::make_shared<ProcessorFactoryImplementation<TestProcessor<2>>>());
+
+    auto test_reader = std::make_shared<TestReader<0>>();
+    test_reader->open("compatible");
+
+    Demultiplexer test_demultiplexer(test_reader, factories);
+    test_demultiplexer.setWorkerQueueSize(4);
+    test_demultiplexer.addProcessor("stream1", "test_1", "", Configuration());
+    test_demultiplexer.addProcessor("stream2", "test_2", "", Configuration());
+
+    size_t item_count = 0;
+    test_demultiplexer.process([&](double)
+    {
+        return ++item_count < 6;
+    });
+
+    ASSERT_EQ(item_count, 6);
+    ASSERT_LE(processor_items[1].size() + processor_items[2].size(), 6);
+}
+
+static std::atomic<bool> failing_processor_failed(false);
+
+class FailingTestProcessor: public TestProcessor<2>
+{
+    public:
+        std::string getProcessorIdentifier() const override
+        {
+            return "failing_2";
+        }
+
+        void process(const adtf_file::FileItem&) override
+        {
+            failing_processor_failed = true;
+            throw std::runtime_error("unable to write");
+        }
+};
+
+GTEST_TEST(Demultiplexer, processPipelinedError)
+{
+    processor_items.clear();
+    processor_items[1];
+
+    ProcessorFactories factories;
+    factories.add(std::make_shared<ProcessorFactoryImplementation<TestProcessor<1>>>());
+    factories.add(std::make_shared<ProcessorFactoryImplementation<FailingTestProcessor>>());
+
+    auto test_reader = std::make_shared<TestReader<0>>();
+    test_reader->open("compatible");
+
+    Demultiplexer test_demultiplexer(test_reader, factories);
+    test_demultiplexer.setWorkerQueueSize(4);
+    test_demultiplexer.addProcessor("stream1", "test_1", "", Configuration());
+    test_demultiplexer.addProcessor("stream2", "failing_2", "", Configuration());
+
+    // the error of the worker is reported after all workers have been stopped
+    ASSERT_THROW(test_demultiplexer.process(nullptr), std::runtime_error);
+}
+
+GTEST_TEST(Demultiplexer, processPipelinedCancelError)
+{
+    processor_items.clear();
+    processor_items[1];
+    failing_processor_failed = false;
+
+    ProcessorFactories factories;
+    factories.add(std::make_shared<ProcessorFactoryImplementation<TestProcessor<1>>>());
+    factories.add(std::make_shared<ProcessorFactoryImplementation<FailingTestProcessor>>());
+
+    auto test_reader = std::make_shared<TestReader<0>>();
+    test_reader->open("compatible");
+
+    Demultiplexer test_demultiplexer(test_reader, factories);
+    test_demultiplexer.setWorkerQueueSize(4);
+    test_demultiplexer.addProcessor("stream1", "test_1", "", Configuration());
+    test_demultiplexer.addProcessor("stream2", "failing_2", "", Configuration());
+
+    // cancel once both streams got an item and the failing worker has processed its item
+    size_t item_count = 0;
+    ASSERT_THROW(test_demultiplexer.process([&](double)
+    {
+        if (++item_count < 2)
+        {
+            return true;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!failing_processor_failed && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+        return false;
+    }), std::runtime_error);
+}
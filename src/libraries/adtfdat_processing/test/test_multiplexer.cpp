@@ -83,3 +83,69 @@ GTEST_TEST(Multiplexer, process)
     checkStream(streams[1], "outstream12", 10, std::chrono::seconds(0), std::chrono::seconds(9), "adtf/anonymous");
     checkStream(streams[2], "outstream21", 10, std::chrono::seconds(10), std::chrono::seconds(19), "adtf/anonymous");
 }
+
+GTEST_TEST(Multiplexer, processMergeOrder)
+{
+    std::vector<std::vector<std::pair<uint16_t, std::chrono::nanoseconds>>> results;
+    for (size_t read_ahead: {0, 1, 256})
+    {
+        std::string file_name = TEST_BUILD_DIR "/test_multiplex_merge_order.adtfdat";
+
+        {
+            Multiplexer test_multiplexer(file_name);
+            test_multiplexer.setReadAhead(read_ahead);
+
+            auto reader1 = std::make_shared<TestReader<0>>();
+            reader1->open("compatible");
+            auto reader2 = std::make_shared<TestReader<3>>();
+            reader2->open("compatible");
+            auto reader3 = std::make_shared<TestReader<1>>();
+            reader3->open("compatible");
+
+            test_multiplexer.addStream(reader1, "stream1", "outstream1", std::make_shared<adtf_file::adtf3::SampleCopySerializer>());
+            test_multiplexer.addStream(reader2, "stream1", "outstream2", std::make_shared<adtf_file::adtf3::SampleCopySerializer>());
+            test_multiplexer.addStream(reader3, "stream2", "outstream3", std::make_shared<adtf_file::adtf3::SampleCopySerializer>());
+
+            double last_progress = 0.0;
+            test_multiplexer.process([&](double progress)
+            {
+                EXPECT_GE(progress, last_progress);
+                last_progress = progress;
+                return true;
+            });
+            ASSERT_EQ(last_progress, 1.0);
+        }
+
+        adtf_file::StandardReader adtf_reader(file_name);
+        std::vector<std::pair<uint16_t, std::chrono::nanoseconds>> samples;
+        for (;;)
+        {
+            try
+            {
+                auto item = adtf_reader.getNextItem();
+                if (std::dynamic_pointer_cast<const adtf_file::Sample>(item.stream_item))
+                {
+                    samples.emplace_back(item.stream_id, item.time_stamp);
+                }
+            }
+            catch (const adtf_file::exceptions::EndOfFile&)
+            {
+                break;
+            }
+        }
+
+        ASSERT_EQ(samples.size(), 30);
+        for (size_t sample_index = 1; sample_index < samples.size(); ++sample_index)
+        {
+            // items with the same timestamp are ordered like the readers have been added
+            ASSERT_TRUE(samples[sample_index - 1].second < samples[sample_index].second ||
+                        (samples[sample_index - 1].second == samples[sample_index].second &&
+                         samples[sample_index - 1].first < samples[sample_index].first));
+        }
+
+        results.push_back(samples);
+    }
+
+    ASSERT_EQ(results[0], results[1]);
+    ASSERT_EQ(results[0], results[2]);
+}
@@ -28,7 +28,10 @@
 #include <map>
 #include <atomic>
 #include <deque>
+#include <future>
 #include <list>
+#include <memory>
+#include <vector>
 #include <utils5extension/utils5extension.h>
 
 #ifndef DOEXPORT
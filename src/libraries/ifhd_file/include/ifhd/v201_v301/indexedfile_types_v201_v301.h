@@ -32,6 +32,13 @@ static inline uint32_t getFileId()
     return file_id;
 }
 
+/// identifier of a @ref FileProgress
+static inline uint32_t getFileProgressId()
+{
+    static uint32_t file_progress_id = *((uint32_t*) "IFHP");
+    return file_progress_id;
+}
+
 static constexpr uint32_t version_id_beta = 0x0200;
 /// supported Version of Indexed File within ADTF 2.0 until 2.12 and >= 2.13 
 /// if NO History is used while writing file (currently 0x00000201)
@@ -276,6 +283,40 @@ struct AdditionalIndexInfo
     uint8_t  reserved[20];
 };
 
+/**
+ * \struct CompressedChunkHeader
+ * Prefix of the data of chunks flagged with @ref ct_compressed,
+ * followed by the compressed data.
+ */
+struct CompressedChunkHeader
+{
+    /// the codec, see @ref CompressionCodec
+    uint8_t                          codec;
+    /// for later use
+    uint8_t                          reserved[3];
+    /// size of the uncompressed chunk data (in bytes)
+    uint32_t                         uncompressed_size;
+};  // size is 8 Bytes
+
+/**
+ * \struct FileProgress
+ * The extent of the data on disk of a file that is still being written,
+ * published in a file next to it, see @ref om_publish_progress.
+ */
+struct FileProgress
+{
+    /// identifier of the progress file, see getFileProgressId
+    uint32_t                         progress_id;
+    /// checksum of the whole struct with this field set to zero
+    uint32_t                         checksum;
+    /// incremented with every update
+    uint64_t                         sequence;
+    /// offset of the first chunk (in bytes)
+    uint64_t                         data_offset;
+    /// end of the data written so far (in bytes), the last chunk might be incomplete
+    uint64_t                         data_end;
+};  // size is 32 Bytes
+
 #pragma pack(pop)
 
 
@@ -310,7 +351,23 @@ enum ChunkType
     /// marks the chunk as type data
     ct_type = 0x08,
     /// marks the chunk as trigger data
-    ct_trigger = 0x10
+    ct_trigger = 0x10,
+    /// the chunk data is compressed, see @ref CompressedChunkHeader.
+    /// This flag is handled by the reader and writer and is never reported for read chunks.
+    ct_compressed = 0x20
+};
+
+/**
+ * Compression codecs for chunk data.
+ */
+enum CompressionCodec
+{
+    /// no compression
+    cc_none = 0,
+    /// LZ4 (fast)
+    cc_lz4  = 1,
+    /// Zstandard (better ratio)
+    cc_zstd = 2
 };
 
 /**
@@ -350,7 +407,85 @@ enum OpenMode
     /** 
         * Only valid for modify file operations.
         */
-    om_file_change_mode         = 0x10
+    om_file_change_mode         = 0x10,
+    /** 
+        * Only valid for reading file operations.
+        * Maps the whole file into memory. Chunk data returned by 
+        * readChunk/readNextChunk (without rf_use_external_buffer) points 
+        * directly into the mapped view and must not be modified.
+        */
+    om_memory_mapped            = 0x20,
+    /** 
+        * Only valid for reading file operations.
+        * Scans all chunk headers when opening the file and builds an index 
+        * of every chunk, so that seeking does not need to read any chunks 
+        * between the sparse index entries. The index is kept in a file next
+        * to the dat file, so only the first reader has to scan the file.
+        */
+    om_dense_index              = 0x40,
+    /** 
+        * Only valid for writing file operations.
+        * Enables IndexedFileWriter::createProducer. Every producer thread 
+        * queues its chunks without locking, a merge thread writes them to 
+        * the file in timestamp order.
+        */
+    om_concurrent_write         = 0x80,
+    /** 
+        * Only valid for writing file operations with the internal cache.
+        * If the cache is full, a new chunk is dropped instead of waiting 
+        * for the cache writing thread. Dropped chunks are counted, see 
+        * IndexedFileWriter::getCacheStatistics.
+        */
+    om_drop_chunks_if_cache_full = 0x100,
+    /** 
+        * Only valid for writing file operations with the internal cache.
+        * If the cache is full, writing a chunk throws instead of waiting 
+        * for the cache writing thread.
+        */
+    om_fail_if_cache_full       = 0x200,
+    /** 
+        * Only valid for reading file operations.
+        * A background thread reads ahead of the current position, see 
+        * IndexedFileReader::setReadAheadWindow. Ignored together with 
+        * om_memory_mapped.
+        */
+    om_read_ahead               = 0x400,
+    /** 
+        * Only valid for writing file operations without history.
+        * Periodically appends checkpoints of the index and the stream 
+        * information to a journal next to the file, so that a file that 
+        * has not been closed can be completed with 
+        * IndexedFileWriter::recover, see 
+        * IndexedFileWriter::setIndexJournalInterval.
+        */
+    om_index_journal            = 0x800,
+    /** 
+        * Only valid for writing file operations with a history size.
+        * Reserves the disk space of the history when the file is created. 
+        * The history wraps around at exactly its size and the file is not 
+        * truncated until the history is quit, which avoids file system 
+        * metadata updates during long recordings.
+        */
+    om_preallocate_history      = 0x1000,
+    /** 
+        * Only valid for writing file operations with the internal cache 
+        * and without history. Not supported together with 
+        * om_disable_file_system_cache, which only writes whole sectors.
+        * The cache writing thread publishes the extent of the data on 
+        * disk in a file next to the file at least every progress 
+        * interval, so that readers can follow the recording with 
+        * om_follow, see IndexedFileWriter::setProgressInterval.
+        */
+    om_publish_progress         = 0x2000,
+    /** 
+        * Only valid for reading file operations.
+        * Opens a file that is still being written with 
+        * om_publish_progress. Only the chunks on disk are visible, 
+        * IndexedFileReader::waitForChunks waits for further chunks. 
+        * Files that are complete are opened as usual. Not supported 
+        * together with om_memory_mapped, om_read_ahead or om_dense_index.
+        */
+    om_follow                   = 0x4000
 };
 
 }  // namespace v201_301
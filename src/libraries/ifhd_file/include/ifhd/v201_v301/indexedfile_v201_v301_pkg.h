@@ -29,5 +29,6 @@
 
    #include "indexedfilereader_v201_v301.h"
    #include "indexedfilewriter_v201_v301.h"
+   #include "livetapreader_v201_v301.h"
 
 #endif // _IFHD_FILE_V201_V301_HEADER_
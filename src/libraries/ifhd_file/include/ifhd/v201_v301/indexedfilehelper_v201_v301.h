@@ -176,6 +176,75 @@ void stream2StreamInfoHeader(const FileHeader& file_header, StreamInfoHeader& st
     */
 void stream2AdditionalStreamIndexInfo(const FileHeader& file_header, AdditionalIndexInfo& additonal_index_info);
 
+/**
+    * Checks whether a compression codec has been enabled when building the library.
+    * @param [in] codec The codec.
+    * @return Whether chunk data can be compressed and decompressed with the codec.
+    * @rtsafe
+    */
+bool isCompressionCodecAvailable(CompressionCodec codec);
+
+/**
+    * Compresses chunk data. The result starts with a @ref CompressedChunkHeader.
+    * @param [in] codec The codec.
+    * @param [in] level The codec specific compression level (the acceleration for LZ4), 0 selects the default.
+    * @param [in] data The chunk data.
+    * @param [in] dataSize The size of the chunk data.
+    * @param [out] compressed The compressed chunk data, its capacity is reused.
+    * @return false if compression does not reduce the size, compressed is undefined then.
+    * @throw std::invalid_argument if the codec is not available.
+    */
+bool compressChunkData(CompressionCodec codec,
+                       int level,
+                       const void* data,
+                       uint32_t data_size,
+                       std::vector<uint8_t>& compressed);
+
+/**
+    * Returns the size of chunk data compressed with @ref compressChunkData once it is decompressed.
+    * @param [in] fileHeader The header
+    * @param [in] data The compressed chunk data.
+    * @param [in] dataSize The size of the compressed chunk data.
+    * @return The uncompressed size.
+    * @throw std::runtime_error if the data is too small.
+    */
+uint32_t getUncompressedChunkDataSize(const FileHeader& file_header,
+                                      const void* data,
+                                      uint32_t data_size);
+
+/**
+    * Decompresses chunk data compressed with @ref compressChunkData.
+    * @param [in] fileHeader The header
+    * @param [in] data The compressed chunk data.
+    * @param [in] dataSize The size of the compressed chunk data.
+    * @param [out] destination The buffer for the uncompressed data.
+    * @param [in] destinationSize The size of the buffer.
+    * @return The uncompressed size.
+    * @throw std::runtime_error if the codec is not available, the data is corrupt or the
+    *                           buffer is too small.
+    */
+uint32_t decompressChunkData(const FileHeader& file_header,
+                             const void* data,
+                             uint32_t data_size,
+                             void* destination,
+                             size_t destination_size);
+
+/**
+    * Calculates the checksum of a @ref FileProgress.
+    * @param [in] progress The progress, its checksum field is ignored.
+    * @return The checksum.
+    * @rtsafe
+    */
+uint32_t getFileProgressChecksum(const FileProgress& progress);
+
+/**
+    * Reads the progress of a file that is being written with @ref om_publish_progress.
+    * @param [in] filename The name of the file that is being written.
+    * @param [out] progress The progress.
+    * @return false if there is no progress file or it is being updated at the moment.
+    */
+bool readFileProgress(const std::string& filename, FileProgress& progress);
+
 
 } // namespace
 } // ifhd
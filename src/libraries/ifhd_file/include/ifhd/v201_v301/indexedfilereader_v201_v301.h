@@ -147,6 +147,8 @@ class DOEXPORT IndexedFileReader : public IndexedFile
         /**
          *
          * This function returns the ChunkInfo of the current chunk.
+         * For compressed chunks the size refers to the stored data and the
+         * flags contain ct_compressed until the chunk has been read.
          *
          * @param  chunkHeader [out] the current chunk info
          *
@@ -158,7 +160,9 @@ class DOEXPORT IndexedFileReader : public IndexedFile
         /**
          *
          * This function reads and returns the current Chunk and increments
-         * the current chunk index
+         * the current chunk index. Compressed chunks are decompressed, the
+         * chunk info is updated accordingly. An external buffer has to be able
+         * to hold the max chunk size of the file.
          *
          * @param data    [out] the current chunk data
          * @param flags [in]  a tReadFlags the value
@@ -194,6 +198,71 @@ class DOEXPORT IndexedFileReader : public IndexedFile
          */
         void readNextChunk(ChunkHeader** chunk_header, void** data, uint32_t flags=0, uint32_t stream_id=0);
 
+        /**
+         *
+         * This function restricts readNextChunk to the given streams. Of all chunks of other
+         * streams only the chunk header is read, their data is skipped.
+         *
+         * @param streamIds [in] the ids of the streams to read, an empty set disables the filter
+         *
+         * @returns void
+         *
+         */
+        void setStreamFilter(const std::set<uint16_t>& stream_ids);
+
+        /**
+         *
+         * This function returns the current stream filter.
+         *
+         * @returns the ids of the selected streams, empty if all streams are read
+         * @rtsafe
+         *
+         */
+        const std::set<uint16_t>& getStreamFilter() const;
+
+        /**
+         *
+         * This function checks whether chunks of a stream pass the current stream filter.
+         *
+         * @param streamId [in] the stream Id
+         *
+         * @returns true if no filter is set or the stream is part of it
+         * @rtsafe
+         *
+         */
+        bool isStreamSelected(uint16_t stream_id) const;
+
+        /**
+         *
+         * This function scans the headers of all chunks and builds an index with an entry for
+         * every chunk. Afterwards seek() finds its target via binary search and reads exactly
+         * one chunk. The file position is reset to the beginning of data.
+         * This is done automatically on open() if om_dense_index is set.
+         * The index is stored next to the file (see getDenseIndexFileName) and loaded instead
+         * of scanning the file again, as long as the file has not been changed.
+         *
+         * @returns void
+         *
+         */
+        void buildDenseIndex();
+
+        /**
+         * @param filename [in] The name of a file.
+         * @return The name of the file that stores the dense index of the file, see
+         *         @ref buildDenseIndex.
+         */
+        static std::string getDenseIndexFileName(const std::string& filename);
+
+        /**
+         *
+         * This function checks whether a dense index is available.
+         *
+         * @returns true if seek() uses the dense index
+         * @rtsafe
+         *
+         */
+        bool hasDenseIndex() const;
+
         /**
          *
          * This function increments the current chunk index.
@@ -404,6 +473,59 @@ class DOEXPORT IndexedFileReader : public IndexedFile
                                         ChunkHeader& header,
                                         std::vector<uint8_t>& data);
 
+        /**
+         * Checks whether the file has been opened with @ref om_memory_mapped.
+         * @return Whether chunk data is read directly from a mapped view of the file.
+         * @rtsafe
+         */
+        bool isMemoryMapped() const;
+
+        /**
+         * Sets the amount of data the background thread reads ahead if the file is opened with
+         * @ref om_read_ahead. Takes effect on the next open().
+         * @param window_size [in] The size of the read-ahead window in bytes (default 64 MB).
+         */
+        void setReadAheadWindow(size_t window_size);
+
+        /**
+         * Checks whether data is read ahead by a background thread.
+         * @return Whether the file has been opened with @ref om_read_ahead.
+         * @rtsafe
+         */
+        bool isReadingAhead() const;
+
+        /**
+         * Pins the mapped view of the file.
+         * Chunk data pointers returned by readChunk/readNextChunk in memory mapped mode stay valid
+         * as long as the returned handle is held, even beyond subsequent reads, seeks or close().
+         * @return The handle to the mapped view, empty if the file is not memory mapped.
+         */
+        std::shared_ptr<const utils5ext::MemoryMappedFile> pinMappedView() const;
+
+        /**
+         * Waits until chunks have been added to a file opened with @ref om_follow and makes
+         * them visible. If the end of the file has been reached before, reading continues with
+         * the first new chunk. Chunk data returned before is invalid afterwards.
+         * @param timeout [in] The maximum time to wait in microseconds, 0 to check only once.
+         * @return Whether there are new chunks, false on timeout or if the file is complete.
+         */
+        bool waitForChunks(timestamp_t timeout);
+
+        /**
+         * Checks whether the writer has closed the file, see @ref om_follow. Seeking, the
+         * stream information and the extensions of a followed file are only available once it
+         * is opened again after it has been completed.
+         * @return false while a file opened with @ref om_follow is still being written.
+         * @rtsafe
+         */
+        bool isComplete() const;
+
+        /**
+         * Sets the interval in which waitForChunks checks for new chunks.
+         * @param interval [in] The interval in microseconds (default 10 ms).
+         */
+        void setFollowInterval(timestamp_t interval);
+
     protected:
         /**
          * Initializes the reader.
@@ -56,6 +56,52 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
                                                  timestamp_t time) = 0;
         };
 
+        /**
+         * Lock-free front-end for a single producer thread, see @ref createProducer.
+         */
+        class ChunkProducer
+        {
+            public:
+                /**
+                 * Queues a new chunk. This does not block as long as there is enough space left
+                 * in the queue of the producer. Chunks that exceed the queue size are written
+                 * directly once all previously queued chunks have been written.
+                 * Must only be called by one thread at a time.
+                 *
+                 * @param streamId [in] The stream id.
+                 * @param data        [in] The chunk data.
+                 * @param dataSize    [in] The data size.
+                 * @param timeStamp   [in] The timestamp of the chunk.
+                 * @param flags       [in] Chunk flags, see @ref tChunkType
+                 */
+                void writeChunk(uint16_t stream_id,
+                                const void* data,
+                                uint32_t data_size,
+                                timestamp_t time_stamp,
+                                uint32_t flags);
+
+            private:
+                friend class IndexedFileWriter;
+                ChunkProducer(IndexedFileWriter& writer, size_t queue_size);
+                ChunkProducer(const ChunkProducer&) = delete;
+                ChunkProducer& operator=(const ChunkProducer&) = delete;
+
+            private:
+                IndexedFileWriter&            _writer;
+                utils5ext::LockFreeRingBuffer _queue;
+        };
+
+        /**
+         * Statistics of the internal cache, see @ref getCacheStatistics.
+         */
+        struct CacheStatistics
+        {
+            uint64_t stall_count;       //!< How often writing a chunk had to wait for free cache space
+            timestamp_t stall_time;     //!< The accumulated waiting time in microseconds
+            int high_water_mark;        //!< The maximum cache usage in bytes
+            uint64_t dropped_chunks;    //!< Chunks dropped due to @ref om_drop_chunks_if_cache_full
+        };
+
     protected:
         /*! \cond PRIVATE */
         /// For internal use only (will be moved to a private implementation).
@@ -64,15 +110,15 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
         timestamp_t             _time_offset;
 
         int                     _cache_min_store_at_once;
-        volatile int            _cache_flush_ptr;
-        volatile int            _cache_insert_ptr;
-        std::atomic<int>        _cache_usage_count;
+        int                     _cache_flush_ptr;       // only modified by the cache writing thread
+        int                     _cache_insert_ptr;      // only modified by the chunk writing thread
+        std::atomic<int>        _cache_usage_count;     // hands over data between both threads
 
-        std::mutex              _mutex_freed_event;
-        std::mutex              _mutex_cache_used;
+        std::mutex              _mutex_cache_event;
         std::condition_variable _cond_freed_event;
         std::condition_variable _cond_cache_used;
-        std::atomic<bool>       _cond_cache_used_processed;
+        std::atomic<bool>       _cache_writer_waiting;
+        std::atomic<bool>       _cache_flusher_waiting;
 
         int64_t                 _ref_index;
         timestamp_t             _last_chunk_time;
@@ -176,7 +222,8 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
          * Create a new indexed file.
          *
          * @param filename [in] The filename.
-         * @param cacheSize  [in] The cache size.
+         * @param cacheSize  [in] The cache size. In history mode a size of 0 writes the chunks
+         *                   synchronously, otherwise the cache writing thread writes the history.
          * @param flags   [in] Creation flags, see @ref OpenMode
          * @param fileTimeOffset [in] unused.
          * @param history [in] Timestamp of history.
@@ -199,6 +246,8 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
          * Finishes writing to and closes the file.
          *
          * @return Standard result.
+         * @throw The error that stopped writing the chunks of the producers, see @ref createProducer.
+         *        The file is closed nevertheless, but it lacks the chunks that were still queued.
          */
         void close();
 
@@ -211,6 +260,7 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
          * @param dataSize    [in] The data size.
          * @param timeStamp   [in] The timestamp of the chunk.
          * @param flags       [in] Chunk flags, see @ref tChunkType
+         * @throw std::invalid_argument if the stream id is 0 or larger than MAX_INDEXED_STREAMS.
          */
         void writeChunk(uint16_t stream_id,
                            const void* data,
@@ -220,6 +270,10 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
         /**
          * Writes a new chunk to the file.
          * This function is not thread safe! (sync must be done outside in caller)!
+         * If the internal cache is full the behaviour depends on the creation flags:
+         * By default the call blocks until the cache writing thread freed enough space,
+         * with @ref om_drop_chunks_if_cache_full the chunk is dropped and with
+         * @ref om_fail_if_cache_full an exception is thrown.
          *
          * @param streamId [in] The stream id.
          * @param data        [in] The chunk data.
@@ -227,6 +281,8 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
          * @param timeStamp   [in] The timestamp of the chunk.
          * @param flags       [in] Chunk flags, see @ref tChunkType
          * @param indexEntryAppended [out] return value Index Entry Added
+         * @throw std::invalid_argument if the stream id is 0 or larger than MAX_INDEXED_STREAMS.
+         * @throw std::runtime_error if the cache is full and @ref om_fail_if_cache_full is set.
          */
         void writeChunk(uint16_t stream_id,
                            const void* data,
@@ -235,6 +291,57 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
                            uint32_t flags,
                            bool& index_entry_appended);
 
+        /**
+         * Memory for the payload of a chunk that is written in place, see @ref reserveChunk.
+         */
+        struct ChunkReservation
+        {
+            /// The payload memory, the second piece is only used if the payload wraps around the end of the cache
+            void*    data[2];
+            /// The sizes of both pieces
+            uint32_t data_size[2];
+        };
+
+        /**
+         * Reserves memory for the payload of the next chunk. The caller writes the payload in place
+         * and writes the chunk with @ref commitChunk. If possible, the memory is located within the
+         * internal cache so that the payload is not copied again, otherwise an internal buffer is used.
+         * No other chunk must be written before the reservation has been committed. A reservation
+         * that is not committed is discarded by the next one.
+         * The payload of streams with a compression codec (see @ref setStreamCompression) is copied
+         * out of the cache and compressed by @ref commitChunk, so these do not benefit from writing in place.
+         * This function is not thread safe! (sync must be done outside in caller)!
+         *
+         * @param dataSize    [in] The payload size.
+         * @param reservation [out] The memory for the payload.
+         */
+        void reserveChunk(uint32_t data_size, ChunkReservation& reservation);
+
+        /**
+         * Writes the chunk reserved with @ref reserveChunk, after its payload has been written.
+         * Behaves like @ref writeChunk otherwise.
+         *
+         * @param streamId [in] The stream id.
+         * @param timeStamp   [in] The timestamp of the chunk.
+         * @param flags       [in] Chunk flags, see @ref tChunkType
+         * @throw std::logic_error if no chunk has been reserved.
+         */
+        void commitChunk(uint16_t stream_id,
+                         timestamp_t time_stamp,
+                         uint32_t flags);
+
+        /**
+         * Creates a front-end for a producer thread. Chunks of all producers are written by a
+         * separate thread, so producers do not need to synchronize with each other. Of all queued
+         * chunks the one with the oldest timestamp is written first. Only available if the file has been created with
+         * @ref om_concurrent_write. In this mode writeChunk is thread safe as well.
+         *
+         * @param queueSize [in] The size of the queue of the producer in bytes.
+         * @return The producer, it is valid until the file is closed.
+         * @throw std::logic_error if the file is not open in concurrent mode.
+         */
+        ChunkProducer& createProducer(size_t queue_size = 1024 * 1024);
+
         /**
          * Sets additional info for a stream.
          *
@@ -258,6 +365,25 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
         void setStreamName(uint16_t stream_id,
                               const char* stream_name);
 
+        /**
+         * Enables the compression of the chunk data of a stream. Chunks are flagged with
+         * @ref ct_compressed and decompressed transparently by the reader, chunks whose data
+         * does not get smaller are stored uncompressed. Files containing compressed chunks get
+         * the version v400::version_id_with_compression or v500::version_id_with_compression,
+         * which readers without compression support reject. The chunk data is compressed by the
+         * thread that writes the chunk, producers (see @ref createProducer) compress in parallel.
+         * Must not be called while chunks of the stream are written.
+         *
+         * @param streamId [in] The stream id.
+         * @param codec    [in] The codec, see @ref isCompressionCodecAvailable. cc_none disables compression.
+         * @param level    [in] The codec specific compression level, 0 selects the default.
+         * @throw std::invalid_argument if the codec is not available or the version of the file
+         *                              (see getHeaderRef) is lower than v400::version_id.
+         */
+        void setStreamCompression(uint16_t stream_id,
+                                  CompressionCodec codec,
+                                  int level = 0);
+
         /**
          * Get the amount of cache space used.
          *
@@ -266,6 +392,14 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
          */
         int getCacheUsage();
 
+        /**
+         * Get the statistics of the internal cache since the file has been created.
+         *
+         * @return The cache statistics.
+         * @rtsafe
+         */
+        CacheStatistics getCacheStatistics() const;
+
         /**
          * In case there is a history set up, this switches over to permanent storage.
          * @return Standard result.
@@ -285,6 +419,95 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
          */
         void stopAndFlushCache();
 
+        /**
+         * Limits the memory used by the master index of very long recordings. Beyond the limit,
+         * blocks of the oldest index entries are moved to a temporary file next to the file,
+         * which is copied into the index extension by close(). Takes effect on the next create(),
+         * not supported in history mode.
+         *
+         * @param maxEntries [in] The maximum amount of index entries in memory, 0 for no limit (default).
+         */
+        void setIndexMemoryLimit(size_t max_entries);
+
+        /**
+         * Sets the time between two checkpoints of the index journal, see @ref om_index_journal.
+         * A checkpoint is always written after the first chunk.
+         *
+         * @param interval [in] The interval in microseconds (default 1 s).
+         */
+        void setIndexJournalInterval(timestamp_t interval);
+
+        /**
+         * Completes a file that has been written with @ref om_index_journal but has not been
+         * closed, i.e. after a crash. The index and the stream information are restored from the
+         * last checkpoint of the journal that is covered by the data on disk, only the chunks
+         * written after that checkpoint are scanned. Incomplete chunks at the end are discarded.
+         * The journal is removed afterwards. The file is modified in place, a copy of the file as
+         * it was found is kept, see getBackupFileName().
+         *
+         * @param filename [in] The name of the file.
+         * @throw std::runtime_error if there is no journal or it does not contain a valid checkpoint.
+         */
+        void recover(const std::string& filename);
+
+        /**
+         * @param filename [in] The name of a file.
+         * @return The name of the index journal of the file, see @ref om_index_journal.
+         */
+        static std::string getIndexJournalFileName(const std::string& filename);
+
+        /**
+         * Sets the maximum time between two updates of the published progress, see
+         * @ref om_publish_progress. This bounds the time until readers that follow the file see
+         * a chunk. Data in the cache is written to disk when an update is due.
+         *
+         * @param interval [in] The interval in microseconds (default 100 ms).
+         */
+        void setProgressInterval(timestamp_t interval);
+
+        /**
+         * @param filename [in] The name of a file.
+         * @return The name of the file that receives the progress of the file, see
+         *         @ref om_publish_progress.
+         */
+        static std::string getProgressFileName(const std::string& filename);
+
+        /**
+         * Publishes every chunk written from the next @ref create on into a ring buffer in shared
+         * memory, so that local consumers can attach via a LiveTapReader without reading the file.
+         * Writing never waits for the consumers, slow consumers lose the oldest chunks instead.
+         * Chunks larger than half of the buffer are not published. @ref create fails without
+         * creating the file if another running writer uses the same name.
+         *
+         * @param name [in] The name of the shared memory, an empty name disables the tap.
+         * @param size [in] The size of the ring buffer in bytes.
+         */
+        void setLiveTap(const std::string& name, size_t size);
+
+        /**
+         * Rebuilds the index of a file whose index is missing or damaged, i.e. a file that has not
+         * been closed or that has been truncated. The data area is searched for chunk headers by
+         * several threads, afterwards the chunks are followed from the beginning of the data area.
+         * A damaged chunk is skipped, the chunks behind it are moved forward to close the gap.
+         * Everything behind the last valid chunk is discarded and replaced by the new index.
+         * Stream names, additional stream information and extensions are not restored, use
+         * recover() for files written with @ref om_index_journal. The file is modified in place,
+         * a copy of the file as it was found is kept, see getBackupFileName().
+         *
+         * @param filename [in] The name of the file.
+         * @param threadCount [in] The amount of threads searching for chunks, 0 for one per core.
+         * @param indexDelay [in] The maximum time difference between index entries.
+         * @throw std::runtime_error if the file has no valid header or has been written with a history.
+         */
+        void repair(const std::string& filename, size_t thread_count = 0, timestamp_t index_delay = 1000000);
+
+        /**
+         * @param filename [in] The name of a file.
+         * @return The name of the copy that recover() and repair() make of the file before they
+         *         modify it. The copy of an earlier run is replaced.
+         */
+        static std::string getBackupFileName(const std::string& filename);
+
     protected:
         /**
          * Initializes the writer.
@@ -328,6 +551,24 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
          */
         void writeToCache(const void* data, int data_size, const bool is_chunk_header = false);
 
+        /**
+         * copies data to the given position of the local cache, wraps around at its end
+         *
+         * @param [in] cachePos position within the cache
+         * @param [in] data data to be copied
+         * @param [in] dataSize size of data, at most the cache size
+         *
+         * @return the position behind the data
+         */
+        int copyToCache(int cache_pos, const void* data, int data_size);
+
+        /**
+         * accounts data that has been added to the local cache and wakes up the cache writing thread
+         *
+         * @param [in] dataSize size of the added data
+         */
+        void addCacheUsage(int data_size);
+
         /**
          * stores the data to disk
          * @param [in] flush flushes the data
@@ -365,6 +606,123 @@ class DOEXPORT IndexedFileWriter : public IndexedFile
                            size_t buffer_size,
                            bool use_segment_size);
 
+    private:
+        /**
+         * Writes a new chunk to the file, the caller has to synchronize.
+         */
+        void appendChunk(uint16_t stream_id,
+                         const void* data,
+                         uint32_t data_size,
+                         timestamp_t time_stamp,
+                         uint32_t flags,
+                         bool& index_entry_appended);
+
+        /**
+         * Writes the index extensions at the current file position in large blocks.
+         */
+        class IndexExtensionWriter;
+
+        /**
+         * Creates a checkpoint of the index journal, containing the index entries added since
+         * the last checkpoint and the current stream information. In synchronous mode it is
+         * written right away, otherwise by the cache writing thread.
+         */
+        void writeJournalCheckpoint();
+
+        /**
+         * Appends the checkpoints whose data has been written to the index journal and writes
+         * the journal to disk, called by the cache writing thread.
+         */
+        void writePendingJournalCheckpoints();
+
+        /**
+         * Publishes the extent of the data written by the cache writing thread,
+         * see @ref om_publish_progress.
+         */
+        void publishProgress();
+
+        /**
+         * Publishes the chunk whose header has just been filled in to the live tap,
+         * see @ref setLiveTap.
+         *
+         * @param data [in] The chunk data, nullptr while a reserved chunk is committed.
+         * @param data_size [in] The size of the chunk data.
+         */
+        void publishToLiveTap(const void* data, uint32_t data_size);
+
+        /**
+         * Adds a chunk that has been found behind the last journal checkpoint to the index.
+         *
+         * @param header [in] The header of the chunk at the current file position.
+         * @param uncompressedSize [in] The size of the chunk including the uncompressed data.
+         */
+        void appendRecoveredChunk(const ChunkHeader& header, uint64_t uncompressed_size);
+
+        /**
+         * Opens a file whose index is restored by recover() or repair().
+         */
+        void beginRecovery(const std::string& filename, timestamp_t index_delay);
+
+        /**
+         * @return Whether the chunk at the current file position continues the restored chunks.
+         */
+        bool isNextRecoveredChunk(const ChunkHeader& header) const;
+
+        /**
+         * Discards everything behind the restored chunks and writes the index.
+         */
+        void finishRecovery(const std::string& filename);
+
+        /**
+         * Checks the arguments of a chunk before it is queued or written.
+         */
+        void checkChunk(uint16_t stream_id, timestamp_t time_stamp) const;
+
+        /**
+         * Compresses the chunk data if compression is enabled for the stream.
+         * The compressed data is valid until the next chunk is compressed by the calling thread.
+         *
+         * @param data     [inout] The chunk data, refers to the compressed data afterwards.
+         * @param dataSize [inout] The size of the chunk data.
+         * @param flags    [inout] The chunk flags, @ref ct_compressed is added.
+         */
+        void compressChunk(uint16_t stream_id,
+                           const void*& data,
+                           uint32_t& data_size,
+                           uint32_t& flags) const;
+
+        /**
+         * Thread function that merges the queues of all producers into the file.
+         */
+        void mergeProducerQueues();
+
+        /**
+         * Writes all currently queued chunks of the producers.
+         * @return Whether any chunk has been written.
+         */
+        bool writeQueuedChunks();
+
+        /**
+         * Waits until all queued chunks are written and stops the merge thread.
+         */
+        void stopMerging();
+
+        /**
+         * Applies the cache full policy before a chunk is written to the internal cache.
+         *
+         * @param size [in] The size of the whole chunk in the cache.
+         * @return false if the chunk has to be dropped.
+         * @throw std::runtime_error if the cache is full and @ref om_fail_if_cache_full is set.
+         */
+        bool checkCacheSpace(int size);
+
+        /**
+         * Blocks until the cache writing thread freed the given amount of cache space.
+         *
+         * @param size [in] The required free space.
+         */
+        void waitForFreeCacheSpace(int size);
+
     friend class IndexedFileAsyncWriter;
 };
 
@@ -68,6 +68,13 @@ class DOEXPORT IndexReadTable
 
         typedef std::vector<StreamIndexTable> StreamIndexTableVector;
 
+        struct DenseIndexEntry
+        {
+            timestamp_t time_stamp;
+            uint64_t    chunk_offset;
+            uint64_t    stream_index;
+        };
+
         // master table
         MasterIndexTable           _master_index_table;
 
@@ -78,6 +85,11 @@ class DOEXPORT IndexReadTable
         IndexedFile*      _indexed_file;
         FileHeader*       _file_header;
 
+        // dense index, one entry per chunk (by chunk index)
+        std::vector<DenseIndexEntry> _dense_index;
+        // chunk indices of each stream into the dense index
+        std::vector<uint64_t>        _dense_stream_index[MAX_INDEXED_STREAMS + 1];
+
     public:
 
         /**
@@ -221,6 +233,65 @@ class DOEXPORT IndexReadTable
          */
         bool validateRawMasterIndex(int32_t ref_master_table_index);
 
+        /**
+         * Removes all entries of the dense index.
+         */
+        void clearDenseIndex();
+
+        /**
+         * Appends the next chunk to the dense index. Chunks have to be appended in the order
+         * of their chunk index, starting with the first chunk of the file.
+         * @param [in] header The (adjusted) header of the chunk.
+         * @param [in] chunkOffset The file offset of the chunk.
+         */
+        void appendDenseIndexEntry(const ChunkHeader& header, uint64_t chunk_offset);
+
+        /**
+         * Checks whether a dense index is available.
+         * @return Whether a dense index has been built for all chunks of the file.
+         * @rtsafe
+         */
+        bool hasDenseIndex() const;
+
+        /**
+         * Stores the dense index in a file of its own, so that it does not have to be built
+         * again when the indexed file is opened the next time, see loadDenseIndex. The index is
+         * written to a temporary file that is renamed to the given name when it is complete.
+         * @param [in] fileName The name of the file that receives the dense index.
+         * @param [in] fileSize The size of the indexed file.
+         * @throw std::exception if the file could not be written.
+         */
+        void storeDenseIndex(const std::string& file_name, uint64_t file_size) const;
+
+        /**
+         * Loads a dense index stored by storeDenseIndex. It is only used if it has been stored
+         * for a file of the same size and header and if it contains an entry for every chunk.
+         * @param [in] fileName The name of the file that contains the dense index.
+         * @param [in] fileSize The size of the indexed file.
+         * @return Whether the dense index has been loaded.
+         */
+        bool loadDenseIndex(const std::string& file_name, uint64_t file_size);
+
+        /**
+         *
+         * This function finds the exact chunk for a position via binary search in the dense index.
+         * Chunks of a stream are expected to have ascending timestamps.
+         *
+         * @param[in]   streamId    the stream Id
+         * @param[in]   pos         the position
+         * @param[in]   timeFormat  the format of pos (see IndexedFile::TF_*)
+         * @param[in]   before      for tf_chunk_time: find the last chunk at or before pos instead
+         *                          of the first chunk at or after it
+         * @param[out]  chunkOffset the file offset of the chunk
+         *
+         * @returns the chunk index
+         * @throw exceptions::EndOfFile if there is no such chunk
+         *
+         */
+        int64_t lookupDenseChunkRef(uint16_t stream_id, int64_t pos,
+                                    TimeFormat time_format, bool before,
+                                    int64_t* chunk_offset) const;
+
     private:
 
 
@@ -57,14 +57,47 @@ class DOEXPORT IndexWriteTable
         /// The maximum delay betweeen indices (microseconds)
         timestamp_t _index_delay;
 
+        /// Receives the oldest entries of the master index, they precede the ones in _master_index
+        utils5ext::File _spill_file;
+        std::string _spill_file_name;
+        /// The amount of master index entries that are moved to the spill file at once
+        size_t _spill_block_size;
+        /// The amount of master index entries that have been moved out of memory
+        uint64_t _spilled_entry_count;
+        /// The block that has been spilled last, it is written to the spill file in the background
+        std::vector<ChunkRef> _spill_buffer;
+        std::future<void> _spill_writing;
+
+        /**
+         * Moves the oldest block of master index entries to the spill file. The block is written
+         * by a background thread, so that appending entries does not wait for the disk.
+         */
+        void spillBlock();
+
+        /**
+         * Waits until the last spilled block has been written to the spill file.
+         * @throw std::exception if the block could not be written.
+         */
+        void waitForSpill();
+
     public:
+        /**
+         * Default constructor.
+         */
+        IndexWriteTable();
 
         /**
          * Allocates all neccessary resources.
          * @param index_delay The maximum delay between indices.
+         * @param spill_file_name The file that receives the oldest master index entries, if the
+         *                        table exceeds max_entries_in_memory. Removed by free().
+         * @param max_entries_in_memory The maximum amount of master index entries that are held
+         *                              in memory, 0 holds all of them.
          * @return Standard result.
          */
-        void create(timestamp_t index_delay = 1000000);
+        void create(timestamp_t index_delay = 1000000,
+                    const std::string& spill_file_name = std::string(),
+                    size_t max_entries_in_memory = 0);
 
         /**
          * Frees all allocated resources.
@@ -99,9 +132,32 @@ class DOEXPORT IndexWriteTable
          * Copys all stream data into a buffer. No buffer overflow checking is done!
          * @param streamId [in] the stream id.
          * @param buffer [out] The buffer that is to be filled.
-         * @rtsafe
          */
-        void copyToBuffer(uint16_t stream_id, void* buffer) const;
+        void copyToBuffer(uint16_t stream_id, void* buffer);
+
+        /**
+         * Copies the entries of the master table starting at a given position.
+         * @param firstEntry [in] The position of the first entry within the master table.
+         * @param entries [out] Receives the entries up to the end of the master table.
+         */
+        void copyMasterEntries(uint64_t first_entry, std::vector<ChunkRef>& entries);
+
+        /**
+         * Copies entries of the master table, including the ones that have been spilled to disk.
+         * @param firstEntry [in] The position of the first entry within the master table.
+         * @param count [in] The amount of entries.
+         * @param buffer [out] Receives the entries.
+         */
+        void copyMasterEntries(uint64_t first_entry, uint64_t count, ChunkRef* buffer);
+
+        /**
+         * Copies entries of a stream table.
+         * @param streamId [in] The stream id.
+         * @param firstEntry [in] The position of the first entry within the stream table.
+         * @param count [in] The amount of entries.
+         * @param buffer [out] Receives the entries.
+         */
+        void copyStreamEntries(uint16_t stream_id, uint64_t first_entry, uint64_t count, StreamRef* buffer) const;
 
         /**
          * Appends a new item to the index table.
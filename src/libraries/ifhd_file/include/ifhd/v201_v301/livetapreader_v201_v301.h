@@ -0,0 +1,87 @@
+/**
+ * @file
+ * Reader for the live tap of the indexed file writer.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef LIVE_TAP_READER_V201_V301_CLASS_HEADER
+#define LIVE_TAP_READER_V201_V301_CLASS_HEADER
+
+namespace ifhd
+{
+namespace v201_v301
+{
+
+//*************************************************************************************************
+/**
+ * Class for reading the chunks an IndexedFileWriter publishes to its live tap, see
+ * IndexedFileWriter::setLiveTap. The chunks are read from shared memory while they are being
+ * recorded, without any disk access. If the reader falls behind, the oldest chunks are lost.
+ */
+class DOEXPORT LiveTapReader
+{
+    public:
+        /// Constructor
+        LiveTapReader();
+
+        /// Destructor
+        ~LiveTapReader();
+
+        /**
+         * Attaches to the live tap of a writer. Only chunks written afterwards are read.
+         *
+         * @param name [in] The name of the live tap.
+         * @throw std::runtime_error if there is no live tap of this name.
+         */
+        void open(const std::string& name);
+
+        /**
+         * Detaches from the live tap.
+         */
+        void close();
+
+        /**
+         * Reads the next chunk. Compressed chunks are decompressed.
+         *
+         * @param chunk_header [out] The header of the chunk, valid until the next call.
+         * @param data [out] The data of the chunk, valid until the next call.
+         * @return false if there is no new chunk.
+         * @throw std::runtime_error if a chunk could not be decompressed.
+         */
+        bool readNextChunk(ChunkHeader** chunk_header, void** data);
+
+        /**
+         * @return The amount of chunks that have been overwritten before they could be read.
+         */
+        uint64_t getLostChunkCount() const;
+
+    private:
+        LiveTapReader(const LiveTapReader&) = delete;
+        LiveTapReader& operator=(const LiveTapReader&) = delete;
+
+    private:
+        utils5ext::SharedRingBuffer _ring;
+        std::vector<uint8_t>        _record;
+        std::vector<uint8_t>        _decompressed;
+        ChunkHeader                 _chunk_header;
+        FileHeader                  _file_header;
+};
+
+} // namespace
+} // namespace
+
+#endif // LIVE_TAP_READER_V201_V301_CLASS_HEADER
@@ -27,6 +27,9 @@ namespace v400
 {
 
 static constexpr uint32_t version_id = 0x00000400;
+/// version of files that contain compressed chunks (@ref ChunkType::ct_compressed),
+/// files without compressed chunks keep the version above to stay readable by older readers
+static constexpr uint32_t version_id_with_compression = 0x00000401;
 
 static inline uint32_t getFileId()
 {
@@ -97,6 +100,23 @@ using ChunkType = v201_v301::ChunkType;
  */
 using OpenMode = v201_v301::OpenMode;
 
+/**
+ * Compression codecs for chunk data.
+ */
+using CompressionCodec = v201_v301::CompressionCodec;
+
+/**
+ * \struct CompressedChunkHeader
+ * Prefix of the data of compressed chunks.
+ */
+using CompressedChunkHeader = v201_v301::CompressedChunkHeader;
+
+/**
+ * \struct FileProgress
+ * The extent of the data on disk of a file that is still being written.
+ */
+using FileProgress = v201_v301::FileProgress;
+
 }  // namespace v400
 } // namespace  ifhd
 
@@ -29,5 +29,6 @@
 
    #include "indexedfilereader_v400.h"
    #include "indexedfilewriter_v400.h"
+   #include "livetapreader_v400.h"
 
 #endif // _IFHD_FILE_V400_HEADER_
@@ -40,6 +40,12 @@ using v201_v301::stream2ChunkRef;
 using v201_v301::stream2StreamRef;
 using v201_v301::stream2StreamInfoHeader;
 using v201_v301::stream2AdditionalStreamIndexInfo;
+using v201_v301::isCompressionCodecAvailable;
+using v201_v301::compressChunkData;
+using v201_v301::getUncompressedChunkDataSize;
+using v201_v301::decompressChunkData;
+using v201_v301::getFileProgressChecksum;
+using v201_v301::readFileProgress;
 
 } // namespace
 } // ifhd
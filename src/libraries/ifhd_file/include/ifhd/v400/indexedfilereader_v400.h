@@ -39,7 +39,8 @@ public:
                 v201_v301::version_id_with_history,
                 v201_v301::version_id_with_history_end_offset,
                 v201_v301::version_id,
-                version_id};
+                version_id,
+                version_id_with_compression};
     }
 };
 
@@ -0,0 +1,37 @@
+/**
+ * @file
+ * Reader for the live tap of the indexed file writer.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef LIVE_TAP_READER_V400_CLASS_HEADER
+#define LIVE_TAP_READER_V400_CLASS_HEADER
+
+namespace ifhd
+{
+namespace v400
+{
+
+/**
+ * Class for reading the chunks an IndexedFileWriter publishes to its live tap.
+ */
+using LiveTapReader = v201_v301::LiveTapReader;
+
+} // namespace
+} // namespace
+
+#endif // LIVE_TAP_READER_V400_CLASS_HEADER
@@ -30,6 +30,8 @@ namespace v500
 {
 
 static constexpr uint32_t version_id = 0x00000500;
+/// version of files that contain compressed chunks, see v400::version_id_with_compression
+static constexpr uint32_t version_id_with_compression = 0x00000501;
 
 static inline uint32_t getFileId()
 {
@@ -100,6 +102,23 @@ using ChunkType = v400::ChunkType;
  */
 using OpenMode = v400::OpenMode;
 
+/**
+ * Compression codecs for chunk data.
+ */
+using CompressionCodec = v400::CompressionCodec;
+
+/**
+ * \struct CompressedChunkHeader
+ * Prefix of the data of compressed chunks.
+ */
+using CompressedChunkHeader = v400::CompressedChunkHeader;
+
+/**
+ * \struct FileProgress
+ * The extent of the data on disk of a file that is still being written.
+ */
+using FileProgress = v400::FileProgress;
+
 }  // namespace v500
 } // namespace  ifhd
 
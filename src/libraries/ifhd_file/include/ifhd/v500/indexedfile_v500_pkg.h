@@ -29,5 +29,6 @@
 
    #include "indexedfilereader_v500.h"
    #include "indexedfilewriter_v500.h"
+   #include "livetapreader_v500.h"
 
 #endif // _IFHD_FILE_V500_HEADER_
@@ -42,6 +42,12 @@ using v400::stream2ChunkRef;
 using v400::stream2StreamRef;
 using v400::stream2StreamInfoHeader;
 using v400::stream2AdditionalStreamIndexInfo;
+using v400::isCompressionCodecAvailable;
+using v400::compressChunkData;
+using v400::getUncompressedChunkDataSize;
+using v400::decompressChunkData;
+using v400::getFileProgressChecksum;
+using v400::readFileProgress;
 
 } // namespace
 } // ifhd
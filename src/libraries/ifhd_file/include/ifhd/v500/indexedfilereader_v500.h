@@ -47,7 +47,9 @@ public:
                 v201_v301::version_id_with_history_end_offset,
                 v201_v301::version_id,
                 v400::version_id,
-                version_id};
+                v400::version_id_with_compression,
+                version_id,
+                version_id_with_compression};
     }
 };
 
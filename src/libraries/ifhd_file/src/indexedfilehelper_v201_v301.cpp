@@ -20,6 +20,14 @@
 
 #include <ifhd/ifhd.h>
 
+#ifdef IFHD_WITH_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef IFHD_WITH_ZSTD
+#include <zstd.h>
+#endif
+
 namespace ifhd
 {
 namespace v201_v301
@@ -62,7 +70,9 @@ a_util::datetime::DateTime getDateTimeHelper(const FileHeader& file_header)
 {
     a_util::datetime::DateTime date_time;
     if (file_header.version_id == v500::version_id ||
+        file_header.version_id == v500::version_id_with_compression ||
         file_header.version_id == v400::version_id ||
+        file_header.version_id == v400::version_id_with_compression ||
         file_header.version_id == v201_v301::version_id ||
         file_header.version_id == v201_v301::version_id_beta ||
         file_header.version_id == v201_v301::version_id_with_history ||
@@ -852,6 +862,252 @@ void stream2StreamInfoHeader(const FileHeader& file_header, StreamInfoHeader& st
     }
 }
 
+#ifdef IFHD_WITH_ZSTD
+/**
+* Zstandard contexts are expensive to create, so every thread keeps its own ones.
+*/
+class ZstdContexts
+{
+public:
+    ~ZstdContexts()
+    {
+        ZSTD_freeCCtx(_compression);
+        ZSTD_freeDCtx(_decompression);
+    }
+
+    ZSTD_CCtx* getCompressionContext()
+    {
+        if (!_compression)
+        {
+            _compression = ZSTD_createCCtx();
+            if (!_compression)
+            {
+                throw std::bad_alloc();
+            }
+        }
+        return _compression;
+    }
+
+    ZSTD_DCtx* getDecompressionContext()
+    {
+        if (!_decompression)
+        {
+            _decompression = ZSTD_createDCtx();
+            if (!_decompression)
+            {
+                throw std::bad_alloc();
+            }
+        }
+        return _decompression;
+    }
+
+private:
+    ZSTD_CCtx* _compression = nullptr;
+    ZSTD_DCtx* _decompression = nullptr;
+};
+
+static thread_local ZstdContexts zstd_contexts;
+#endif
+
+static CompressedChunkHeader readCompressedChunkHeader(const FileHeader& file_header,
+                                                       const void* data,
+                                                       uint32_t data_size)
+{
+    if (data_size < sizeof(CompressedChunkHeader))
+    {
+        throw std::runtime_error("invalid compressed chunk");
+    }
+
+    CompressedChunkHeader header;
+    a_util::memory::copy(&header, sizeof(header), data, sizeof(header));
+    if (file_header.header_byte_order != PLATFORM_BYTEORDER_UINT8)
+    {
+        header.uncompressed_size = a_util::memory::swapEndianess(header.uncompressed_size);
+    }
+
+    return header;
+}
+
+bool isCompressionCodecAvailable(CompressionCodec codec)
+{
+    switch (codec)
+    {
+#ifdef IFHD_WITH_LZ4
+        case cc_lz4:
+            return true;
+#endif
+#ifdef IFHD_WITH_ZSTD
+        case cc_zstd:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+bool compressChunkData(CompressionCodec codec,
+                       int level,
+                       const void* data,
+                       uint32_t data_size,
+                       std::vector<uint8_t>& compressed)
+{
+    if (!isCompressionCodecAvailable(codec))
+    {
+        throw std::invalid_argument("compression codec not available");
+    }
+
+    // the codecs stop as soon as the result would not be smaller than the original
+    if (data_size <= sizeof(CompressedChunkHeader) + 1)
+    {
+        return false;
+    }
+    const uint32_t capacity = data_size - sizeof(CompressedChunkHeader) - 1;
+
+    compressed.resize(sizeof(CompressedChunkHeader) + capacity);
+    CompressedChunkHeader* header = reinterpret_cast<CompressedChunkHeader*>(compressed.data());
+    utils5ext::memZero(header, sizeof(CompressedChunkHeader));
+    header->codec = static_cast<uint8_t>(codec);
+    header->uncompressed_size = data_size;
+
+    size_t compressed_size = 0;
+    switch (codec)
+    {
+#ifdef IFHD_WITH_LZ4
+        case cc_lz4:
+        {
+            // the level is the acceleration factor for LZ4
+            int result = LZ4_compress_fast(static_cast<const char*>(data),
+                                           reinterpret_cast<char*>(header + 1),
+                                           static_cast<int>(data_size),
+                                           static_cast<int>(capacity),
+                                           level > 0 ? level : 1);
+            compressed_size = result > 0 ? static_cast<size_t>(result) : 0;
+            break;
+        }
+#endif
+#ifdef IFHD_WITH_ZSTD
+        case cc_zstd:
+        {
+            size_t result = ZSTD_compressCCtx(zstd_contexts.getCompressionContext(),
+                                              header + 1, capacity,
+                                              data, data_size,
+                                              level);
+            compressed_size = ZSTD_isError(result) ? 0 : result;
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+
+    if (compressed_size == 0)
+    {
+        return false;
+    }
+
+    compressed.resize(sizeof(CompressedChunkHeader) + compressed_size);
+    return true;
+}
+
+uint32_t getUncompressedChunkDataSize(const FileHeader& file_header,
+                                      const void* data,
+                                      uint32_t data_size)
+{
+    return readCompressedChunkHeader(file_header, data, data_size).uncompressed_size;
+}
+
+uint32_t decompressChunkData(const FileHeader& file_header,
+                             const void* data,
+                             uint32_t data_size,
+                             void* destination,
+                             size_t destination_size)
+{
+    const CompressedChunkHeader header = readCompressedChunkHeader(file_header, data, data_size);
+    if (header.uncompressed_size > destination_size)
+    {
+        throw std::runtime_error("decompressed chunk exceeds the buffer");
+    }
+
+    bool valid = false;
+    switch (header.codec)
+    {
+#ifdef IFHD_WITH_LZ4
+        case cc_lz4:
+        {
+            int result = LZ4_decompress_safe(static_cast<const char*>(data) + sizeof(header),
+                                             static_cast<char*>(destination),
+                                             static_cast<int>(data_size - sizeof(header)),
+                                             static_cast<int>(header.uncompressed_size));
+            valid = result == static_cast<int>(header.uncompressed_size);
+            break;
+        }
+#endif
+#ifdef IFHD_WITH_ZSTD
+        case cc_zstd:
+        {
+            size_t result = ZSTD_decompressDCtx(zstd_contexts.getDecompressionContext(),
+                                                destination, header.uncompressed_size,
+                                                static_cast<const uint8_t*>(data) + sizeof(header),
+                                                data_size - sizeof(header));
+            valid = result == header.uncompressed_size;
+            break;
+        }
+#endif
+        default:
+            throw std::runtime_error("compression codec of chunk not available");
+    }
+
+    if (!valid)
+    {
+        throw std::runtime_error("corrupt compressed chunk");
+    }
+
+    return header.uncompressed_size;
+}
+
+uint32_t getFileProgressChecksum(const FileProgress& progress)
+{
+    FileProgress checked_progress = progress;
+    checked_progress.checksum = 0;
+
+    // FNV-1a, detects progress that is read while it is updated
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(&checked_progress);
+    uint32_t hash = 0x811C9DC5;
+    for (size_t index = 0; index < sizeof(checked_progress); ++index)
+    {
+        hash = (hash ^ data[index]) * 0x01000193;
+    }
+    return hash;
+}
+
+bool readFileProgress(const std::string& filename, FileProgress& progress)
+{
+    using namespace utils5ext;
+    const std::string progress_file_name = IndexedFileWriter::getProgressFileName(filename);
+    if (!a_util::filesystem::exists(progress_file_name))
+    {
+        return false;
+    }
+
+    try
+    {
+        // the writer removes the file when it closes the file that is written
+        File file;
+        file.open(progress_file_name, File::om_read | File::om_shared_read | File::om_shared_write);
+        if (file.read(&progress, sizeof(progress)) != sizeof(progress))
+        {
+            return false;
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return progress.progress_id == getFileProgressId() &&
+           progress.checksum == getFileProgressChecksum(progress);
+}
+
 } //v400
 
 } // namespace
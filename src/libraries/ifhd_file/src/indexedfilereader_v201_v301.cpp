@@ -18,11 +18,15 @@
  */
 
 #include <ifhd/ifhd.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 #include <string.h>
 #include <assert.h>
 
 
 #define MAX_CACHE_WRITE_SIZE 512*1024
+#define FOLLOW_SCAN_BLOCK_SIZE 64*1024
 #define EXT_STORAGE_INFO "storage_info"
 
 #define ADTF_RING_BUFFER_HANDLING_PRE_2_13_1
@@ -65,6 +69,24 @@ class IndexedFileReader::IndexedFileReaderImpl
         std::map<int64_t, FilePos> map_file_pos_offsets;
         IndexedFileReader* p = nullptr;
 
+        // set if opened with om_memory_mapped
+        std::shared_ptr<utils5ext::MemoryMappedFile> mapped_view;
+
+        // streams read by readNextChunk, empty for all
+        std::set<uint16_t> stream_filter;
+
+        // used instead of the file if opened with om_read_ahead
+        utils5ext::FilePrefetcher read_ahead;
+        size_t read_ahead_window = 64 * 1024 * 1024;
+
+        // receives the data of compressed chunks read without rf_use_external_buffer
+        std::vector<uint8_t> decompression_buffer;
+
+        // set while a file opened with om_follow is still being written
+        bool following = false;
+        timestamp_t follow_interval = 10000;
+        std::vector<uint8_t> follow_scan_buffer;
+
     public:
         explicit IndexedFileReaderImpl(IndexedFileReader& parent)
         {
@@ -85,6 +107,161 @@ class IndexedFileReader::IndexedFileReaderImpl
             map_file_pos_offsets.clear();
         }
 
+        const uint8_t* getMappedData(FilePos file_pos, size_t size) const
+        {
+            if (file_pos < 0 ||
+                file_pos + static_cast<FilePos>(size) > mapped_view->getSize())
+            {
+                throw exceptions::EndOfFile();
+            }
+
+            return mapped_view->getData() + file_pos;
+        }
+
+        /**
+         * Reads the header of a followed file once the writer has completed it.
+         * @return false if the file has not been completed yet.
+         */
+        bool readCompletedHeader(FileHeader& file_header)
+        {
+            using namespace utils5ext;
+            FileHeader check_header;
+            p->_file.setFilePos(0, File::fp_begin);
+            p->_file.readAll(&file_header, sizeof(file_header));
+            p->_file.setFilePos(0, File::fp_begin);
+            p->_file.readAll(&check_header, sizeof(check_header));
+            p->_file_pos_invalid = true;
+
+            // the header is written as a whole when the file is closed, reading it twice
+            // rules out a partial update
+            if (a_util::memory::compare(&file_header, sizeof(file_header),
+                                        &check_header, sizeof(check_header)) != 0)
+            {
+                return false;
+            }
+
+            stream2FileHeader(file_header);
+            return file_header.data_offset != 0;
+        }
+
+        /**
+         * Makes the chunks visible that have been published since the last call, see om_follow.
+         * The chunk headers are read in blocks from the end of the known chunks up to the
+         * published end of the data, incomplete chunks are left for the next call.
+         * @return Whether there are new chunks.
+         */
+        bool scanPublishedChunks()
+        {
+            using namespace utils5ext;
+            FileHeader* file_header = p->_file_header;
+
+            FilePos data_offset = 0;
+            FilePos data_end = 0;
+            FileProgress progress;
+            FileHeader completed_header;
+            if (readFileProgress(p->_filename, progress))
+            {
+                data_offset = static_cast<FilePos>(progress.data_offset);
+                data_end = static_cast<FilePos>(progress.data_end);
+            }
+            else if (readCompletedHeader(completed_header))
+            {
+                // the progress is removed after the final header has been written
+                data_offset = static_cast<FilePos>(completed_header.data_offset);
+                data_end = static_cast<FilePos>(completed_header.data_offset + completed_header.data_size);
+                following = false;
+            }
+            else
+            {
+                // nothing has been published yet or the progress is being updated
+                return false;
+            }
+
+            if (file_header->data_offset == 0)
+            {
+                file_header->data_offset = data_offset;
+                file_header->first_chunk_offset = data_offset;
+                file_header->continuous_offset = data_offset;
+                file_header->ring_buffer_end_offset = data_offset;
+                p->_end_of_data_marker = data_offset;
+                if (p->_chunk_index == 0)
+                {
+                    p->_file_pos = data_offset;
+                    p->_file_pos_invalid = true;
+                }
+            }
+
+            const FilePos header_size = static_cast<FilePos>(sizeof(ChunkHeader));
+            const FilePos compressed_header_size = static_cast<FilePos>(sizeof(CompressedChunkHeader));
+            FilePos pos = p->_end_of_data_marker;
+            FilePos block_pos = 0;
+            FilePos block_end = 0;
+            bool found = false;
+            while (pos + header_size <= data_end)
+            {
+                // compressed chunks also need the size of their uncompressed data
+                const FilePos required_end = std::min(pos + header_size + compressed_header_size, data_end);
+                if (pos < block_pos || required_end > block_end)
+                {
+                    block_pos = pos;
+                    block_end = std::min<FilePos>(pos + FOLLOW_SCAN_BLOCK_SIZE, data_end);
+                    follow_scan_buffer.resize(static_cast<size_t>(block_end - block_pos));
+                    p->_file.setFilePos(block_pos, File::fp_begin);
+                    p->_file.readAll(follow_scan_buffer.data(), follow_scan_buffer.size());
+                    p->_file_pos_invalid = true;
+                }
+
+                const uint8_t* chunk_data = follow_scan_buffer.data() + (pos - block_pos);
+                ChunkHeader chunk_header;
+                a_util::memory::copy(&chunk_header, sizeof(chunk_header), chunk_data, sizeof(chunk_header));
+                stream2ChunkHeader(*file_header, chunk_header);
+                if (chunk_header.stream_id == 0 ||
+                    chunk_header.stream_id > MAX_INDEXED_STREAMS ||
+                    chunk_header.size < sizeof(ChunkHeader))
+                {
+                    throw std::runtime_error("invalid chunk header in followed file");
+                }
+
+                const FilePos chunk_end = pos + ((chunk_header.size + 0xF) & ~0xF);
+                if (chunk_end > data_end)
+                {
+                    break;
+                }
+
+                uint64_t chunk_size = chunk_header.size;
+                if ((chunk_header.flags & ct_compressed) != 0)
+                {
+                    chunk_size = sizeof(ChunkHeader) +
+                                 getUncompressedChunkDataSize(*file_header,
+                                                              chunk_data + sizeof(ChunkHeader),
+                                                              chunk_header.size - sizeof(ChunkHeader));
+                }
+
+                if (file_header->chunk_count == 0)
+                {
+                    file_header->time_offset = chunk_header.time_stamp;
+                }
+                file_header->duration = chunk_header.time_stamp - file_header->time_offset;
+                file_header->max_chunk_size = std::max(file_header->max_chunk_size, chunk_size);
+                file_header->chunk_count++;
+                file_header->data_size += static_cast<uint64_t>(chunk_end - pos);
+
+                pos = chunk_end;
+                found = true;
+            }
+
+            p->_end_of_data_marker = pos;
+
+            if (found)
+            {
+                p->allocBuffer(file_header->max_chunk_size);
+                p->clearCache();
+                p->_file_pos_invalid = true;
+            }
+
+            return found;
+        }
+
         void SetRealValidChunkHeader(const ChunkHeader* header,
                                         const FilePos file_pos,
                                         const int64_t valid_chunk_index)
@@ -239,7 +416,6 @@ IndexedFileReader::IndexedFileReader()
 
 IndexedFileReader::~IndexedFileReader()
 {
-    _d.release();
     close();
 }
 
@@ -289,6 +465,12 @@ void IndexedFileReader::open(const a_util::filesystem::Path& filename, int cache
     using namespace utils5ext;
     close();
 
+    if ((flags & om_follow) != 0 && (flags & (om_memory_mapped | om_read_ahead | om_dense_index)) != 0)
+    {
+        throw std::invalid_argument("om_follow is not supported together with om_memory_mapped, "
+                                    "om_read_ahead or om_dense_index");
+    }
+
     _flags = flags;
 
     _system_cache_disabled = false;
@@ -354,7 +536,28 @@ void IndexedFileReader::open(const a_util::filesystem::Path& filename, int cache
 
     readFileHeaderExt();
 
-    if ((flags & om_query_info) == 0)
+    // the data offset is only stored when the writer closes the file
+    _d->following = (flags & om_follow) != 0 && (flags & om_query_info) == 0 && _file_header->data_offset == 0;
+    if (_d->following)
+    {
+        _file_header->chunk_count = 0;
+        _file_header->data_size = 0;
+        _file_header->max_chunk_size = 0;
+        _file_header->time_offset = 0;
+        _file_header->duration = 0;
+        _file_header->first_chunk_offset = 0;
+        _file_header->continuous_offset = 0;
+        _file_header->ring_buffer_end_offset = 0;
+        _end_of_data_marker = 0;
+
+        clearCache();
+        _current_chunk_data = nullptr;
+        _header_valid = false;
+
+        reset();
+        _d->scanPublishedChunks();
+    }
+    else if ((flags & om_query_info) == 0)
     {
         _index_table.readIndexTable();
 
@@ -364,10 +567,33 @@ void IndexedFileReader::open(const a_util::filesystem::Path& filename, int cache
 
         allocBuffer((size_t) _file_header->max_chunk_size);
 
+        if ((flags & om_memory_mapped) != 0)
+        {
+            _d->mapped_view = std::make_shared<MemoryMappedFile>();
+            _d->mapped_view->map(filename);
+        }
+        else if ((flags & om_read_ahead) != 0)
+        {
+            // 64 blocks per window, but do not issue too small reads
+            _d->read_ahead.open(filename, _d->read_ahead_window,
+                                std::max<size_t>(_d->read_ahead_window / 64, 64 * 1024));
+            if (_file_header->data_offset != _file_header->first_chunk_offset)
+            {
+                // follow the ring buffer of files with history the same way readCurrentChunkData does
+                _d->read_ahead.addJump(_file_header->continuous_offset, _file_header->data_offset);
+                _d->read_ahead.addJump(_file_header->ring_buffer_end_offset, _file_header->continuous_offset);
+            }
+        }
+
         _current_chunk_data = nullptr;
         _header_valid = false;
 
         reset();
+
+        if ((flags & om_dense_index) != 0)
+        {
+            buildDenseIndex();
+        }
     }
     else    // just open for header and extension info
     {
@@ -395,6 +621,14 @@ void IndexedFileReader::close()
 
     _filename = "";
 
+    if (nullptr != _d.get())
+    {
+        // pinned views stay valid until the last handle is released
+        _d->mapped_view.reset();
+        _d->read_ahead.close();
+        _d->following = false;
+    }
+
     freeReadBuffers();
     _index_table.free();
 
@@ -726,12 +960,34 @@ try
         return DELEGATE_PTR(_delegate)->seek(position, seek_format_v110, seek_flagsv110);
     }             
 
+    if (_d->following)
+    {
+        throw std::logic_error("seeking is not supported while following a file");
+    }
+
     _current_chunk_data            = nullptr;
     _header_valid                  = false;
     _prefetched                   = false;
 
     clearCache();
 
+    // the dense index knows the exact chunk, so we only have to read that one
+    if ((flags & sf_keydata) == 0 && _index_table.hasDenseIndex())
+    {
+        _chunk_index = _index_table.lookupDenseChunkRef(stream_id, position, time_format,
+                                                        (flags & sf_before) != 0, &_file_pos);
+        _file_pos_invalid = true;
+
+        checkFilePtr();
+        readCurrentChunkHeader();
+        readCurrentChunkData(_buffer);
+
+        _prefetched = true;
+        _header_valid = true;
+
+        return _chunk_index;
+    }
+
     int64_t master_index = 0;
     int64_t end_chunk_index = 0;
     if (time_format == tf_chunk_index && (flags & sf_keydata) != 0)
@@ -1118,7 +1374,15 @@ try
 
     if (_file_pos_invalid == true)
     {
-        _file.setFilePos(_file_pos, File::fp_begin);
+        if (_d->read_ahead.isOpen())
+        {
+            // keeps the prefetched data if the position is within the read-ahead window
+            _d->read_ahead.setFilePos(_file_pos);
+        }
+        else if (!_d->mapped_view)
+        {
+            _file.setFilePos(_file_pos, File::fp_begin);
+        }
         _file_pos_invalid = false;
 
 #ifdef ADTF_RING_BUFFER_HANDLING_PRE_2_13_1
@@ -1234,7 +1498,17 @@ try
     }
 
     checkFilePtr();
-    readDataBlock(buffer, data_size);
+
+    void* chunk_data = buffer;
+    if (_d->mapped_view && buffer == _buffer)
+    {
+        // no copy, the data is handed out directly from the mapped view
+        chunk_data = const_cast<uint8_t*>(_d->getMappedData(_file_pos, data_size));
+    }
+    else
+    {
+        readDataBlock(buffer, data_size);
+    }
 
     if (_d->chunk_header_search_possible)
     {
@@ -1248,7 +1522,15 @@ try
     if ((data_size & 0xF) != 0)
     {
         int skip_bytes = 16-(data_size & 0xF);
-        if (_cache_size > 0)
+        if (_d->mapped_view)
+        {
+            // nothing to skip within the view
+        }
+        else if (_d->read_ahead.isOpen())
+        {
+            _d->read_ahead.skip(skip_bytes);
+        }
+        else if (_cache_size > 0)
         {
             readDataBlock(chunk_fill_buffer, skip_bytes);
         }
@@ -1277,7 +1559,7 @@ try
 
     IFHD_ASSERT((_file_pos & 0xF) == 0);
 
-    _current_chunk_data = buffer;
+    _current_chunk_data = chunk_data;
 }
 catch (...)
 {
@@ -1360,26 +1642,50 @@ void IndexedFileReader::readChunk(void** data, uint32_t flags)
         readCurrentChunkHeader();
     }
 
+    // compressed data is read into the internal buffer (or the mapped view) and decompressed from there
+    const bool compressed = (_current_chunk->flags & ct_compressed) != 0;
+
     if (!_prefetched)
     {
-        readCurrentChunkData(buffer);
+        readCurrentChunkData(compressed ? _buffer : buffer);
     }
     else
     {
-        if (use_external_buffer)
+        if (use_external_buffer && !compressed)
         {
-            a_util::memory::copy(buffer, _current_chunk->size, _buffer, _current_chunk->size);
+            const size_t data_size = _current_chunk->size - sizeof(ChunkHeader);
+            a_util::memory::copy(buffer, data_size, _current_chunk_data, data_size);
         }
 
         // reset prefetch flag
         _prefetched = false;
     }
 
+    if (compressed)
+    {
+        if (!use_external_buffer)
+        {
+            _d->decompression_buffer.resize(static_cast<size_t>(_file_header->max_chunk_size));
+            buffer = _d->decompression_buffer.data();
+        }
+
+        // the header describes the decompressed chunk from now on
+        _current_chunk->size = sizeof(ChunkHeader) +
+                               decompressChunkData(*_file_header,
+                                                   _current_chunk_data,
+                                                   _current_chunk->size - sizeof(ChunkHeader),
+                                                   buffer,
+                                                   static_cast<size_t>(_file_header->max_chunk_size));
+        _current_chunk->flags &= static_cast<uint16_t>(~ct_compressed);
+        _current_chunk_data = buffer;
+    }
+
     _header_valid = false;
 
     if (!use_external_buffer)
     {
-        *data = _buffer;
+        // either _buffer or a pointer into the mapped view
+        *data = _current_chunk_data;
     }
 
     if ((flags & rf_backwards) != 0)
@@ -1458,16 +1764,22 @@ void IndexedFileReader::skipChunk()
             throw exceptions::EndOfFile(); // EOF if chunk size exceeds data region
         }
 
-        _file_pos += data_size;
+        FilePos skip_bytes = data_size;
 
         if ((data_size & 0xF) != 0)
         {
-            int skip_bytes = 16-(data_size & 0xF);
-            _file_pos += skip_bytes;
+            skip_bytes += 16-(data_size & 0xF);
         }
 
+        _file_pos += skip_bytes;
+
         IFHD_ASSERT((_file_pos & 0xF) == 0);
 
+        // the file pointer is left behind the chunk header, so as long as we do not wrap around
+        // we can simply skip the data and keep the read cache of the file
+        bool reposition = _file_pos_invalid || _d->mapped_view || _cache_size != 0 ||
+                          _d->chunk_header_search_possible;
+
         if (_cache_size != 0)
         {
             clearCache();
@@ -1478,14 +1790,27 @@ void IndexedFileReader::skipChunk()
             if (_file_pos == (FilePos)(_file_header->continuous_offset))
             {
                 _file_pos = _file_header->data_offset;
+                reposition = true;
             }
             else if (_file_pos == (FilePos)(_file_header->ring_buffer_end_offset))
             {
                 _file_pos = _file_header->continuous_offset;
+                reposition = true;
             }
         }
 
-        _file_pos_invalid = true;
+        if (reposition)
+        {
+            _file_pos_invalid = true;
+        }
+        else if (_d->read_ahead.isOpen())
+        {
+            _d->read_ahead.skip(static_cast<size_t>(skip_bytes));
+        }
+        else
+        {
+            _file.skip(static_cast<size_t>(skip_bytes));
+        }
     }
 
     _prefetched  = false;
@@ -1522,7 +1847,7 @@ void IndexedFileReader::readNextChunk(ChunkHeader** chunk_header, void** data, u
         return;
     }
 
-    if (stream_id == 0)
+    if (stream_id == 0 && _d->stream_filter.empty())
     {
         queryChunkInfo(chunk_header);
         return readChunk(data, flags);
@@ -1532,16 +1857,107 @@ void IndexedFileReader::readNextChunk(ChunkHeader** chunk_header, void** data, u
         do
         {
             queryChunkInfo(chunk_header);
-            readChunk(data, flags);
-            if ((*chunk_header)->stream_id == stream_id)
+            if ((stream_id == 0 || (*chunk_header)->stream_id == stream_id) &&
+                isStreamSelected((*chunk_header)->stream_id))
             {
-                return;
+                return readChunk(data, flags);
+            }
+
+            if ((flags & rf_backwards) != 0)
+            {
+                readChunk(data, flags);
+            }
+            else
+            {
+                // only the header has been read, skip the data
+                skipChunk();
             }
         } while (true);
     }
     return;
 }
 
+void IndexedFileReader::buildDenseIndex()
+{
+    if (nullptr != _delegate)
+    {
+        throw std::runtime_error("compatibility reader does not support a dense index");
+    }
+
+    const std::string dense_index_file_name = getDenseIndexFileName(_filename);
+    const uint64_t file_size = static_cast<uint64_t>(_file.getSize());
+    if (_index_table.loadDenseIndex(dense_index_file_name, file_size))
+    {
+        reset();
+        return;
+    }
+
+    reset();
+
+    try
+    {
+        for (uint64_t chunk = 0; chunk < _file_header->chunk_count; ++chunk)
+        {
+            ChunkHeader* chunk_header;
+            queryChunkInfo(&chunk_header);
+            _index_table.appendDenseIndexEntry(*chunk_header, _file_pos_current_chunk);
+            skipChunk();
+        }
+    }
+    catch (const exceptions::EndOfFile&)
+    {
+        // truncated file, the dense index is incomplete and will not be used
+        _index_table.clearDenseIndex();
+    }
+
+    reset();
+
+    if (_index_table.hasDenseIndex())
+    {
+        // the next reader loads the index instead of scanning the file, reading the file does
+        // not depend on it, e.g. the directory might be read-only
+        try
+        {
+            _index_table.storeDenseIndex(dense_index_file_name, file_size);
+        }
+        catch (const std::exception&)
+        {
+            a_util::filesystem::remove(dense_index_file_name);
+        }
+    }
+}
+
+std::string IndexedFileReader::getDenseIndexFileName(const std::string& filename)
+{
+    return filename + ".ifhd_dense";
+}
+
+bool IndexedFileReader::hasDenseIndex() const
+{
+    return nullptr == _delegate && _index_table.hasDenseIndex();
+}
+
+void IndexedFileReader::setStreamFilter(const std::set<uint16_t>& stream_ids)
+{
+    if (nullptr != _delegate && !stream_ids.empty())
+    {
+        throw std::runtime_error("compatibility reader does not support stream filters");
+    }
+
+    _d->stream_filter = stream_ids;
+}
+
+const std::set<uint16_t>& IndexedFileReader::getStreamFilter() const
+{
+    return _d->stream_filter;
+}
+
+bool IndexedFileReader::isStreamSelected(uint16_t stream_id) const
+{
+    return _d->stream_filter.empty() ||
+           _d->stream_filter.find(stream_id) != _d->stream_filter.end();
+}
+
 void IndexedFileReader::skipChunkInfo()
 {
     _index_table_index++;
@@ -1562,7 +1978,18 @@ void IndexedFileReader::readDataBlock(void* buffer, size_t buffer_size)
 
     IFHD_ASSERT(_file_pos_invalid == false);
 
-    if (_cache_size > 0)
+    if (_d->mapped_view)
+    {
+        a_util::memory::copy(buffer, buffer_size, _d->getMappedData(_file_pos, buffer_size), buffer_size);
+    }
+    else if (_d->read_ahead.isOpen())
+    {
+        if (_d->read_ahead.read(buffer, buffer_size) != buffer_size)
+        {
+            throw exceptions::EndOfFile();
+        }
+    }
+    else if (_cache_size > 0)
     {
         if (read_size <= static_cast<int64_t>(_cache_size))
         {
@@ -1769,9 +2196,11 @@ bool IndexedFileReader::getLastChunkWithFlagBefore(uint64_t chunk_index, uint16_
     _header_valid = false;
     _prefetched = false;
 
+    // read directly, the chunk must not be subject to the stream filter
     ChunkHeader* chunk_header;
     void* data;
-    readNextChunk(&chunk_header, &data);
+    queryChunkInfo(&chunk_header);
+    readChunk(&data);
 
     header = *chunk_header;
     vector_data.assign(static_cast<uint8_t*>(data), static_cast<uint8_t*>(data) + chunk_header->size - sizeof(ChunkHeader));
@@ -1786,6 +2215,70 @@ bool IndexedFileReader::getLastChunkWithFlagBefore(uint64_t chunk_index, uint16_
     return true;
 }
 
+bool IndexedFileReader::waitForChunks(timestamp_t timeout)
+{
+    if (!_d->following)
+    {
+        return false;
+    }
+
+    if (_chunk_index < 0)
+    {
+        // continue behind the chunks that have been read
+        _chunk_index = static_cast<int64_t>(_file_header->chunk_count);
+        _file_pos = _end_of_data_marker != 0 ? _end_of_data_marker : _file_header->data_offset;
+        _file_pos_invalid = true;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout);
+    for (;;)
+    {
+        if (_d->scanPublishedChunks())
+        {
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (!_d->following || now >= deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            deadline - now, std::chrono::microseconds(_d->follow_interval)));
+    }
+}
+
+bool IndexedFileReader::isComplete() const
+{
+    return !_d->following;
+}
+
+void IndexedFileReader::setFollowInterval(timestamp_t interval)
+{
+    _d->follow_interval = interval;
+}
+
+bool IndexedFileReader::isMemoryMapped() const
+{
+    return static_cast<bool>(_d->mapped_view);
+}
+
+void IndexedFileReader::setReadAheadWindow(size_t window_size)
+{
+    _d->read_ahead_window = window_size;
+}
+
+bool IndexedFileReader::isReadingAhead() const
+{
+    return _d->read_ahead.isOpen();
+}
+
+std::shared_ptr<const utils5ext::MemoryMappedFile> IndexedFileReader::pinMappedView() const
+{
+    return _d->mapped_view;
+}
+
 void IndexedFileReader::allocReadBuffers()
 {
     _current_chunk = (ChunkHeader*) utils5ext::allocPageAlignedMemory(sizeof(ChunkHeader), utils5ext::getDefaultSectorSize());
@@ -19,7 +19,13 @@
  */
 
 #include <ifhd/ifhd.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
 #include <queue>
+#include <vector>
 #include <string.h>
 #include <assert.h>
 
@@ -70,16 +76,346 @@ struct Additional
  */
 typedef utils5ext::FileRingBuffer<Additional, 16> RingBuffer;
 
+/// The average chunk size the items of a preallocated history are reserved for, see om_preallocate_history
+static const utils5ext::FileSize expected_history_chunk_size = 4096;
+
 //*************************************************************************************************
 
+/**
+ * Header of a chunk in the queue of a ChunkProducer, followed by the chunk data.
+ */
+struct QueuedChunk
+{
+    timestamp_t time_stamp;
+    uint32_t data_size;
+    uint32_t flags;
+    uint16_t stream_id;
+};
+
+/// Compressed chunk data of the current thread, see IndexedFileWriter::compressChunk
+static thread_local std::vector<uint8_t> compression_buffer;
+
 /// Definition of filling bytes. Chunks are filled up to 16 byte boundaries
 static uint8_t chunk_fill_bytes[16] = {0xEE,0xEE,0xEE,0xEE,0xEE,0xEE,0xEE,0xEE,
                                        0xEE,0xEE,0xEE,0xEE,0xEE,0xEE,0xEE,0xEE};
 
+//*************************************************************************************************
+
+/// Identifiers of the index journal and its checkpoints ("IFHJ" and "IFHC")
+static const uint32_t journal_id            = 0x4A484649;
+static const uint32_t journal_checkpoint_id = 0x43484649;
+static const uint32_t journal_version       = 1;
+
+/// The checkpoint contains compressed chunks, see JournalCheckpoint::flags
+static const uint32_t journal_compressed_chunks = 0x1;
+
+#pragma pack(push)
+#pragma pack(1)
+/**
+ * Header at the beginning of an index journal, followed by checkpoints.
+ */
+struct JournalHeader
+{
+    uint32_t    journal_id;
+    uint32_t    journal_version;
+    timestamp_t index_delay;
+};
+
+/**
+ * A checkpoint of the writer state. It is followed by the index entries added since the previous
+ * checkpoint and a JournalStreamInfo for every stream in use.
+ */
+struct JournalCheckpoint
+{
+    uint32_t    checkpoint_id;
+    uint32_t    record_size;        // the size of the whole checkpoint
+    uint32_t    checksum;           // of the whole checkpoint with this field set to zero
+    uint32_t    flags;
+    uint32_t    index_entry_count;
+    uint32_t    stream_count;
+    uint64_t    file_pos;           // the end of the data covered by the checkpoint
+    uint64_t    file_pos_last_chunk;
+    timestamp_t last_chunk_time;
+    timestamp_t time_offset;
+    FileHeader  file_header;
+};
+
+/**
+ * Stream information of a checkpoint, followed by the additional stream info if it has changed
+ * since the previous checkpoint.
+ */
+struct JournalStreamInfo
+{
+    uint16_t         stream_id;
+    uint16_t         has_info_data;
+    StreamInfoHeader stream_info;
+};
+#pragma pack(pop)
+
+/**
+ * FNV-1a hash to detect incomplete checkpoints.
+ */
+static uint32_t getJournalChecksum(const uint8_t* data, size_t data_size)
+{
+    uint32_t hash = 0x811C9DC5;
+    for (size_t index = 0; index < data_size; ++index)
+    {
+        hash = (hash ^ data[index]) * 0x01000193;
+    }
+    return hash;
+}
+
+template <typename T>
+static void appendToRecord(std::vector<uint8_t>& record, const T* data, size_t count = 1)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(data);
+    record.insert(record.end(), bytes, bytes + sizeof(T) * count);
+}
+
+/// the suffix of the temporary file that receives the index entries beyond the memory limit
+static const char* const index_spill_file_suffix = ".ifhd_index";
+
+/// the size of the blocks in which the index extensions are written
+static constexpr size_t index_write_block_size = 4 * 1024 * 1024;
+
+/// the minimum size of the data area that is searched for chunks by a single thread
+static constexpr uint64_t repair_minimum_range_size = 1024 * 1024;
+static constexpr size_t repair_block_size = 4 * 1024 * 1024;
+
+/// the maximum amount of chunk candidates of a range that are kept in memory
+static constexpr size_t repair_queue_size = 16384;
+
+/// a chunk header found at a 16 byte aligned position of a file that is repaired
+struct ChunkCandidate
+{
+    uint64_t file_pos;
+    uint64_t uncompressed_size;
+    ChunkHeader header;
+};
+
+/**
+ * Passes the chunk candidates of one range from the thread that searches the range to the thread
+ * that follows the chunks. The searching thread waits while the queue is full, so the memory does
+ * not grow with the size of the file.
+ */
+class ChunkCandidateQueue
+{
+    public:
+        /**
+         * Appends a candidate, waits while the queue is full.
+         * @return false if the queue has been cancelled.
+         */
+        bool push(const ChunkCandidate& candidate)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _changed.wait(lock, [this] { return _cancelled || _candidates.size() < repair_queue_size; });
+            if (_cancelled)
+            {
+                return false;
+            }
+            _candidates.push_back(candidate);
+            _changed.notify_all();
+            return true;
+        }
+
+        /// Marks the end of the range, the error is passed to the following thread.
+        void finish(std::exception_ptr error)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _finished = true;
+            _error = error;
+            _changed.notify_all();
+        }
+
+        /// Stops the searching thread.
+        void cancel()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _cancelled = true;
+            _changed.notify_all();
+        }
+
+        /**
+         * Removes the next candidate, waits until one has been found or the range has been searched.
+         * @return false if all candidates of the range have been removed.
+         * @throw the error of the searching thread.
+         */
+        bool pop(ChunkCandidate& candidate)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _changed.wait(lock, [this] { return _finished || !_candidates.empty(); });
+            if (_candidates.empty())
+            {
+                if (_error)
+                {
+                    std::rethrow_exception(_error);
+                }
+                return false;
+            }
+            candidate = _candidates.front();
+            _candidates.pop_front();
+            _changed.notify_all();
+            return true;
+        }
+
+    private:
+        std::mutex                 _mutex;
+        std::condition_variable    _changed;
+        std::deque<ChunkCandidate> _candidates;
+        bool                       _finished = false;
+        bool                       _cancelled = false;
+        std::exception_ptr         _error;
+};
+
+/**
+ * Searches the chunk headers that start within [begin, end), only checking the values that do not
+ * depend on the previous chunks. The candidates are passed on in the order of their position.
+ */
+static void findChunkCandidates(const std::string& filename,
+                                const FileHeader& file_header,
+                                uint64_t begin,
+                                uint64_t end,
+                                uint64_t file_size,
+                                ChunkCandidateQueue& queue)
+{
+    using namespace utils5ext;
+
+    try
+    {
+        File file;
+        file.open(filename, File::om_read | File::om_shared_read);
+
+        std::vector<uint8_t> block;
+        for (uint64_t block_begin = begin; block_begin < end; block_begin += repair_block_size)
+        {
+            // the headers at the end of the block may reach into the next one
+            const uint64_t block_end = std::min<uint64_t>(block_begin + repair_block_size, end);
+            block.resize(static_cast<size_t>(
+                std::min<uint64_t>(block_end + sizeof(ChunkHeader) + sizeof(CompressedChunkHeader), file_size) - block_begin));
+            file.setFilePos(block_begin, File::fp_begin);
+            file.readAll(block.data(), block.size());
+
+            for (uint64_t file_pos = block_begin;
+                 file_pos < block_end && file_pos + sizeof(ChunkHeader) <= file_size;
+                 file_pos += 0x10)
+            {
+                const uint8_t* data = block.data() + (file_pos - block_begin);
+                ChunkCandidate candidate;
+                a_util::memory::copy(&candidate.header, sizeof(ChunkHeader), data, sizeof(ChunkHeader));
+
+                const ChunkHeader& header = candidate.header;
+                if (header.size < sizeof(ChunkHeader) ||
+                    header.size > file_size - file_pos ||
+                    header.stream_id == 0 || header.stream_id > MAX_INDEXED_STREAMS ||
+                    (header.offset_to_last & 0xF) != 0 ||
+                    header.offset_to_last > file_pos - file_header.data_offset)
+                {
+                    continue;
+                }
+
+                candidate.file_pos = file_pos;
+                candidate.uncompressed_size = header.size;
+                if ((header.flags & ct_compressed) != 0)
+                {
+                    if (header.size < sizeof(ChunkHeader) + sizeof(CompressedChunkHeader))
+                    {
+                        continue;
+                    }
+                    candidate.uncompressed_size = getUncompressedChunkDataSize(file_header,
+                                                                               data + sizeof(ChunkHeader),
+                                                                               sizeof(CompressedChunkHeader)) +
+                                                  sizeof(ChunkHeader);
+                }
+
+                if (!queue.push(candidate))
+                {
+                    return;
+                }
+            }
+        }
+
+        queue.finish(nullptr);
+    }
+    catch (...)
+    {
+        queue.finish(std::current_exception());
+    }
+}
+
+/**
+ * Checks whether a candidate found behind a damaged chunk is a chunk of the file, i.e. whether it
+ * is followed by a chunk that refers to it or ends the file.
+ */
+static bool isFollowedByChunk(utils5ext::File& file, const ChunkCandidate& candidate, uint64_t file_size)
+{
+    const uint64_t whole_chunk = (candidate.header.size + 0xF) & ~uint64_t(0xF);
+    const uint64_t next_pos = candidate.file_pos + whole_chunk;
+    if (next_pos >= file_size)
+    {
+        return true;
+    }
+    if (next_pos + sizeof(ChunkHeader) > file_size)
+    {
+        return false;
+    }
+
+    ChunkHeader next;
+    file.setFilePos(next_pos, utils5ext::File::fp_begin);
+    file.readAll(&next, sizeof(next));
+    return next.offset_to_last == whole_chunk &&
+           next.size >= sizeof(ChunkHeader) &&
+           next.size <= file_size - next_pos &&
+           next.stream_id != 0 && next.stream_id <= MAX_INDEXED_STREAMS;
+}
+
+/**
+ * Writes a chunk behind a damaged area to its new position at the end of the repaired data. The
+ * new position is never behind the old one, so the chunk is copied front to back.
+ */
+static void moveChunk(utils5ext::File& file, uint64_t source_pos, uint64_t destination_pos, const ChunkHeader& header)
+{
+    file.setFilePos(destination_pos, utils5ext::File::fp_begin);
+    file.writeAll(&header, sizeof(header));
+    if (source_pos == destination_pos)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> block;
+    for (uint64_t offset = sizeof(ChunkHeader); offset < header.size; offset += repair_block_size)
+    {
+        block.resize(static_cast<size_t>(std::min<uint64_t>(repair_block_size, header.size - offset)));
+        file.setFilePos(source_pos + offset, utils5ext::File::fp_begin);
+        file.readAll(block.data(), block.size());
+        file.setFilePos(destination_pos + offset, utils5ext::File::fp_begin);
+        file.writeAll(block.data(), block.size());
+    }
+}
+
+/// Copies a file block by block, see IndexedFileWriter::getBackupFileName
+static void copyFile(const std::string& source_name, const std::string& destination_name)
+{
+    utils5ext::File source;
+    source.open(source_name, utils5ext::File::om_read);
+    utils5ext::File destination;
+    destination.open(destination_name, utils5ext::File::om_write);
+
+    const uint64_t file_size = static_cast<uint64_t>(source.getSize());
+    std::vector<uint8_t> block;
+    for (uint64_t offset = 0; offset < file_size; offset += block.size())
+    {
+        block.resize(static_cast<size_t>(std::min<uint64_t>(repair_block_size, file_size - offset)));
+        source.readAll(block.data(), block.size());
+        destination.writeAll(block.data(), block.size());
+    }
+    destination.syncData();
+}
+
 /**************************************/
 /* This still needs to be implemented.*/
 /**************************************/
-class IndexedFileWriter::IndexedFileWriterImpl : public RingBuffer::DropCallback
+class IndexedFileWriter::IndexedFileWriterImpl : public RingBuffer::DropCallback,
+                                                  public RingBuffer::FileAccess
 {
     IndexedFileWriter* _p;
 
@@ -96,6 +432,7 @@ class IndexedFileWriter::IndexedFileWriterImpl : public RingBuffer::DropCallback
         timestamp_t                 first_time;
         bool                        first_time_set;
         utils5ext::FileSize        history_size;
+        bool                        history_preallocated;
         bool                        wrapping_started;
         ChunkHeader                header;
         int                         address_begin;
@@ -106,10 +443,100 @@ class IndexedFileWriter::IndexedFileWriterImpl : public RingBuffer::DropCallback
 
         IndexedFileWriter::ChunkDroppedCallback* drop_callback = nullptr;
 
+        /**
+         * A file operation of the ring buffer in history mode with a cache. It is applied by the
+         * cache writing thread as soon as the data that preceded it in the cache has been written.
+         */
+        struct HistoryFileOperation
+        {
+            enum Type
+            {
+                hfo_set_file_pos,
+                hfo_truncate,
+                hfo_allocate
+            };
+
+            uint64_t                cache_position;     // the amount of data inserted into the cache before
+            Type                    type;
+            utils5ext::FilePos      file_pos;
+            utils5ext::FileSize     size;               // of the region to allocate
+        };
+        std::mutex                  history_operations_mutex;
+        std::deque<HistoryFileOperation> history_operations;
+        uint64_t                    cache_bytes_inserted;
+        uint64_t                    cache_bytes_written;
+
         std::thread writer_thread;
         std::atomic<bool> keep_writing_cache_to_disk;
         size_t cache_maximum_write_chunk_size;
 
+        // behaviour and statistics of the internal cache
+        bool drop_chunks_if_cache_full;
+        bool fail_if_cache_full;
+        std::atomic<uint64_t> cache_stall_count;
+        std::atomic<timestamp_t> cache_stall_time;
+        std::atomic<int> cache_high_water_mark;
+        std::atomic<uint64_t> dropped_chunks;
+
+        // concurrent write mode (om_concurrent_write)
+        bool concurrent_write;
+        std::mutex chunk_write_mutex;
+        std::mutex producers_mutex;
+        std::vector<std::unique_ptr<IndexedFileWriter::ChunkProducer>> producers;
+        std::thread merge_thread;
+        std::atomic<bool> keep_merging;
+        std::atomic<bool> merge_thread_idle;
+        /// the error the merge thread stopped with, rethrown by close()
+        std::exception_ptr merge_error;
+        std::mutex merge_mutex;
+        std::condition_variable merge_event;
+        bool chunks_queued;
+
+        // chunk reserved by reserveChunk
+        bool reservation_pending;
+        bool reservation_in_cache;
+        bool committing_reservation;
+        uint32_t reservation_size;
+        std::vector<uint8_t> reservation_buffer;
+
+        // compression settings of the streams, see setStreamCompression
+        CompressionCodec            stream_codecs[MAX_INDEXED_STREAMS];
+        int                         stream_compression_levels[MAX_INDEXED_STREAMS];
+        bool                        compressed_chunks_written;
+
+        // index journal (om_index_journal)
+        utils5ext::File             journal;
+        std::string                 journal_file_name;
+        timestamp_t                 journal_interval;
+        std::chrono::steady_clock::time_point journal_last_checkpoint;
+        bool                        journal_checkpoint_written;
+        uint64_t                    journal_index_count;
+        bool                        journal_stream_info_changed[MAX_INDEXED_STREAMS];
+        std::vector<ChunkRef>       journal_entries;
+        /// a checkpoint that waits for the data it covers, see writePendingJournalCheckpoints
+        struct PendingCheckpoint
+        {
+            uint64_t                file_pos;
+            std::vector<uint8_t>    record;
+        };
+        std::mutex                  journal_mutex;
+        std::deque<PendingCheckpoint> journal_pending;
+
+        // published progress (om_publish_progress)
+        utils5ext::File             progress_file;
+        std::string                 progress_file_name;
+        timestamp_t                 progress_interval;
+        std::chrono::steady_clock::time_point progress_deadline;
+        FileProgress                progress;
+
+        // shared memory ring for local consumers, see setLiveTap
+        std::string                 live_tap_name;
+        size_t                      live_tap_size;
+        utils5ext::SharedRingBuffer live_tap;
+
+        /// the maximum amount of master index entries in memory, 0 for no limit
+        size_t                      index_memory_limit;
+
     public:
         explicit IndexedFileWriterImpl(IndexedFileWriter& parent) :
             internal_write_chunk_header{},
@@ -121,20 +548,57 @@ class IndexedFileWriter::IndexedFileWriterImpl : public RingBuffer::DropCallback
             first_time(0),
             first_time_set(false),
             history_size(0),
+            history_preallocated(false),
             wrapping_started(false),
             header{},
             address_begin(0),
             address_end(0),
             history_quitted(false),
+            cache_bytes_inserted(0),
+            cache_bytes_written(0),
             keep_writing_cache_to_disk(true),
+            drop_chunks_if_cache_full(false),
+            fail_if_cache_full(false),
+            cache_stall_count(0),
+            cache_stall_time(0),
+            cache_high_water_mark(0),
+            dropped_chunks(0),
+            concurrent_write(false),
+            keep_merging(false),
+            merge_thread_idle(false),
+            chunks_queued(false),
+            reservation_pending(false),
+            reservation_in_cache(false),
+            committing_reservation(false),
+            reservation_size(0),
+            compressed_chunks_written(false),
+            journal_interval(1000000),
+            journal_checkpoint_written(false),
+            journal_index_count(0),
+            journal_stream_info_changed{},
+            progress_interval(100000),
+            progress{},
+            live_tap_size(0),
+            index_memory_limit(0),
             _p(&parent)
         {
            utils5ext::memZero(&internal_write_chunk_header, sizeof(internal_write_chunk_header));
+           resetStreamCompression();
         }
         virtual ~IndexedFileWriterImpl()
         {
         }
 
+        void resetStreamCompression()
+        {
+            for (int idx = 0; idx < MAX_INDEXED_STREAMS; ++idx)
+            {
+                stream_codecs[idx] = cc_none;
+                stream_compression_levels[idx] = 0;
+            }
+            compressed_chunks_written = false;
+        }
+
         bool CheckEmpty()
         {
             std::lock_guard<a_util::concurrency::recursive_mutex> lck(critical_section);
@@ -275,7 +739,78 @@ class IndexedFileWriter::IndexedFileWriterImpl : public RingBuffer::DropCallback
             return history_time || history_size;
         }
 
+        /**
+         * Applies the file operations of the ring buffer that are due at the current cache position.
+         * @return The amount of data that can be written before the next operation is due.
+         */
+        uint64_t applyHistoryFileOperations()
+        {
+            std::lock_guard<std::mutex> guard(history_operations_mutex);
+            while (!history_operations.empty() &&
+                   history_operations.front().cache_position == cache_bytes_written)
+            {
+                const HistoryFileOperation& operation = history_operations.front();
+                switch (operation.type)
+                {
+                    case HistoryFileOperation::hfo_set_file_pos:
+                        _p->_file.setFilePos(operation.file_pos, utils5ext::File::fp_begin);
+                        break;
+                    case HistoryFileOperation::hfo_truncate:
+                        _p->_file.truncate(operation.file_pos);
+                        break;
+                    case HistoryFileOperation::hfo_allocate:
+                        _p->_file.allocate(operation.file_pos, operation.size);
+                        break;
+                }
+                history_operations.pop_front();
+            }
+
+            if (history_operations.empty())
+            {
+                return std::numeric_limits<uint64_t>::max();
+            }
+
+            return history_operations.front().cache_position - cache_bytes_written;
+        }
+
+        void queueHistoryFileOperation(HistoryFileOperation::Type type,
+                                       utils5ext::FilePos file_pos,
+                                       utils5ext::FileSize size = 0)
+        {
+            {
+                std::lock_guard<std::mutex> guard(history_operations_mutex);
+                history_operations.push_back({cache_bytes_inserted, type, file_pos, size});
+            }
+
+            if (!keep_writing_cache_to_disk && _p->_cache_usage_count == 0)
+            {
+                // the cache writing thread has already been stopped, i.e. by quitHistory() on close
+                applyHistoryFileOperations();
+            }
+        }
+
     public:
+        // the ring buffer writes through the cache if the history is not written synchronously
+        void write(const void* data, size_t data_size)
+        {
+            _p->writeToCache(data, static_cast<int>(data_size));
+        }
+
+        void setFilePos(utils5ext::FilePos file_pos)
+        {
+            queueHistoryFileOperation(HistoryFileOperation::hfo_set_file_pos, file_pos);
+        }
+
+        void truncate(utils5ext::FilePos file_size)
+        {
+            queueHistoryFileOperation(HistoryFileOperation::hfo_truncate, file_size);
+        }
+
+        void allocate(utils5ext::FilePos offset, utils5ext::FileSize size)
+        {
+            queueHistoryFileOperation(HistoryFileOperation::hfo_allocate, offset, size);
+        }
+
         void onDrop(const RingBuffer::Item& dropped_item, const RingBuffer::Item& next_item)
         {
             _p->_index_table.remove(dropped_item.additional.chunk_index,
@@ -299,7 +834,14 @@ IndexedFileWriter::IndexedFileWriter()
 
 IndexedFileWriter::~IndexedFileWriter()
 {
-    close();
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // errors can only be reported by calling close() explicitly
+    }
 }
 
 void IndexedFileWriter::setDateTime(const a_util::datetime::DateTime& date_time)
@@ -329,7 +871,8 @@ void IndexedFileWriter::initialize()
     _file_name           = "";
     _temp_file_name       = "";
 
-    _cond_cache_used_processed = true;
+    _cache_writer_waiting = false;
+    _cache_flusher_waiting = false;
 
     _prefix_of_temp_save_file_name = "~$";
 
@@ -361,8 +904,6 @@ void IndexedFileWriter::create(const std::string& filename,
     _file_name = "";
     _temp_file_name = "";
 
-    _index_table.create(index_delay);
-
     _last_chunk_time = 0;
     _system_cache_disabled = false;
 
@@ -376,6 +917,15 @@ void IndexedFileWriter::create(const std::string& filename,
         _d->check_chunk_header = true;
     }
 
+    _d->concurrent_write = (flags & om_concurrent_write) != 0;
+
+    _d->drop_chunks_if_cache_full = (flags & om_drop_chunks_if_cache_full) != 0;
+    _d->fail_if_cache_full = (flags & om_fail_if_cache_full) != 0;
+    _d->cache_stall_count = 0;
+    _d->cache_stall_time = 0;
+    _d->cache_high_water_mark = 0;
+    _d->dropped_chunks = 0;
+
     if ((flags & om_disable_file_system_cache) != 0)
     {
         _system_cache_disabled = true;
@@ -390,15 +940,44 @@ void IndexedFileWriter::create(const std::string& filename,
         _sector_size = default_block_size;
     }
 
-    // in history mode we do not support a memory cache
+    if ((flags & om_index_journal) != 0 && (history || history_size))
+    {
+        throw std::invalid_argument("the index journal is not supported in history mode");
+    }
+
+    if ((flags & om_preallocate_history) != 0 && history_size == 0)
+    {
+        throw std::invalid_argument("a preallocated history requires a history size");
+    }
+
+    if (_d->index_memory_limit > 0 && (history || history_size))
+    {
+        throw std::invalid_argument("the index memory limit is not supported in history mode");
+    }
+
+    // without a memory cache the history is written synchronously
     if (history || history_size)
     {
-        if (cache_size > 0)
+        if (cache_size == 0)
         {
-            throw std::invalid_argument("internal cache is not supported in history mode");
+            _sync_mode = true;
         }
+        else if (!_sync_mode && _system_cache_disabled)
+        {
+            throw std::invalid_argument("a disabled file system cache is not supported in history mode with a cache");
+        }
+    }
 
-        _sync_mode = true;
+    if ((flags & om_publish_progress) != 0 && ((flags & om_sync_write) != 0 || history || history_size))
+    {
+        throw std::invalid_argument("publishing the progress requires the internal cache and no history");
+    }
+
+    // without the file system cache only whole sectors are written, the rest of the data would
+    // not be published until the next sector is full
+    if ((flags & om_publish_progress) != 0 && (flags & om_disable_file_system_cache) != 0)
+    {
+        throw std::invalid_argument("publishing the progress requires the file system cache");
     }
 
     //no cache is needed for this option
@@ -432,9 +1011,25 @@ void IndexedFileWriter::create(const std::string& filename,
         open_flags |= File::om_write_through | File::om_disable_file_system_cache;
     }
 
+    // the tap is created first, so that a name that is in use leaves no file behind
+    if (!_d->live_tap_name.empty())
+    {
+        _d->live_tap.create(_d->live_tap_name, _d->live_tap_size);
+    }
+
     std::string savename;
-    createAFileWithPrefixdAndAFileWithoutPrefix(filename, savename);
-    _file.open(savename, open_flags);
+    try
+    {
+        createAFileWithPrefixdAndAFileWithoutPrefix(filename, savename);
+        _file.open(savename, open_flags);
+    }
+    catch (...)
+    {
+        _d->live_tap.close();
+        throw;
+    }
+
+    _index_table.create(index_delay, savename + index_spill_file_suffix, _d->index_memory_limit);
 
     allocHeader();
 
@@ -461,6 +1056,17 @@ void IndexedFileWriter::create(const std::string& filename,
 
     writeFileHeader();
 
+    if ((flags & om_publish_progress) != 0)
+    {
+        // the cache writing thread publishes the data it has written from now on
+        _d->cache_bytes_written = 0;
+        _d->progress_file_name = getProgressFileName(savename);
+        _d->progress_file.open(_d->progress_file_name, File::om_write);
+        utils5ext::memZero(&_d->progress, sizeof(_d->progress));
+        _d->progress.data_offset = static_cast<uint64_t>(_file_header->data_offset);
+        publishProgress();
+    }
+
     if (!_sync_mode)
     {
         _d->keep_writing_cache_to_disk = true;
@@ -471,11 +1077,36 @@ void IndexedFileWriter::create(const std::string& filename,
 
     _file_pos_last_chunk = _file_pos;
 
+    if (_d->concurrent_write)
+    {
+        _d->keep_merging = true;
+        _d->merge_thread = std::thread(&IndexedFileWriter::mergeProducerQueues, this);
+    }
+
     if (history || history_size)
     {
-        _d->file_ring_buffer.reset(new RingBuffer(&_file, _file_pos, 0, _d.get()));
+        _d->cache_bytes_inserted = 0;
+        _d->cache_bytes_written = 0;
+        _d->history_operations.clear();
+        if (_sync_mode)
+        {
+            _d->file_ring_buffer.reset(new RingBuffer(&_file, _file_pos, 0, _d.get()));
+        }
+        else
+        {
+            // the cache writing thread applies the file operations of the ring buffer
+            _d->file_ring_buffer.reset(new RingBuffer(static_cast<RingBuffer::FileAccess*>(_d.get()),
+                                                      _file_pos, 0, _d.get()));
+        }
         _d->history_time = history;
         _d->history_size = history_size;
+        _d->history_preallocated = (flags & om_preallocate_history) != 0;
+        if (_d->history_preallocated)
+        {
+            // the history wraps around at exactly its size
+            _d->file_ring_buffer->preallocate(history_size,
+                                              static_cast<size_t>(history_size / expected_history_chunk_size));
+        }
         _d->wrapping_started = false;
         _d->drop_callback = drop_callback;
         //only if the file is recorded with a History Buffer we need to raise the Version ID of the supported file
@@ -491,6 +1122,18 @@ void IndexedFileWriter::create(const std::string& filename,
     _file_header->first_chunk_offset = _file_header->data_offset;
     _file_header->continuous_offset = _file_header->data_offset;
     _file_header->ring_buffer_end_offset = _file_header->data_offset;
+
+    if ((flags & om_index_journal) != 0)
+    {
+        _d->journal_file_name = getIndexJournalFileName(savename);
+        _d->journal.open(_d->journal_file_name, File::om_write);
+        JournalHeader journal_header = {journal_id, journal_version, index_delay};
+        _d->journal.writeAll(&journal_header, sizeof(journal_header));
+        _d->journal_checkpoint_written = false;
+        _d->journal_index_count = 0;
+        _d->journal_pending.clear();
+        std::fill(std::begin(_d->journal_stream_info_changed), std::end(_d->journal_stream_info_changed), false);
+    }
 }
 
 /*
@@ -551,6 +1194,12 @@ void IndexedFileWriter::allocCache(int size)
 
 void IndexedFileWriter::close()
 {
+    stopMerging();
+
+    // chunks queued by the producers have been lost, the file is completed nevertheless
+    std::exception_ptr merge_error;
+    std::swap(merge_error, _d->merge_error);
+
     if (_is_open)
     {
         _write_guid = false;
@@ -569,16 +1218,49 @@ void IndexedFileWriter::close()
 
         _file_header->chunk_count -= _index_table.getIndexOffset(0);
 
+        if (_d->compressed_chunks_written)
+        {
+            // readers that do not know about compressed chunks have to reject the file
+            if (_file_header->version_id == v400::version_id)
+            {
+                _file_header->version_id = v400::version_id_with_compression;
+            }
+            else if (_file_header->version_id == v500::version_id)
+            {
+                _file_header->version_id = v500::version_id_with_compression;
+            }
+        }
+
         writeIndexTable();                    // copy index table to header extension
         writeFileHeaderExt();                 // write header extension to disk
         writeFileHeader();                    // fill values to file header
 
         _write_guid = false;
+
+        if (_d->journal.isValid())
+        {
+            // the file is complete, the journal is not needed anymore
+            _d->journal.close();
+            a_util::filesystem::remove(_d->journal_file_name);
+        }
+
+        if (_d->progress_file.isValid())
+        {
+            // followers find the complete header from now on
+            _d->progress_file.close();
+            a_util::filesystem::remove(_d->progress_file_name);
+        }
     }
 
+    _d->live_tap.close();
+
     _index_table.free();
 
     _d->check_chunk_header = false;
+    _d->resetStreamCompression();
+
+    _d->producers.clear();
+    _d->concurrent_write = false;
 
     for (int idx = 0;
          idx < MAX_INDEXED_STREAMS;
@@ -601,6 +1283,11 @@ void IndexedFileWriter::close()
     {
          renameTempSaveToFileName();
     }
+
+    if (merge_error)
+    {
+        std::rethrow_exception(merge_error);
+    }
 }
 
 void IndexedFileWriter::stopAndFlushCache()
@@ -609,33 +1296,585 @@ void IndexedFileWriter::stopAndFlushCache()
     {
         if (_d->keep_writing_cache_to_disk)
         {
-            _d->keep_writing_cache_to_disk = false;
             {
-                std::lock_guard<std::mutex> guard(_mutex_cache_used);
-                _cond_cache_used_processed = false;
+                std::lock_guard<std::mutex> guard(_mutex_cache_event);
+                _d->keep_writing_cache_to_disk = false;
             }
             _cond_cache_used.notify_all();
             _d->writer_thread.join();
         }
     }
 
-    storeToDisk(true);
+    // in history mode the data is written up to the next file operation of the ring buffer
+    do
+    {
+        storeToDisk(true);
+    }
+    while (_cache_usage_count > 0);
 }
 
+void IndexedFileWriter::setIndexMemoryLimit(size_t max_entries)
+{
+    _d->index_memory_limit = max_entries;
+}
 
-/*
-* Rename the TempFile Name '~$FileName.dat' back to
-* 'FileName.dat' Filename
-*/
-void IndexedFileWriter::renameTempSaveToFileName()
+void IndexedFileWriter::setIndexJournalInterval(timestamp_t interval)
 {
-    using namespace utils5ext;
-    // Delete Real File
-    if (a_util::filesystem::exists(_file_name))
-    {
-        File file;
-        file.open(_file_name, File::om_read);
-        FileSize file_size = file.getSize();
+    _d->journal_interval = interval;
+}
+
+std::string IndexedFileWriter::getIndexJournalFileName(const std::string& filename)
+{
+    return filename + ".ifhd_journal";
+}
+
+void IndexedFileWriter::setProgressInterval(timestamp_t interval)
+{
+    _d->progress_interval = interval;
+}
+
+std::string IndexedFileWriter::getProgressFileName(const std::string& filename)
+{
+    return filename + ".ifhd_progress";
+}
+
+std::string IndexedFileWriter::getBackupFileName(const std::string& filename)
+{
+    return filename + ".bak";
+}
+
+void IndexedFileWriter::setLiveTap(const std::string& name, size_t size)
+{
+    _d->live_tap_name = name;
+    _d->live_tap_size = size;
+}
+
+void IndexedFileWriter::publishToLiveTap(const void* data, uint32_t data_size)
+{
+    utils5ext::SharedRingBuffer::Piece pieces[3] = {
+        { &_d->internal_write_chunk_header, sizeof(_d->internal_write_chunk_header) },
+        { data, data_size },
+        { nullptr, 0 } };
+
+    if (_d->committing_reservation)
+    {
+        // the payload is located behind the header in the cache and might wrap around
+        const uint8_t* cache_addr = static_cast<const uint8_t*>(getCacheAddr());
+        const uint64_t payload_pos = (_cache_insert_ptr + sizeof(ChunkHeader)) % _cache_size;
+        const uint32_t first_part = static_cast<uint32_t>(std::min<uint64_t>(data_size, _cache_size - payload_pos));
+        pieces[1].data = cache_addr + payload_pos;
+        pieces[1].size = first_part;
+        pieces[2].data = cache_addr;
+        pieces[2].size = data_size - first_part;
+    }
+
+    _d->live_tap.push(pieces, 3);
+}
+
+void IndexedFileWriter::publishProgress()
+{
+    FileProgress& progress = _d->progress;
+    progress.progress_id = getFileProgressId();
+    ++progress.sequence;
+    progress.data_end = progress.data_offset + _d->cache_bytes_written;
+    progress.checksum = getFileProgressChecksum(progress);
+
+    // a single small write, readers that see it partially reject it by its checksum
+    _d->progress_file.setFilePos(0, utils5ext::File::fp_begin);
+    _d->progress_file.writeAll(&progress, sizeof(progress));
+
+    _d->progress_deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(_d->progress_interval);
+}
+
+void IndexedFileWriter::writeJournalCheckpoint()
+{
+    _index_table.copyMasterEntries(_d->journal_index_count, _d->journal_entries);
+
+    JournalCheckpoint checkpoint;
+    utils5ext::memZero(&checkpoint, sizeof(checkpoint));
+    checkpoint.checkpoint_id = journal_checkpoint_id;
+    checkpoint.flags = _d->compressed_chunks_written ? journal_compressed_chunks : 0;
+    checkpoint.index_entry_count = static_cast<uint32_t>(_d->journal_entries.size());
+    checkpoint.file_pos = _file_pos;
+    checkpoint.file_pos_last_chunk = _file_pos_last_chunk;
+    checkpoint.last_chunk_time = _last_chunk_time;
+    checkpoint.time_offset = _time_offset;
+    checkpoint.file_header = *_file_header;
+
+    std::vector<uint8_t> record(sizeof(checkpoint));
+    appendToRecord(record, _d->journal_entries.data(), _d->journal_entries.size());
+
+    for (uint16_t stream_id = 1; stream_id <= MAX_INDEXED_STREAMS; ++stream_id)
+    {
+        const StreamInfoHeader& stream_info = _stream_info[stream_id - 1];
+        bool& changed = _d->journal_stream_info_changed[stream_id - 1];
+        if (stream_info.stream_index_count == 0 && stream_info.stream_name[0] == 0 && !changed)
+        {
+            continue;
+        }
+
+        JournalStreamInfo journal_stream_info;
+        journal_stream_info.stream_id = stream_id;
+        journal_stream_info.has_info_data = changed && stream_info.info_data_size > 0 &&
+                                            _stream_info_add[stream_id - 1].data != nullptr;
+        journal_stream_info.stream_info = stream_info;
+        appendToRecord(record, &journal_stream_info);
+        if (journal_stream_info.has_info_data)
+        {
+            appendToRecord(record, _stream_info_add[stream_id - 1].data, stream_info.info_data_size);
+        }
+
+        changed = false;
+        ++checkpoint.stream_count;
+    }
+
+    checkpoint.record_size = static_cast<uint32_t>(record.size());
+    a_util::memory::copy(record.data(), sizeof(checkpoint), &checkpoint, sizeof(checkpoint));
+    checkpoint.checksum = getJournalChecksum(record.data(), record.size());
+    a_util::memory::copy(record.data(), sizeof(checkpoint), &checkpoint, sizeof(checkpoint));
+
+    if (_sync_mode)
+    {
+        _d->journal.writeAll(record.data(), record.size());
+        _d->journal.syncData();
+    }
+    else
+    {
+        // the cache writing thread writes the checkpoint as soon as the data it covers is on disk
+        std::lock_guard<std::mutex> guard(_d->journal_mutex);
+        _d->journal_pending.push_back({checkpoint.file_pos, std::move(record)});
+    }
+
+    _d->journal_index_count += _d->journal_entries.size();
+    _d->journal_last_checkpoint = std::chrono::steady_clock::now();
+    _d->journal_checkpoint_written = true;
+}
+
+void IndexedFileWriter::writePendingJournalCheckpoints()
+{
+    const uint64_t data_on_disk = static_cast<uint64_t>(_file.getFilePos());
+    bool checkpoint_written = false;
+    for (;;)
+    {
+        std::vector<uint8_t> record;
+        {
+            std::lock_guard<std::mutex> guard(_d->journal_mutex);
+            if (_d->journal_pending.empty() || _d->journal_pending.front().file_pos > data_on_disk)
+            {
+                break;
+            }
+            record = std::move(_d->journal_pending.front().record);
+            _d->journal_pending.pop_front();
+        }
+
+        _d->journal.writeAll(record.data(), record.size());
+        checkpoint_written = true;
+    }
+
+    if (checkpoint_written)
+    {
+        _d->journal.syncData();
+    }
+}
+
+void IndexedFileWriter::appendRecoveredChunk(const ChunkHeader& header, uint64_t uncompressed_size)
+{
+    uint16_t stream_id = header.stream_id;
+    uint32_t whole_chunk = (header.size + 0xF) & ~0xF;
+
+    if (_file_header->chunk_count == 0)
+    {
+        _time_offset = header.time_stamp;
+    }
+
+    StreamInfoHeader& stream_info = _stream_info[stream_id - 1];
+    if (stream_info.stream_index_count == 0)
+    {
+        stream_info.stream_first_time = header.time_stamp;
+    }
+    stream_info.stream_last_time = header.time_stamp;
+
+    bool index_entry_appended;
+    _index_table.append(stream_id,
+                        stream_info.stream_index_count,
+                        _file_header->chunk_count,
+                        _file_pos,
+                        header.size,
+                        header.time_stamp,
+                        header.flags,
+                        index_entry_appended);
+
+    if ((header.flags & ct_compressed) != 0)
+    {
+        _d->compressed_chunks_written = true;
+    }
+
+    if (uncompressed_size > _file_header->max_chunk_size)
+    {
+        _file_header->max_chunk_size = uncompressed_size;
+    }
+
+    _last_chunk_time = header.time_stamp;
+    _file_header->chunk_count++;
+    _file_header->data_size += whole_chunk;
+    _file_pos_last_chunk = _file_pos;
+    _file_pos += whole_chunk;
+    stream_info.stream_index_count++;
+}
+
+void IndexedFileWriter::recover(const std::string& filename)
+{
+    using namespace utils5ext;
+
+    close();
+
+    std::string journal_file_name = getIndexJournalFileName(filename);
+    if (!a_util::filesystem::exists(journal_file_name))
+    {
+        throw std::runtime_error("there is no index journal for " + filename);
+    }
+
+    std::vector<uint8_t> journal_data;
+    {
+        File journal;
+        journal.open(journal_file_name, File::om_read);
+        journal_data.resize(static_cast<size_t>(journal.getSize()));
+        if (!journal_data.empty())
+        {
+            journal.readAll(journal_data.data(), journal_data.size());
+        }
+    }
+
+    JournalHeader journal_header;
+    if (journal_data.size() < sizeof(journal_header))
+    {
+        throw std::runtime_error("invalid index journal");
+    }
+    a_util::memory::copy(&journal_header, sizeof(journal_header), journal_data.data(), sizeof(journal_header));
+    if (journal_header.journal_id != journal_id || journal_header.journal_version != journal_version)
+    {
+        throw std::runtime_error("invalid index journal");
+    }
+
+    beginRecovery(filename, journal_header.index_delay);
+    FileSize file_size = _file.getSize();
+
+    // apply all checkpoints whose data is on disk, the entries of a checkpoint extend the previous ones
+    bool checkpoint_applied = false;
+    size_t record_offset = sizeof(journal_header);
+    while (record_offset + sizeof(JournalCheckpoint) <= journal_data.size())
+    {
+        uint8_t* record = journal_data.data() + record_offset;
+        JournalCheckpoint checkpoint;
+        a_util::memory::copy(&checkpoint, sizeof(checkpoint), record, sizeof(checkpoint));
+        if (checkpoint.checkpoint_id != journal_checkpoint_id ||
+            checkpoint.record_size < sizeof(checkpoint) ||
+            checkpoint.record_size > journal_data.size() - record_offset)
+        {
+            break;
+        }
+
+        uint32_t checksum = checkpoint.checksum;
+        utils5ext::memZero(record + offsetof(JournalCheckpoint, checksum), sizeof(checksum));
+        if (getJournalChecksum(record, checkpoint.record_size) != checksum ||
+            checkpoint.file_pos > static_cast<uint64_t>(file_size))
+        {
+            break;
+        }
+
+        // the last chunk of the checkpoint has to be on disk
+        if (checkpoint.file_header.chunk_count > 0)
+        {
+            ChunkHeader last_chunk;
+            _file.setFilePos(checkpoint.file_pos_last_chunk, File::fp_begin);
+            if (_file.read(&last_chunk, sizeof(last_chunk)) != sizeof(last_chunk) ||
+                last_chunk.time_stamp != static_cast<uint64_t>(checkpoint.last_chunk_time) ||
+                checkpoint.file_pos_last_chunk + last_chunk.size > checkpoint.file_pos)
+            {
+                break;
+            }
+        }
+
+        *_file_header = checkpoint.file_header;
+        _file_pos = checkpoint.file_pos;
+        _file_pos_last_chunk = checkpoint.file_pos_last_chunk;
+        _last_chunk_time = checkpoint.last_chunk_time;
+        _time_offset = checkpoint.time_offset;
+        _d->compressed_chunks_written = (checkpoint.flags & journal_compressed_chunks) != 0;
+
+        const uint8_t* entry_data = record + sizeof(checkpoint);
+        for (uint32_t entry_index = 0; entry_index < checkpoint.index_entry_count; ++entry_index)
+        {
+            ChunkRef entry;
+            a_util::memory::copy(&entry, sizeof(entry), entry_data, sizeof(entry));
+            entry_data += sizeof(entry);
+
+            bool index_entry_appended;
+            _index_table.append(entry.stream_id, entry.stream_index, entry.chunk_index, entry.chunk_offset,
+                                entry.size, entry.time_stamp, entry.flags, index_entry_appended);
+        }
+
+        for (uint32_t stream_index = 0; stream_index < checkpoint.stream_count; ++stream_index)
+        {
+            JournalStreamInfo journal_stream_info;
+            a_util::memory::copy(&journal_stream_info, sizeof(journal_stream_info), entry_data, sizeof(journal_stream_info));
+            entry_data += sizeof(journal_stream_info);
+            if (journal_stream_info.stream_id == 0 || journal_stream_info.stream_id > MAX_INDEXED_STREAMS)
+            {
+                throw std::runtime_error("invalid index journal");
+            }
+
+            uint16_t stream_id = journal_stream_info.stream_id;
+            _stream_info[stream_id - 1] = journal_stream_info.stream_info;
+            if (journal_stream_info.has_info_data)
+            {
+                setAdditionalStreamInfo(stream_id, entry_data, journal_stream_info.stream_info.info_data_size);
+                entry_data += journal_stream_info.stream_info.info_data_size;
+            }
+        }
+
+        checkpoint_applied = true;
+        record_offset += checkpoint.record_size;
+    }
+
+    if (!checkpoint_applied)
+    {
+        _file.close();
+        throw std::runtime_error("the index journal does not contain a checkpoint of data on disk");
+    }
+
+    // scan the chunks that have been written after the last checkpoint
+    for (;;)
+    {
+        ChunkHeader header;
+        _file.setFilePos(_file_pos, File::fp_begin);
+        if (_file.read(&header, sizeof(header)) != sizeof(header) ||
+            header.size < sizeof(header) ||
+            _file_pos + header.size > static_cast<uint64_t>(file_size) ||
+            header.stream_id == 0 || header.stream_id > MAX_INDEXED_STREAMS ||
+            !isNextRecoveredChunk(header) ||
+            header.ref_master_table_index != static_cast<uint64_t>(_index_table.getItemCount(0)))
+        {
+            break;
+        }
+
+        uint64_t uncompressed_size = header.size;
+        if ((header.flags & ct_compressed) != 0)
+        {
+            CompressedChunkHeader compressed_header;
+            if (_file.read(&compressed_header, sizeof(compressed_header)) != sizeof(compressed_header))
+            {
+                break;
+            }
+            uncompressed_size = getUncompressedChunkDataSize(*_file_header, &compressed_header, sizeof(compressed_header)) +
+                                sizeof(ChunkHeader);
+        }
+
+        appendRecoveredChunk(header, uncompressed_size);
+    }
+
+    finishRecovery(filename);
+
+    a_util::filesystem::remove(journal_file_name);
+}
+
+void IndexedFileWriter::repair(const std::string& filename, size_t thread_count, timestamp_t index_delay)
+{
+    close();
+
+    FileHeader file_header;
+    getHeader(filename, file_header);
+    if (file_header.header_byte_order != PLATFORM_BYTEORDER_UINT8)
+    {
+        throw std::runtime_error("only files with the byte order of the platform can be repaired");
+    }
+    if (file_header.first_chunk_offset != file_header.data_offset)
+    {
+        throw std::runtime_error("files with a history can not be repaired");
+    }
+
+    beginRecovery(filename, index_delay);
+    const uint64_t file_size = static_cast<uint64_t>(_file.getSize());
+
+    // the data offset is only stored when the file is closed, the first chunk follows the header
+    const bool data_offset_known = file_header.data_offset != 0;
+    if (!data_offset_known)
+    {
+        file_header.data_offset = sizeof(FileHeader);
+    }
+    _file_pos = file_header.data_offset;
+
+    // every thread searches a range of the data area, the ranges are small enough to keep all threads
+    // busy but large enough that the threads do not compete for the same blocks of the disk
+    if (thread_count == 0)
+    {
+        thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    const uint64_t data_area_size = file_size > _file_pos ? file_size - _file_pos : 0;
+    const uint64_t range_count =
+        std::max<uint64_t>(std::min<uint64_t>(thread_count, data_area_size / repair_minimum_range_size), 1);
+    const uint64_t range_size = ((data_area_size + range_count - 1) / range_count + 0xF) & ~uint64_t(0xF);
+
+    // the candidates are passed on in bounded queues, a thread waits until the chunks have been
+    // followed up to its range if it is too far ahead
+    std::deque<ChunkCandidateQueue> queues;
+    std::vector<std::future<void>> ranges;
+    struct CancelSearch
+    {
+        std::deque<ChunkCandidateQueue>& queues;
+        ~CancelSearch()
+        {
+            for (auto& queue: queues)
+            {
+                queue.cancel();
+            }
+        }
+    } cancel_search{queues};
+
+    for (uint64_t range_begin = _file_pos; range_begin < file_size; range_begin += range_size)
+    {
+        // the threads get a copy of the header, the data offset is changed while they search
+        queues.emplace_back();
+        ranges.push_back(std::async(std::launch::async, findChunkCandidates, filename, file_header,
+                                    range_begin, std::min(range_begin + range_size, file_size), file_size,
+                                    std::ref(queues.back())));
+    }
+
+    // the candidates of all ranges in the order of their position
+    auto queue = queues.begin();
+    ChunkCandidate candidate;
+    auto next_candidate = [&]() -> bool
+    {
+        for (; queue != queues.end(); ++queue)
+        {
+            if (queue->pop(candidate))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    bool candidate_found = next_candidate();
+    if (!data_offset_known)
+    {
+        while (candidate_found &&
+               (candidate.header.offset_to_last != 0 || candidate.header.stream_index != 0))
+        {
+            candidate_found = next_candidate();
+        }
+        if (candidate_found)
+        {
+            file_header.data_offset = candidate.file_pos;
+        }
+    }
+
+    *_file_header = file_header;
+    _file_header->extension_count = 0;
+    _file_header->extension_offset = 0;
+    _file_header->data_size = 0;
+    _file_header->chunk_count = 0;
+    _file_header->max_chunk_size = 0;
+    _file_header->duration = 0;
+    _file_header->first_chunk_offset = _file_header->data_offset;
+    _file_header->continuous_offset = _file_header->data_offset;
+    _file_header->ring_buffer_end_offset = _file_header->data_offset;
+    _file_pos = _file_header->data_offset;
+    _file_pos_last_chunk = _file_pos;
+
+    // follow the chunks from the beginning of the data area, the source positions are the positions
+    // before the chunks behind a damaged area have been moved
+    uint64_t source_pos = _file_pos;
+    uint64_t source_pos_last_chunk = _file_pos;
+    std::vector<uint64_t> source_stream_index_count(MAX_INDEXED_STREAMS, 0);
+    bool moving_chunks = false;
+    for (; candidate_found; candidate_found = next_candidate())
+    {
+        const ChunkHeader& source_header = candidate.header;
+        const uint64_t expected_stream_index = source_stream_index_count[source_header.stream_id - 1];
+        if (candidate.file_pos < source_pos ||
+            source_header.stream_index < expected_stream_index)
+        {
+            continue;
+        }
+
+        const bool next_chunk = candidate.file_pos == source_pos &&
+                                source_header.offset_to_last == source_pos - source_pos_last_chunk &&
+                                (source_header.stream_index == expected_stream_index || moving_chunks);
+        if (!next_chunk)
+        {
+            // the chunk at the source position is damaged, continue with the next chunk of the file
+            if (!isFollowedByChunk(_file, candidate, file_size))
+            {
+                continue;
+            }
+            moving_chunks = true;
+        }
+
+        ChunkHeader header = source_header;
+        if (moving_chunks)
+        {
+            header.offset_to_last = static_cast<uint32_t>(_file_pos - _file_pos_last_chunk);
+            header.stream_index = _stream_info[header.stream_id - 1].stream_index_count;
+            header.ref_master_table_index = static_cast<uint32_t>(_index_table.getItemCount(0));
+            moveChunk(_file, candidate.file_pos, _file_pos, header);
+        }
+
+        source_pos_last_chunk = candidate.file_pos;
+        source_pos = candidate.file_pos + ((source_header.size + 0xF) & ~uint64_t(0xF));
+        source_stream_index_count[source_header.stream_id - 1] = source_header.stream_index + 1;
+        appendRecoveredChunk(header, candidate.uncompressed_size);
+    }
+
+    finishRecovery(filename);
+}
+
+void IndexedFileWriter::beginRecovery(const std::string& filename, timestamp_t index_delay)
+{
+    // the file is modified in place, the copy keeps the data if restoring the index goes wrong
+    copyFile(filename, getBackupFileName(filename));
+    _file.open(filename, utils5ext::File::om_read_write);
+
+    allocHeader();
+    _index_table.create(index_delay, filename + index_spill_file_suffix, _d->index_memory_limit);
+    _last_chunk_time = 0;
+    _time_offset = 0;
+    _system_cache_disabled = false;
+    _sync_mode = true;
+}
+
+bool IndexedFileWriter::isNextRecoveredChunk(const ChunkHeader& header) const
+{
+    return header.stream_index == _stream_info[header.stream_id - 1].stream_index_count &&
+           header.offset_to_last == _file_pos - _file_pos_last_chunk;
+}
+
+void IndexedFileWriter::finishRecovery(const std::string& filename)
+{
+    // everything behind the last complete chunk is replaced by the index
+    _file.truncate(_file_pos);
+    _file.setFilePos(_file_pos, utils5ext::File::fp_begin);
+    _file_name = filename;
+    _use_prefix_temp_file_extension = false;
+    _is_open = true;
+
+    close();
+}
+
+
+/*
+* Rename the TempFile Name '~$FileName.dat' back to
+* 'FileName.dat' Filename
+*/
+void IndexedFileWriter::renameTempSaveToFileName()
+{
+    using namespace utils5ext;
+    // Delete Real File
+    if (a_util::filesystem::exists(_file_name))
+    {
+        File file;
+        file.open(_file_name, File::om_read);
+        FileSize file_size = file.getSize();
         file.close();
 
         // delete only if the filesize is 0 (empty)
@@ -807,6 +2046,109 @@ void IndexedFileWriter::writeFileHeaderExt()
     internalFree(temp_table_buffer);
 }
 
+class IndexedFileWriter::IndexExtensionWriter
+{
+    public:
+        explicit IndexExtensionWriter(IndexedFileWriter& writer):
+            _writer(writer),
+            _block_size(static_cast<size_t>((index_write_block_size + writer._sector_size - 1) /
+                                            writer._sector_size * writer._sector_size)),
+            _block(static_cast<uint8_t*>(writer.internalMalloc(_block_size, true))),
+            _block_usage(0),
+            _file_pos(static_cast<uint64_t>(writer._file.getFilePos()))
+        {
+        }
+
+        ~IndexExtensionWriter()
+        {
+            _writer.internalFree(_block);
+        }
+
+        /// @return The file position of the data that is written next
+        uint64_t getFilePos() const
+        {
+            return _file_pos;
+        }
+
+        void write(const void* data, size_t data_size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            while (data_size > 0)
+            {
+                const size_t count = std::min(data_size, _block_size - _block_usage);
+                if (bytes != nullptr)
+                {
+                    a_util::memory::copy(_block + _block_usage, count, bytes, count);
+                    bytes += count;
+                }
+                else
+                {
+                    utils5ext::memZero(_block + _block_usage, count);
+                }
+
+                _block_usage += count;
+                _file_pos += count;
+                data_size -= count;
+
+                if (_block_usage == _block_size)
+                {
+                    // full blocks are a multiple of the sector size and are written without padding
+                    flush();
+                }
+            }
+        }
+
+        void writeIndexEntries(uint16_t stream_id)
+        {
+            const uint64_t entry_count = _writer._index_table.getItemCount(stream_id);
+            const size_t piece_size = 4096;
+            for (uint64_t first_entry = 0; first_entry < entry_count; first_entry += piece_size)
+            {
+                const uint64_t count = std::min<uint64_t>(piece_size, entry_count - first_entry);
+                if (stream_id == 0)
+                {
+                    _master_entries.resize(static_cast<size_t>(count));
+                    _writer._index_table.copyMasterEntries(first_entry, count, _master_entries.data());
+                    write(_master_entries.data(), _master_entries.size() * sizeof(ChunkRef));
+                }
+                else
+                {
+                    _stream_entries.resize(static_cast<size_t>(count));
+                    _writer._index_table.copyStreamEntries(stream_id, first_entry, count, _stream_entries.data());
+                    write(_stream_entries.data(), _stream_entries.size() * sizeof(StreamRef));
+                }
+            }
+        }
+
+        /// Without the file system cache every extension starts at a sector, like the ones with a data page
+        void finishExtension()
+        {
+            if (_writer._system_cache_disabled)
+            {
+                const uint64_t sector_size = static_cast<uint64_t>(_writer._sector_size);
+                write(nullptr, static_cast<size_t>((sector_size - _file_pos % sector_size) % sector_size));
+            }
+        }
+
+        void flush()
+        {
+            if (_block_usage > 0)
+            {
+                _writer.internalWrite(_block, _block_usage, true);
+                _block_usage = 0;
+            }
+        }
+
+    private:
+        IndexedFileWriter& _writer;
+        const size_t _block_size;
+        uint8_t* _block;
+        size_t _block_usage;
+        uint64_t _file_pos;
+        std::vector<ChunkRef> _master_entries;
+        std::vector<StreamRef> _stream_entries;
+};
+
 void IndexedFileWriter::writeIndexTable()
 {
     uint16_t max_stream_id = (uint16_t) _index_table.getMaxStreamId();
@@ -858,6 +2200,15 @@ void IndexedFileWriter::writeIndexTable()
 
     char extension_name[512];
 
+    // without history the index is written to disk directly, so it does not need to fit into
+    // memory once more, writeFileHeaderExt keeps the position of extensions without data page
+    const bool write_directly = !_d->InHistoryMode();
+    std::unique_ptr<IndexExtensionWriter> index_writer;
+    if (write_directly)
+    {
+        index_writer.reset(new IndexExtensionWriter(*this));
+    }
+
     //There are 511 Stream possible (1 - 511)
     //512 is reserved for markers
     for (uint16_t stream_id=0; stream_id<=max_stream_id; stream_id++)
@@ -867,24 +2218,47 @@ void IndexedFileWriter::writeIndexTable()
 
         FileExtension* extension_info = nullptr;
         void*          extension_data  = nullptr;
-        if (stream_id == 0)
+        if (stream_id != 0 && _stream_info[stream_id - 1].stream_name[0] == 0)
+        {
+            continue;
+        }
+
+        StreamInfoHeader stream_info;
+        if (stream_id != 0)
+        {
+            //writes the streamindex table of the corresponding stream to the table
+            //+ Additional StreamInfo of the stream (will be generated by cADTFFile or HDRecorder)
+            index_table += sizeof(StreamInfoHeader) + _stream_info[stream_id - 1].info_data_size;
+            stream_info = _stream_info[stream_id - 1];
+            stream_info.stream_index_count -= _index_table.getIndexOffset(stream_id);
+        }
+
+        if (write_directly)
         {
-            //writes the masterindex table to the extensions
             appendExtension(extension_name,
                             nullptr,
-                            (int) index_table,
+                            0,
                             0x0,
                             0x0,
                             stream_id,
                             0x0);
             findExtension(extension_name, &extension_info, &extension_data);
-            _index_table.copyToBuffer(stream_id, extension_data);
+            extension_info->data_pos = index_writer->getFilePos();
+            extension_info->data_size = index_table;
+
+            if (stream_id != 0)
+            {
+                index_writer->write(&stream_info, sizeof(StreamInfoHeader));
+                if (stream_info.info_data_size > 0)
+                {
+                    index_writer->write(_stream_info_add[stream_id - 1].data, stream_info.info_data_size);
+                }
+            }
+            index_writer->writeIndexEntries(stream_id);
+            index_writer->finishExtension();
         }
-        else if (_stream_info[stream_id - 1].stream_name[0] != 0)
+        else
         {
-            //writes the streamindex table of the corresponding stream to the table
-            //+ Additional StreamInfo of the stream (will be generated by cADTFFile or HDRecorder)
-            index_table += sizeof(StreamInfoHeader) + _stream_info[stream_id - 1].info_data_size;
             appendExtension(extension_name,
                             nullptr,
                             (int) index_table,
@@ -893,60 +2267,240 @@ void IndexedFileWriter::writeIndexTable()
                             stream_id,
                             0x0);
             findExtension(extension_name, &extension_info, &extension_data);
-            a_util::memory::copy(extension_data, sizeof(StreamInfoHeader), &_stream_info[stream_id - 1], sizeof(StreamInfoHeader));
-            static_cast<StreamInfoHeader*>(extension_data)->stream_index_count -= _index_table.getIndexOffset(stream_id);
-            extension_data = (void*) (((uint8_t*)extension_data) + sizeof(StreamInfoHeader));
-            if (_stream_info[stream_id - 1].info_data_size > 0)
+            if (stream_id != 0)
             {
-                a_util::memory::copy(extension_data, _stream_info[stream_id - 1].info_data_size, _stream_info_add[stream_id - 1].data, _stream_info[stream_id - 1].info_data_size);
-                extension_data = (void*) (((uint8_t*)extension_data) + _stream_info[stream_id - 1].info_data_size);
+                a_util::memory::copy(extension_data, sizeof(StreamInfoHeader), &stream_info, sizeof(StreamInfoHeader));
+                extension_data = (void*) (((uint8_t*)extension_data) + sizeof(StreamInfoHeader));
+                if (stream_info.info_data_size > 0)
+                {
+                    a_util::memory::copy(extension_data, stream_info.info_data_size, _stream_info_add[stream_id - 1].data, stream_info.info_data_size);
+                    extension_data = (void*) (((uint8_t*)extension_data) + stream_info.info_data_size);
+                }
             }
             _index_table.copyToBuffer(stream_id, extension_data);
+        }
 
+        //Writes Additional Entries for offsets (if used History Mode of the Writer the file has new layout)
+        AdditionalIndexInfo info;
+        info.stream_index_offset = _index_table.getIndexOffset(stream_id);
+        info.stream_table_index_offset =
+            static_cast<uint32_t>(_index_table.getIndexTableOffset(stream_id));
+        sprintf(extension_name, "%s%d", IDX_EXT_INDEX_ADDITONAL, (int) stream_id);
+        appendExtension(extension_name,
+                        &info,
+                        sizeof(info),
+                        0x0,
+                        0x0,
+                        stream_id,
+                        0x0);
+    }
+
+    if (index_writer)
+    {
+        index_writer->flush();
+    }
+}
+
+void IndexedFileWriter::writeChunk(uint16_t stream_id,
+                                       const void* data,
+                                       uint32_t data_size,
+                                       timestamp_t time_stamp,
+                                       uint32_t flags)
+{
+    bool index_appended = true;
+    return writeChunk(stream_id,
+                      data,
+                      data_size,
+                      time_stamp,
+                      flags,
+                      index_appended);
+}
 
-        }
 
-        if (stream_id == 0 || _stream_info[stream_id - 1].stream_name[0] != 0)
+void IndexedFileWriter::writeChunk(uint16_t stream_id,
+                                       const void* data,
+                                       uint32_t data_size,
+                                       timestamp_t time_stamp,
+                                       uint32_t flags,
+                                       bool& index_entry_appended)
+{
+    if ((flags & ct_compressed) != 0)
+    {
+        throw std::invalid_argument("the chunk flag ct_compressed is reserved");
+    }
+
+    // compress before locking, so that concurrent writers compress in parallel
+    compressChunk(stream_id, data, data_size, flags);
+
+    if (_d->concurrent_write)
+    {
+        std::lock_guard<std::mutex> lock(_d->chunk_write_mutex);
+        return appendChunk(stream_id, data, data_size, time_stamp, flags, index_entry_appended);
+    }
+
+    return appendChunk(stream_id, data, data_size, time_stamp, flags, index_entry_appended);
+}
+
+void IndexedFileWriter::setStreamCompression(uint16_t stream_id, CompressionCodec codec, int level)
+{
+    if (!_is_open)
+    {
+        throw std::runtime_error("file not opened");
+    }
+    if (stream_id == 0 || stream_id > MAX_INDEXED_STREAMS)
+    {
+        throw std::invalid_argument("invalid stream id");
+    }
+    if (codec != cc_none && !isCompressionCodecAvailable(codec))
+    {
+        throw std::invalid_argument("compression codec not available");
+    }
+    if (codec != cc_none && _file_header->version_id < v400::version_id)
+    {
+        throw std::invalid_argument("compressed chunks require at least file version 4.0");
+    }
+
+    _d->stream_codecs[stream_id - 1] = codec;
+    _d->stream_compression_levels[stream_id - 1] = level;
+}
+
+void IndexedFileWriter::compressChunk(uint16_t stream_id,
+                                      const void*& data,
+                                      uint32_t& data_size,
+                                      uint32_t& flags) const
+{
+    if (stream_id == 0 || stream_id > MAX_INDEXED_STREAMS ||
+        _d->stream_codecs[stream_id - 1] == cc_none)
+    {
+        return;
+    }
+
+    // chunks that do not get smaller are stored uncompressed
+    if (compressChunkData(_d->stream_codecs[stream_id - 1],
+                          _d->stream_compression_levels[stream_id - 1],
+                          data, data_size, compression_buffer))
+    {
+        data = compression_buffer.data();
+        data_size = static_cast<uint32_t>(compression_buffer.size());
+        flags |= ct_compressed;
+    }
+}
+
+void IndexedFileWriter::reserveChunk(uint32_t data_size, ChunkReservation& reservation)
+{
+    if (!_is_open)
+    {
+        throw std::runtime_error("file not opened");
+    }
+
+    const uint64_t whole_chunk = (static_cast<uint64_t>(data_size) + sizeof(ChunkHeader) + 0xF) & ~0xFULL;
+
+    // the payload can only be placed in the cache if no one else writes to it in the meantime and
+    // if the cache writing thread is able to free enough space while we wait
+    _d->reservation_in_cache = !_sync_mode &&
+                               !_d->InHistoryMode() &&
+                               !_d->concurrent_write &&
+                               !_d->check_chunk_header &&
+                               _cache_size > static_cast<uint64_t>(_cache_min_store_at_once) &&
+                               whole_chunk <= _cache_size - _cache_min_store_at_once;
+
+    if (_d->reservation_in_cache && _cache_size - _cache_usage_count < whole_chunk)
+    {
+        if (_d->drop_chunks_if_cache_full || _d->fail_if_cache_full)
         {
-            //Writes Additional Entries for offsets (if used History Mode of the Writer the file has new layout)
-            AdditionalIndexInfo info;
-            info.stream_index_offset = _index_table.getIndexOffset(stream_id);
-            info.stream_table_index_offset =
-                static_cast<uint32_t>(_index_table.getIndexTableOffset(stream_id));
-            sprintf(extension_name, "%s%d", IDX_EXT_INDEX_ADDITONAL, (int) stream_id);
-            appendExtension(extension_name,
-                            &info,
-                            sizeof(info),
-                            0x0,
-                            0x0,
-                            stream_id,
-                            0x0);
+            // commitChunk applies the policy
+            _d->reservation_in_cache = false;
+        }
+        else
+        {
+            waitForFreeCacheSpace(static_cast<int>(whole_chunk));
         }
     }
+
+    if (_d->reservation_in_cache)
+    {
+        uint8_t* cache_addr = static_cast<uint8_t*>(getCacheAddr());
+        const uint64_t payload_pos = (_cache_insert_ptr + sizeof(ChunkHeader)) % _cache_size;
+        const uint32_t first_part = static_cast<uint32_t>(std::min<uint64_t>(data_size, _cache_size - payload_pos));
+        reservation.data[0] = cache_addr + payload_pos;
+        reservation.data_size[0] = first_part;
+        reservation.data[1] = cache_addr;
+        reservation.data_size[1] = data_size - first_part;
+    }
+    else
+    {
+        _d->reservation_buffer.resize(data_size);
+        reservation.data[0] = _d->reservation_buffer.data();
+        reservation.data_size[0] = data_size;
+        reservation.data[1] = nullptr;
+        reservation.data_size[1] = 0;
+    }
+
+    _d->reservation_size = data_size;
+    _d->reservation_pending = true;
+}
+
+void IndexedFileWriter::commitChunk(uint16_t stream_id,
+                                    timestamp_t time_stamp,
+                                    uint32_t flags)
+{
+    if (!_d->reservation_pending)
+    {
+        throw std::logic_error("no chunk reserved");
+    }
+    _d->reservation_pending = false;
+
+    if (!_d->reservation_in_cache)
+    {
+        return writeChunk(stream_id, _d->reservation_buffer.data(), _d->reservation_size, time_stamp, flags);
+    }
+
+    if (stream_id > 0 && stream_id <= MAX_INDEXED_STREAMS &&
+        _d->stream_codecs[stream_id - 1] != cc_none)
+    {
+        // the compressed data replaces the payload in the cache, which has not been accounted yet
+        const uint8_t* cache_addr = static_cast<const uint8_t*>(getCacheAddr());
+        const uint64_t payload_pos = (_cache_insert_ptr + sizeof(ChunkHeader)) % _cache_size;
+        const uint32_t first_part = static_cast<uint32_t>(std::min<uint64_t>(_d->reservation_size, _cache_size - payload_pos));
+        _d->reservation_buffer.resize(_d->reservation_size);
+        a_util::memory::copy(_d->reservation_buffer.data(), first_part, cache_addr + payload_pos, first_part);
+        a_util::memory::copy(_d->reservation_buffer.data() + first_part, _d->reservation_size - first_part,
+                             cache_addr, _d->reservation_size - first_part);
+        return writeChunk(stream_id, _d->reservation_buffer.data(), _d->reservation_size, time_stamp, flags);
+    }
+
+    bool index_entry_appended;
+    _d->committing_reservation = true;
+    try
+    {
+        appendChunk(stream_id, nullptr, _d->reservation_size, time_stamp, flags, index_entry_appended);
+    }
+    catch (...)
+    {
+        _d->committing_reservation = false;
+        throw;
+    }
+    _d->committing_reservation = false;
 }
 
-void IndexedFileWriter::writeChunk(uint16_t stream_id,
-                                       const void* data,
-                                       uint32_t data_size,
-                                       timestamp_t time_stamp,
-                                       uint32_t flags)
+void IndexedFileWriter::checkChunk(uint16_t stream_id, timestamp_t time_stamp) const
 {
-    bool index_appended = true;
-    return writeChunk(stream_id,
-                      data,
-                      data_size,
-                      time_stamp,
-                      flags,
-                      index_appended);
+    if (stream_id == 0 || stream_id > MAX_INDEXED_STREAMS) //a chunk needs to have a stream identifier
+    {
+        throw std::invalid_argument("invalid stream id");
+    }
+    if (time_stamp < 0)
+    {
+        throw std::invalid_argument("invalid timestamp");
+    }
 }
 
-
-void IndexedFileWriter::writeChunk(uint16_t stream_id,
-                                       const void* data,
-                                       uint32_t data_size,
-                                       timestamp_t time_stamp,
-                                       uint32_t flags,
-                                       bool& index_entry_appended)
+void IndexedFileWriter::appendChunk(uint16_t stream_id,
+                                    const void* data,
+                                    uint32_t data_size,
+                                    timestamp_t time_stamp,
+                                    uint32_t flags,
+                                    bool& index_entry_appended)
 {
     index_entry_appended = false;
     // this is only for async call and will only be set by the async file writer in UpdateCache()
@@ -963,17 +2517,16 @@ void IndexedFileWriter::writeChunk(uint16_t stream_id,
     //Every Chunk size is written at least 16 byte aligned
     IFHD_ASSERT((_file_pos & 0xF) == 0); // check for correct alignment
 
-    if (stream_id == 0 && stream_id > MAX_INDEXED_STREAMS) //a chunk needs to have a stream identifier
-    {
-        throw std::invalid_argument("invalid stream id");
-    }
-    if (time_stamp < 0)
-    {
-        throw std::invalid_argument("invalid timestamp");
-    }
+    checkChunk(stream_id, time_stamp);
 
     uint32_t size = data_size + sizeof(ChunkHeader);
 
+    if (!_sync_mode && !checkCacheSpace(static_cast<int>((size + 0xF) & ~0xF)))
+    {
+        // dropped due to om_drop_chunks_if_cache_full
+        return;
+    }
+
     if (_catch_first_time)
     {
         _time_offset    = time_stamp;
@@ -997,6 +2550,11 @@ void IndexedFileWriter::writeChunk(uint16_t stream_id,
     _stream_info[stream_id - 1].stream_last_time = (uint64_t)time_stamp;
 
 
+    if (_d->live_tap.isOpen())
+    {
+        publishToLiveTap(data, data_size);
+    }
+
     // remember position before writing the next chunk after this
     _file_pos_last_chunk = _file_pos;
 
@@ -1017,8 +2575,7 @@ void IndexedFileWriter::writeChunk(uint16_t stream_id,
 
     if (_d->InHistoryMode())
     {
-        // in history mode we do not support our own memory cache
-        // this is checked in the create method.
+        // the ring buffer writes synchronously or through the cache, see IndexedFileWriterImpl::write
         // _syncMode is handled by the File instance itself (via the open flags).
 
         RingBuffer::ItemPiece pieces[2];
@@ -1041,7 +2598,8 @@ void IndexedFileWriter::writeChunk(uint16_t stream_id,
             }
 
             if ((_d->history_time && (time_stamp - _d->first_time) > _d->history_time) ||
-                (_d->history_size && _d->file_ring_buffer->getCurrentSize() > _d->history_size))
+                (_d->history_size && !_d->history_preallocated &&
+                 _d->file_ring_buffer->getCurrentSize() > _d->history_size))
             {
                 _d->file_ring_buffer->startWrappingAround();
                 _d->wrapping_started = true;
@@ -1091,6 +2649,14 @@ void IndexedFileWriter::writeChunk(uint16_t stream_id,
                 }
             }
         }
+        else if (_d->committing_reservation)
+        {
+            // the payload has been written to the cache by the caller of reserveChunk
+            int insert = copyToCache(_cache_insert_ptr, &_d->internal_write_chunk_header, sizeof(_d->internal_write_chunk_header));
+            insert = static_cast<int>((insert + data_size) % _cache_size);
+            _cache_insert_ptr = copyToCache(insert, chunk_fill_bytes, fill_bytes);
+            addCacheUsage(static_cast<int>(whole_chunk));
+        }
         else
         {
             writeToCache(&_d->internal_write_chunk_header, sizeof(_d->internal_write_chunk_header), _d->check_chunk_header);
@@ -1116,9 +2682,17 @@ void IndexedFileWriter::writeChunk(uint16_t stream_id,
     _last_chunk_time = time_stamp;
     _file_header->chunk_count++;
 
-    if (size > _file_header->max_chunk_size)
+    // readers allocate their buffers for the decompressed data
+    uint64_t max_size = size;
+    if ((flags & ct_compressed) != 0)
+    {
+        max_size = getUncompressedChunkDataSize(*_file_header, data, data_size) + sizeof(ChunkHeader);
+        _d->compressed_chunks_written = true;
+    }
+
+    if (max_size > _file_header->max_chunk_size)
     {
-        _file_header->max_chunk_size = size;
+        _file_header->max_chunk_size = max_size;
     }
 
     _file_header->data_size += whole_chunk; // in history mode this will be updated in QuitHistory
@@ -1128,6 +2702,14 @@ void IndexedFileWriter::writeChunk(uint16_t stream_id,
 
     //the filepos is 16 byte aligned
     IFHD_ASSERT((_file_pos & 0xF) == 0); // check for correct alignment
+
+    if (_d->journal.isValid() &&
+        (!_d->journal_checkpoint_written ||
+         std::chrono::steady_clock::now() - _d->journal_last_checkpoint >=
+             std::chrono::microseconds(_d->journal_interval)))
+    {
+        writeJournalCheckpoint();
+    }
 }
 
 void IndexedFileWriter::quitHistory()
@@ -1174,6 +2756,16 @@ int IndexedFileWriter::getCacheUsage()
     return _cache_usage_count;
 }
 
+IndexedFileWriter::CacheStatistics IndexedFileWriter::getCacheStatistics() const
+{
+    CacheStatistics statistics;
+    statistics.stall_count = _d->cache_stall_count;
+    statistics.stall_time = _d->cache_stall_time;
+    statistics.high_water_mark = _d->cache_high_water_mark;
+    statistics.dropped_chunks = _d->dropped_chunks;
+    return statistics;
+}
+
 void IndexedFileWriter::writeToCache(const void* data,
                                          int data_size,
                                          const bool is_chunk_header)
@@ -1200,20 +2792,9 @@ void IndexedFileWriter::writeToCache(const void* data,
 
         // printf("CA: usage=%d, block=%d, size=%d\n", _cache_size, _cacheUsageCount, bytesToStore);
 
-        if (!_sync_mode)
+        if (!_sync_mode && _cache_size - _cache_usage_count < static_cast<uint64_t>(bytes_to_store))
         {
-            while (_cache_size - _cache_usage_count < bytes_to_store)
-            {
-                // wait until write thread freed some blocks
-                std::unique_lock<std::mutex> lck(_mutex_freed_event);
-                _cond_freed_event.wait_for(lck, std::chrono::milliseconds(100));
-
-                if (!_last_write_result)
-                {
-                    // check if it was a write error
-                    throw std::runtime_error("write thread encountered an error");
-                }
-            }
+            waitForFreeCacheSpace(bytes_to_store);
         }
 
         if (_cache_insert_ptr + bytes_to_store <= _cache_size)
@@ -1251,40 +2832,49 @@ void IndexedFileWriter::writeToCache(const void* data,
         data_src_ptr += bytes_to_store;
         data_stored += bytes_to_store;
 
-        // Atomic update
-        _cache_usage_count += bytes_to_store;
+        addCacheUsage(bytes_to_store);
+    }
+}
 
-        if (!_sync_mode)
-        {
-            {
-                std::lock_guard<std::mutex> guard(_mutex_cache_used);
-                _cond_cache_used_processed = false;
-            }
-            _cond_cache_used.notify_all();
-        }
+int IndexedFileWriter::copyToCache(int cache_pos, const void* data, int data_size)
+{
+    uint8_t* cache_addr = static_cast<uint8_t*>(getCacheAddr());
+    int first_part = std::min(data_size, static_cast<int>(_cache_size) - cache_pos);
+    a_util::memory::copy(cache_addr + cache_pos, first_part, data, first_part);
+    if (first_part < data_size)
+    {
+        a_util::memory::copy(cache_addr, data_size - first_part,
+                             static_cast<const uint8_t*>(data) + first_part, data_size - first_part);
     }
+
+    return static_cast<int>((cache_pos + data_size) % _cache_size);
 }
 
-void IndexedFileWriter::storeToDisk(bool flush)
+void IndexedFileWriter::addCacheUsage(int data_size)
 {
-    // atomic access
-    int available_data = _cache_usage_count;
-    size_t cache_written = 0;
+    // Atomic update
+    int cache_usage = (_cache_usage_count += data_size);
+    _d->cache_bytes_inserted += data_size;
 
-    if (!_sync_mode)
+    // this is the only thread that updates the high water mark
+    if (cache_usage > _d->cache_high_water_mark)
     {
-        if (!flush && available_data < _cache_min_store_at_once)
-        {
-            // printf("HD: not enough data to store to harddisk (%d bytes)\n", availableData);
+        _d->cache_high_water_mark = cache_usage;
+    }
 
-            _cond_freed_event.notify_all();
-            std::unique_lock<std::mutex> lock(_mutex_cache_used);
-            _cond_cache_used.wait(lock,
-                [&]() -> bool {return !_cond_cache_used_processed; }); // wait for new data - TODO: adding the depending condition. Need feedback with MHE
-            _cond_cache_used_processed = true;
-            return;
-        }
+    // only wake up the cache writing thread if there is enough data for it
+    if (!_sync_mode && _cache_flusher_waiting && cache_usage >= _cache_min_store_at_once)
+    {
+        std::lock_guard<std::mutex> guard(_mutex_cache_event);
+        _cond_cache_used.notify_one();
     }
+}
+
+void IndexedFileWriter::storeToDisk(bool flush)
+{
+    // atomic access
+    int available_data = _cache_usage_count;
+    size_t cache_written = 0;
 
     bool fill_up_sector_size = flush;
 
@@ -1300,6 +2890,13 @@ void IndexedFileWriter::storeToDisk(bool flush)
         }
     }
 
+    const bool history_operations = _d->InHistoryMode() && !_sync_mode;
+    if (history_operations)
+    {
+        // the ring buffer moves the file position when it wraps around
+        data_size = static_cast<size_t>(std::min<uint64_t>(data_size, _d->applyHistoryFileOperations()));
+    }
+
     void* cache_addr = getCacheAddr();
 
     if (_cache_flush_ptr + data_size <= _cache_size)
@@ -1334,6 +2931,7 @@ void IndexedFileWriter::storeToDisk(bool flush)
         _cache_flush_ptr   = 0;
         cache_written += first_part;
         available_data -= first_part;
+        data_size -= first_part;
 
         if (flush && data_size > 0)
         {
@@ -1344,8 +2942,7 @@ void IndexedFileWriter::storeToDisk(bool flush)
                 _d->CheckHeaderWritten(data_size);
             }
 
-            _cache_flush_ptr += static_cast<int>(data_size);
-            _cache_flush_ptr %= _cache_size;
+            _cache_flush_ptr = static_cast<int>(data_size % _cache_size);
             cache_written += data_size;
             data_size = 0;
         }
@@ -1356,9 +2953,64 @@ void IndexedFileWriter::storeToDisk(bool flush)
     // atomic update
     _cache_usage_count -= static_cast<int>(cache_written);
 
-    if (!_sync_mode)
+    _d->cache_bytes_written += cache_written;
+    if (history_operations)
     {
-        _cond_freed_event.notify_all();
+        _d->applyHistoryFileOperations();
+    }
+
+    if (_cache_writer_waiting)
+    {
+        std::lock_guard<std::mutex> guard(_mutex_cache_event);
+        _cond_freed_event.notify_one();
+    }
+}
+
+bool IndexedFileWriter::checkCacheSpace(int size)
+{
+    if (!_d->drop_chunks_if_cache_full && !_d->fail_if_cache_full)
+    {
+        // large chunks are written piecewise, waiting for free space if necessary
+        return true;
+    }
+
+    if (size >= 0 && _cache_size - _cache_usage_count >= static_cast<uint64_t>(size))
+    {
+        return true;
+    }
+
+    if (_d->fail_if_cache_full)
+    {
+        throw std::runtime_error("cache full");
+    }
+
+    ++_d->dropped_chunks;
+    return false;
+}
+
+void IndexedFileWriter::waitForFreeCacheSpace(int size)
+{
+    auto stall_start = std::chrono::steady_clock::now();
+
+    {
+        // the cache writing thread only signals us if we have announced that we are waiting
+        std::unique_lock<std::mutex> lock(_mutex_cache_event);
+        _cache_writer_waiting = true;
+        _cond_freed_event.wait(lock, [&]() -> bool
+        {
+            return _cache_size - _cache_usage_count >= static_cast<uint64_t>(size) || !_last_write_result;
+        });
+        _cache_writer_waiting = false;
+    }
+
+    ++_d->cache_stall_count;
+    _d->cache_stall_time += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - stall_start).count();
+
+    if (!_last_write_result)
+    {
+        // check if it was a write error
+        throw std::runtime_error("write thread encountered an error");
     }
 }
 
@@ -1366,19 +3018,76 @@ void IndexedFileWriter::writeCacheToDisk()
 {    
     try
     {
-        while (_d->keep_writing_cache_to_disk)
+        const bool publish_progress = _d->progress_file.isValid();
+        for (;;)
         {
-            storeToDisk(false);
+            bool progress_due = false;
+            {
+                // wait until there is enough data to write, the remaining data is flushed on close
+                std::unique_lock<std::mutex> lock(_mutex_cache_event);
+                _cache_flusher_waiting = true;
+                auto enough_data = [&]() -> bool
+                {
+                    return _cache_usage_count >= _cache_min_store_at_once || !_d->keep_writing_cache_to_disk;
+                };
+                if (publish_progress)
+                {
+                    progress_due = !_cond_cache_used.wait_until(lock, _d->progress_deadline, enough_data);
+                }
+                else
+                {
+                    _cond_cache_used.wait(lock, enough_data);
+                }
+                _cache_flusher_waiting = false;
+            }
+
+            if (!_d->keep_writing_cache_to_disk)
+            {
+                break;
+            }
+
+            if (progress_due)
+            {
+                // write whatever is in the cache, also the part behind its wrap around
+                uint64_t bytes_written = _d->cache_bytes_written;
+                while (_cache_usage_count > 0)
+                {
+                    storeToDisk(false);
+                    if (_d->cache_bytes_written == bytes_written)
+                    {
+                        break;
+                    }
+                    bytes_written = _d->cache_bytes_written;
+                }
+            }
+            else
+            {
+                storeToDisk(false);
+            }
+
+            if (_d->journal.isValid())
+            {
+                writePendingJournalCheckpoints();
+            }
+
+            if (publish_progress)
+            {
+                publishProgress();
+            }
         }
     }
     catch (...)
     {
-        _last_write_result = false;
     #ifdef WIN32
         _last_write_system_error = GetLastError();
     #else
         _last_write_system_error = errno;
-    #endif        
+    #endif
+
+        // wake up a writer that waits for free cache space
+        std::lock_guard<std::mutex> guard(_mutex_cache_event);
+        _last_write_result = false;
+        _cond_freed_event.notify_all();
     }
 }
 
@@ -1429,6 +3138,7 @@ void IndexedFileWriter::setStreamName(uint16_t stream_id,
         {
             strncpy((char*)_stream_info[stream_id - 1].stream_name, stream_name, MAX_STREAMNAME_LENGTH);
             _stream_info[stream_id - 1].stream_name[MAX_STREAMNAME_LENGTH-1] = 0;
+            _d->journal_stream_info_changed[stream_id - 1] = true;
         }
         else
         {
@@ -1446,6 +3156,13 @@ void IndexedFileWriter::setAdditionalStreamInfo(uint16_t stream_id,
         && stream_id > 0
         && stream_id <= MAX_INDEXED_STREAMS)
     {
+        // the info may be updated while writing, i.e. to be stored in the index journal
+        if (_stream_info_add[stream_id - 1].is_reference == 0)
+        {
+            delete [] _stream_info_add[stream_id - 1].data;
+        }
+        _d->journal_stream_info_changed[stream_id - 1] = true;
+
         if (use_as_reference)
         {
             _stream_info_add[stream_id - 1].is_reference  = 1;
@@ -1471,5 +3188,210 @@ uint32_t IndexedFileWriter::getLastSystemErrorFromWriteThread() const
     return _last_write_system_error;
 }
 
+IndexedFileWriter::ChunkProducer& IndexedFileWriter::createProducer(size_t queue_size)
+{
+    if (!_is_open || !_d->concurrent_write)
+    {
+        throw std::logic_error("producers are only available for files created with om_concurrent_write");
+    }
+
+    std::unique_ptr<ChunkProducer> producer(new ChunkProducer(*this, queue_size));
+
+    std::lock_guard<std::mutex> lock(_d->producers_mutex);
+    _d->producers.push_back(std::move(producer));
+    return *_d->producers.back();
+}
+
+void IndexedFileWriter::mergeProducerQueues()
+{
+    try
+    {
+        for (;;)
+        {
+            if (writeQueuedChunks())
+            {
+                continue;
+            }
+
+            if (!_d->keep_merging)
+            {
+                // make sure that we did not miss anything that was queued while stopping
+                if (!writeQueuedChunks())
+                {
+                    break;
+                }
+                continue;
+            }
+
+            // nothing to do, wait until a producer signals new chunks
+            std::unique_lock<std::mutex> lock(_d->merge_mutex);
+            _d->merge_thread_idle = true;
+            _d->merge_event.wait_for(lock, std::chrono::milliseconds(1),
+                                     [&]() -> bool {return _d->chunks_queued || !_d->keep_merging;});
+            _d->chunks_queued = false;
+            _d->merge_thread_idle = false;
+        }
+    }
+    catch (...)
+    {
+        _d->merge_error = std::current_exception();
+        _last_write_result = false;
+    #ifdef WIN32
+        _last_write_system_error = GetLastError();
+    #else
+        _last_write_system_error = errno;
+    #endif
+    }
+}
+
+bool IndexedFileWriter::writeQueuedChunks()
+{
+    std::vector<ChunkProducer*> producers;
+    {
+        std::lock_guard<std::mutex> lock(_d->producers_mutex);
+        producers.reserve(_d->producers.size());
+        for (auto& producer: _d->producers)
+        {
+            producers.push_back(producer.get());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_d->chunk_write_mutex);
+
+    // limit the number of chunks per call so that direct writers get the lock as well
+    const size_t max_chunks_at_once = 256;
+
+    bool written = false;
+    for (size_t chunk_count = 0; chunk_count < max_chunks_at_once; ++chunk_count)
+    {
+        // the producer with the oldest chunk goes first
+        ChunkProducer* next_producer = nullptr;
+        const QueuedChunk* next_chunk = nullptr;
+        for (auto producer: producers)
+        {
+            size_t record_size;
+            const QueuedChunk* chunk = static_cast<const QueuedChunk*>(producer->_queue.front(&record_size));
+            if (chunk &&
+                (!next_chunk || chunk->time_stamp < next_chunk->time_stamp))
+            {
+                next_producer = producer;
+                next_chunk = chunk;
+            }
+        }
+
+        if (!next_chunk)
+        {
+            return written;
+        }
+
+        bool index_entry_appended;
+        appendChunk(next_chunk->stream_id,
+                    next_chunk + 1,
+                    next_chunk->data_size,
+                    next_chunk->time_stamp,
+                    next_chunk->flags,
+                    index_entry_appended);
+        next_producer->_queue.pop();
+        written = true;
+    }
+
+    return written;
+}
+
+void IndexedFileWriter::stopMerging()
+{
+    if (_d->merge_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_d->merge_mutex);
+            _d->keep_merging = false;
+        }
+        _d->merge_event.notify_all();
+        _d->merge_thread.join();
+    }
+}
+
+IndexedFileWriter::ChunkProducer::ChunkProducer(IndexedFileWriter& writer, size_t queue_size) :
+    _writer(writer)
+{
+    _queue.allocate(queue_size);
+}
+
+void IndexedFileWriter::ChunkProducer::writeChunk(uint16_t stream_id,
+                                                  const void* data,
+                                                  uint32_t data_size,
+                                                  timestamp_t time_stamp,
+                                                  uint32_t flags)
+{
+    if (!_writer._last_write_result)
+    {
+        throw std::runtime_error("write thread encountered an error");
+    }
+
+    if (!_writer._is_open)
+    {
+        throw std::runtime_error("file not opened");
+    }
+
+    _writer.checkChunk(stream_id, time_stamp);
+
+    if ((flags & ct_compressed) != 0)
+    {
+        throw std::invalid_argument("the chunk flag ct_compressed is reserved");
+    }
+
+    // every producer compresses its chunks within its own thread
+    _writer.compressChunk(stream_id, data, data_size, flags);
+
+    QueuedChunk chunk;
+    utils5ext::memZero(&chunk, sizeof(chunk));
+    chunk.time_stamp = time_stamp;
+    chunk.data_size = data_size;
+    chunk.flags = flags;
+    chunk.stream_id = stream_id;
+
+    if (sizeof(chunk) + data_size > _queue.getMaxRecordSize())
+    {
+        // keep the order of this producer and write the chunk directly
+        while (!_queue.isEmpty())
+        {
+            if (!_writer._last_write_result)
+            {
+                throw std::runtime_error("write thread encountered an error");
+            }
+            std::this_thread::yield();
+        }
+
+        std::lock_guard<std::mutex> lock(_writer._d->chunk_write_mutex);
+        bool index_entry_appended;
+        return _writer.appendChunk(stream_id, data, data_size, time_stamp, flags, index_entry_appended);
+    }
+
+    while (!_queue.tryPush(&chunk, sizeof(chunk), data, data_size))
+    {
+        if (!_writer._last_write_result)
+        {
+            throw std::runtime_error("write thread encountered an error");
+        }
+
+        // the merge thread might still be waiting for a signal
+        if (_writer._d->merge_thread_idle)
+        {
+            _writer._d->merge_event.notify_one();
+        }
+
+        std::this_thread::yield();
+    }
+
+    if (_writer._d->merge_thread_idle)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_writer._d->merge_mutex);
+            _writer._d->chunks_queued = true;
+        }
+        _writer._d->merge_event.notify_one();
+    }
+}
+
 } // v201_v301
 } // namespace ifhd
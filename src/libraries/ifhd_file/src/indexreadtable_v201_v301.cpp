@@ -47,6 +47,8 @@ void IndexReadTable::free()
 
     _indexed_file = nullptr;
     _file_header = nullptr;
+
+    clearDenseIndex();
 }
 
 int64_t IndexReadTable::getItemCount(uint16_t stream_id) const
@@ -745,6 +747,290 @@ bool IndexReadTable::findNearestEntryWithFlags(uint16_t stream_id,
     return false;
 }
 
+void IndexReadTable::clearDenseIndex()
+{
+    std::vector<DenseIndexEntry>().swap(_dense_index);
+    for (auto& stream_index: _dense_stream_index)
+    {
+        std::vector<uint64_t>().swap(stream_index);
+    }
+}
+
+void IndexReadTable::appendDenseIndexEntry(const ChunkHeader& header, uint64_t chunk_offset)
+{
+    if (header.stream_id > MAX_INDEXED_STREAMS)
+    {
+        throw std::out_of_range("invalid stream id");
+    }
+
+    if (_dense_index.empty())
+    {
+        _dense_index.reserve(static_cast<size_t>(_file_header->chunk_count));
+    }
+
+    _dense_stream_index[header.stream_id].push_back(_dense_index.size());
+
+    DenseIndexEntry entry;
+    entry.time_stamp = header.time_stamp;
+    entry.chunk_offset = chunk_offset;
+    entry.stream_index = header.stream_index;
+    _dense_index.push_back(entry);
+}
+
+bool IndexReadTable::hasDenseIndex() const
+{
+    return !_dense_index.empty() && _dense_index.size() == _file_header->chunk_count;
+}
+
+#pragma pack(push, 1)
+/// The start of a file that stores a dense index, see IndexReadTable::storeDenseIndex
+struct DenseIndexFileHeader
+{
+    uint32_t   id;
+    uint32_t   version;
+    uint64_t   file_size;
+    FileHeader file_header;
+    uint64_t   chunk_count;
+};
+
+/// An entry of a stored dense index, one per chunk
+struct DenseIndexFileEntry
+{
+    int64_t  time_stamp;
+    uint64_t chunk_offset;
+    uint64_t stream_index;
+    uint16_t stream_id;
+    uint8_t  reserved[6];
+};
+#pragma pack(pop)
+
+static const uint32_t dense_index_file_id = 0x49444649; // "IFDI"
+static const uint32_t dense_index_file_version = 1;
+
+/// the amount of entries of a stored dense index that are read or written at once
+static const size_t dense_index_file_block_size = 64 * 1024;
+
+void IndexReadTable::storeDenseIndex(const std::string& file_name, uint64_t file_size) const
+{
+    using namespace utils5ext;
+
+    std::vector<uint16_t> stream_ids(_dense_index.size());
+    for (uint16_t stream_id = 0; stream_id <= MAX_INDEXED_STREAMS; ++stream_id)
+    {
+        for (auto chunk_index: _dense_stream_index[stream_id])
+        {
+            stream_ids[static_cast<size_t>(chunk_index)] = stream_id;
+        }
+    }
+
+    DenseIndexFileHeader header;
+    utils5ext::memZero(&header, sizeof(header));
+    header.id = dense_index_file_id;
+    header.version = dense_index_file_version;
+    header.file_size = file_size;
+    header.file_header = *_file_header;
+    header.chunk_count = _dense_index.size();
+
+    // the index is written to a temporary file first, so that an interrupted write never
+    // leaves an incomplete index under the final name
+    const std::string temp_file_name = file_name + ".tmp";
+    File file;
+    file.open(temp_file_name, File::om_write);
+    try
+    {
+        file.writeAll(&header, sizeof(header));
+
+        std::vector<DenseIndexFileEntry> entries;
+        entries.reserve(std::min(_dense_index.size(), dense_index_file_block_size));
+        for (size_t chunk_index = 0; chunk_index < _dense_index.size(); ++chunk_index)
+        {
+            DenseIndexFileEntry entry;
+            utils5ext::memZero(&entry, sizeof(entry));
+            entry.time_stamp = _dense_index[chunk_index].time_stamp;
+            entry.chunk_offset = _dense_index[chunk_index].chunk_offset;
+            entry.stream_index = _dense_index[chunk_index].stream_index;
+            entry.stream_id = stream_ids[chunk_index];
+            entries.push_back(entry);
+
+            if (entries.size() == dense_index_file_block_size || chunk_index + 1 == _dense_index.size())
+            {
+                file.writeAll(entries.data(), entries.size() * sizeof(DenseIndexFileEntry));
+                entries.clear();
+            }
+        }
+
+        file.syncData();
+        file.close();
+
+        if (a_util::filesystem::exists(file_name))
+        {
+            a_util::filesystem::remove(file_name);
+        }
+        utils5ext::fileRename(temp_file_name, file_name);
+    }
+    catch (...)
+    {
+        file.close();
+        a_util::filesystem::remove(temp_file_name);
+        throw;
+    }
+}
+
+bool IndexReadTable::loadDenseIndex(const std::string& file_name, uint64_t file_size)
+{
+    using namespace utils5ext;
+
+    clearDenseIndex();
+    if (!a_util::filesystem::exists(file_name))
+    {
+        return false;
+    }
+
+    try
+    {
+        File file;
+        file.open(file_name, File::om_read | File::om_shared_read);
+
+        DenseIndexFileHeader header;
+        if (file.read(&header, sizeof(header)) != sizeof(header) ||
+            header.id != dense_index_file_id ||
+            header.version != dense_index_file_version ||
+            header.file_size != file_size ||
+            header.chunk_count != _file_header->chunk_count ||
+            a_util::memory::compare(&header.file_header, sizeof(FileHeader), _file_header, sizeof(FileHeader)) != 0 ||
+            static_cast<uint64_t>(file.getSize()) != sizeof(header) + header.chunk_count * sizeof(DenseIndexFileEntry))
+        {
+            return false;
+        }
+
+        std::vector<DenseIndexFileEntry> entries;
+        for (uint64_t chunk_index = 0; chunk_index < header.chunk_count; chunk_index += entries.size())
+        {
+            entries.resize(static_cast<size_t>(std::min<uint64_t>(header.chunk_count - chunk_index,
+                                                                  dense_index_file_block_size)));
+            file.readAll(entries.data(), entries.size() * sizeof(DenseIndexFileEntry));
+            for (auto& entry: entries)
+            {
+                ChunkHeader chunk_header;
+                utils5ext::memZero(&chunk_header, sizeof(chunk_header));
+                chunk_header.time_stamp = entry.time_stamp;
+                chunk_header.stream_id = entry.stream_id;
+                chunk_header.stream_index = entry.stream_index;
+                appendDenseIndexEntry(chunk_header, entry.chunk_offset);
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        clearDenseIndex();
+        return false;
+    }
+
+    return hasDenseIndex();
+}
+
+int64_t IndexReadTable::lookupDenseChunkRef(uint16_t stream_id, int64_t pos,
+                                            TimeFormat time_format, bool before,
+                                            int64_t* chunk_offset) const
+{
+    if (stream_id > MAX_INDEXED_STREAMS)
+    {
+        throw std::out_of_range("invalid stream id");
+    }
+
+    if (time_format == tf_chunk_time)
+    {
+        if (pos < (int64_t)_file_header->time_offset)
+        {
+            throw std::out_of_range("invalid position before time offset");
+        }
+    }
+    else if (pos < 0)
+    {
+        throw std::invalid_argument("invalid position argument");
+    }
+
+    uint64_t chunk_index = 0;
+
+    if (time_format == tf_chunk_index)
+    {
+        if (static_cast<uint64_t>(pos) >= _dense_index.size())
+        {
+            throw exceptions::EndOfFile();
+        }
+        chunk_index = static_cast<uint64_t>(pos);
+    }
+    else if (stream_id == 0)
+    {
+        if (time_format != tf_chunk_time)
+        {
+            throw std::invalid_argument("stream based chunk lookup only valid for stream ids > 0");
+        }
+
+        auto compare_time = [](const DenseIndexEntry& entry, timestamp_t time_stamp)
+        {
+            return entry.time_stamp < time_stamp;
+        };
+
+        auto found = std::lower_bound(_dense_index.begin(), _dense_index.end(),
+                                      static_cast<timestamp_t>(pos), compare_time);
+        if (before && (found == _dense_index.end() || found->time_stamp > static_cast<timestamp_t>(pos)))
+        {
+            if (found != _dense_index.begin())
+            {
+                --found;
+            }
+        }
+
+        if (found == _dense_index.end())
+        {
+            throw exceptions::EndOfFile();
+        }
+
+        chunk_index = found - _dense_index.begin();
+    }
+    else
+    {
+        const std::vector<uint64_t>& stream_chunks = _dense_stream_index[stream_id];
+        std::vector<uint64_t>::const_iterator found;
+
+        if (time_format == tf_chunk_time)
+        {
+            found = std::lower_bound(stream_chunks.begin(), stream_chunks.end(), static_cast<timestamp_t>(pos),
+                                     [&](uint64_t index, timestamp_t time_stamp)
+                                     {
+                                         return _dense_index[index].time_stamp < time_stamp;
+                                     });
+            if (before && (found == stream_chunks.end() ||
+                           _dense_index[*found].time_stamp > static_cast<timestamp_t>(pos)))
+            {
+                if (found != stream_chunks.begin())
+                {
+                    --found;
+                }
+            }
+        }
+        else
+        {
+            found = std::lower_bound(stream_chunks.begin(), stream_chunks.end(), static_cast<uint64_t>(pos),
+                                     [&](uint64_t index, uint64_t stream_index)
+                                     {
+                                         return _dense_index[index].stream_index < stream_index;
+                                     });
+        }
+
+        if (found == stream_chunks.end())
+        {
+            throw exceptions::EndOfFile();
+        }
+
+        chunk_index = *found;
+    }
+
+    *chunk_offset = static_cast<int64_t>(_dense_index[chunk_index].chunk_offset);
+    return static_cast<int64_t>(chunk_index);
+}
+
 } // namespace v400
 } // namespace ifhd
 
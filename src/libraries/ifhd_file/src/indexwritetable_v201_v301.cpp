@@ -20,19 +20,55 @@
 
 
 #include <ifhd/ifhd.h>
+#include <algorithm>
 
 namespace ifhd
 {
 namespace v201_v301
 {
 
-void IndexWriteTable::create(timestamp_t index_delay)
+IndexWriteTable::IndexWriteTable():
+    _index_delay(1000000),
+    _spill_block_size(0),
+    _spilled_entry_count(0)
+{
+}
+
+void IndexWriteTable::create(timestamp_t index_delay,
+                             const std::string& spill_file_name,
+                             size_t max_entries_in_memory)
 {     
     _index_delay = index_delay;
+
+    if (max_entries_in_memory > 0)
+    {
+        // half of the entries in memory are moved at once, the most recent ones stay in memory
+        _spill_file_name = spill_file_name;
+        _spill_file.open(_spill_file_name, utils5ext::File::om_read_write);
+        _spill_block_size = std::max<size_t>(max_entries_in_memory / 2, 1);
+    }
 }
 
 void IndexWriteTable::free()
 {
+    try
+    {
+        waitForSpill();
+    }
+    catch (...)
+    {
+        // the spilled entries are discarded anyway
+    }
+
+    if (_spill_file.isValid())
+    {
+        _spill_file.close();
+        a_util::filesystem::remove(_spill_file_name);
+    }
+    _spill_block_size = 0;
+    _spilled_entry_count = 0;
+    std::vector<ChunkRef>().swap(_spill_buffer);
+
     _master_index.clear();
     _master_index.last_index = 0;
     _master_index.index_table_offset = 0;
@@ -59,7 +95,7 @@ int64_t IndexWriteTable::getItemCount(uint16_t stream_id) const
 {
     if (stream_id == 0)
     {
-        return _master_index.size();
+        return _spilled_entry_count + _master_index.size();
     }
     else
     {
@@ -71,7 +107,7 @@ int64_t IndexWriteTable::getBufferSize(uint16_t stream_id) const
 {
     if (stream_id == 0)
     {
-        return _master_index.size() * sizeof(ChunkRef);
+        return (_spilled_entry_count + _master_index.size()) * sizeof(ChunkRef);
     }
     else
     {
@@ -79,7 +115,7 @@ int64_t IndexWriteTable::getBufferSize(uint16_t stream_id) const
     }
 }
 
-void IndexWriteTable::copyToBuffer(uint16_t stream_id, void* buffer) const
+void IndexWriteTable::copyToBuffer(uint16_t stream_id, void* buffer)
 {
     if (MAX_INDEXED_STREAMS < stream_id)
     {
@@ -91,22 +127,108 @@ void IndexWriteTable::copyToBuffer(uint16_t stream_id, void* buffer) const
 
     if (stream_id == 0) //get the master index
     {
-        ChunkRef* output = static_cast<ChunkRef*>(buffer);
-        for (MasterIndexTable::const_iterator it_entry = _master_index.cbegin();
-             it_entry != _master_index.end(); ++it_entry, ++output)
-        {
-            a_util::memory::copy(output, sizeof(ChunkRef), &(*it_entry), sizeof(ChunkRef));
-        }
+        copyMasterEntries(0, getItemCount(0), static_cast<ChunkRef*>(buffer));
     }
     else // get the StreamTables
     {
-        StreamRef* output = static_cast<StreamRef*>(buffer);
-        for (StreamIndexTable::const_iterator it_entry = _stream_index_tables[stream_id].cbegin();
-             it_entry != _stream_index_tables[stream_id].end(); ++it_entry, ++output)
-        {
-            // adjust the offset from dropped chunks
-            output->ref_master_table_index = it_entry->ref_master_table_index;
-        }
+        copyStreamEntries(stream_id, 0, getItemCount(stream_id), static_cast<StreamRef*>(buffer));
+    }
+}
+
+void IndexWriteTable::copyStreamEntries(uint16_t stream_id, uint64_t first_entry, uint64_t count, StreamRef* buffer) const
+{
+    if (stream_id == 0 || MAX_INDEXED_STREAMS < stream_id)
+    {
+        throw std::out_of_range("invalid stream id");
+    }
+
+    const StreamIndexTable& stream_table = _stream_index_tables[stream_id];
+    if (first_entry + count > stream_table.size())
+    {
+        throw std::out_of_range("invalid index position");
+    }
+
+    auto entry = stream_table.cbegin() + static_cast<std::ptrdiff_t>(first_entry);
+    for (; count > 0; --count, ++entry, ++buffer)
+    {
+        // adjust the offset from dropped chunks
+        buffer->ref_master_table_index = entry->ref_master_table_index;
+    }
+}
+
+void IndexWriteTable::copyMasterEntries(uint64_t first_entry, std::vector<ChunkRef>& entries)
+{
+    const uint64_t entry_count = getItemCount(0);
+    entries.resize(first_entry < entry_count ? static_cast<size_t>(entry_count - first_entry) : 0);
+    copyMasterEntries(first_entry, entries.size(), entries.data());
+}
+
+void IndexWriteTable::copyMasterEntries(uint64_t first_entry, uint64_t count, ChunkRef* buffer)
+{
+    if (first_entry + count > static_cast<uint64_t>(getItemCount(0)))
+    {
+        throw std::out_of_range("invalid index position");
+    }
+
+    // the entries of the last spilled block are still in memory, older ones have to be read
+    const uint64_t first_buffered_entry = _spilled_entry_count - _spill_buffer.size();
+    if (first_entry < first_buffered_entry)
+    {
+        waitForSpill();
+
+        const uint64_t spilled_count = std::min(count, first_buffered_entry - first_entry);
+        _spill_file.setFilePos(static_cast<utils5ext::FilePos>(first_entry * sizeof(ChunkRef)),
+                               utils5ext::File::fp_begin);
+        _spill_file.readAll(buffer, static_cast<size_t>(spilled_count * sizeof(ChunkRef)));
+        buffer += spilled_count;
+        first_entry += spilled_count;
+        count -= spilled_count;
+    }
+
+    if (first_entry < _spilled_entry_count)
+    {
+        const uint64_t buffered_count = std::min(count, _spilled_entry_count - first_entry);
+        a_util::memory::copy(buffer, static_cast<size_t>(buffered_count * sizeof(ChunkRef)),
+                             _spill_buffer.data() + (first_entry - first_buffered_entry),
+                             static_cast<size_t>(buffered_count * sizeof(ChunkRef)));
+        buffer += buffered_count;
+        first_entry += buffered_count;
+        count -= buffered_count;
+    }
+
+    // unfortunately std::deque does not guarantee a continuous memory layout
+    // so we have to copy the items one by one.
+    auto entry = _master_index.cbegin() + static_cast<std::ptrdiff_t>(first_entry - _spilled_entry_count);
+    for (; count > 0; --count, ++entry, ++buffer)
+    {
+        a_util::memory::copy(buffer, sizeof(ChunkRef), &(*entry), sizeof(ChunkRef));
+    }
+}
+
+void IndexWriteTable::spillBlock()
+{
+    // the previous block has had the time of a whole block to be written
+    waitForSpill();
+
+    _spill_buffer.assign(_master_index.cbegin(),
+                         _master_index.cbegin() + static_cast<std::ptrdiff_t>(_spill_block_size));
+    _master_index.erase(_master_index.begin(),
+                        _master_index.begin() + static_cast<std::ptrdiff_t>(_spill_block_size));
+
+    const utils5ext::FilePos file_pos = static_cast<utils5ext::FilePos>(_spilled_entry_count * sizeof(ChunkRef));
+    _spilled_entry_count += _spill_block_size;
+    _spill_writing = std::async(std::launch::async, [this, file_pos]()
+    {
+        _spill_file.setFilePos(file_pos, utils5ext::File::fp_begin);
+        _spill_file.writeAll(_spill_buffer.data(), _spill_buffer.size() * sizeof(ChunkRef));
+    });
+}
+
+void IndexWriteTable::waitForSpill()
+{
+    if (_spill_writing.valid())
+    {
+        _spill_writing.get();
     }
 }
 
@@ -158,6 +280,11 @@ void IndexWriteTable::append(uint16_t stream_id,
     _master_index.push_back(index_entry);
     ++_master_index.index_count;
 
+    if (_spill_block_size > 0 && _master_index.size() >= 2 * _spill_block_size)
+    {
+        spillBlock();
+    }
+
     stream_table->push_back(stream_index_entry);
     stream_table->last_index = time_stamp;
     ++stream_table->index_count;
@@ -167,12 +294,18 @@ void IndexWriteTable::append(uint16_t stream_id,
 
 void IndexWriteTable::remove(uint64_t chunk_index, uint16_t stream_id)
 {
+    if (_spilled_entry_count > 0)
+    {
+        throw std::logic_error("spilled index entries can not be removed");
+    }
+
     ++_master_index.index_offset;
     ++_stream_index_tables[stream_id].index_offset;
 
     if (_master_index.empty())
     {
-        throw std::runtime_error("index empty");
+        // a history that is shorter than the index delay may contain chunks without index entries only
+        return;
     }
 
     ChunkRef& chunk = _master_index.front();
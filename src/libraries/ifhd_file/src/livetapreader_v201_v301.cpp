@@ -0,0 +1,98 @@
+/**
+ * @file
+ * Reader for the live tap of the indexed file writer.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <ifhd/ifhd.h>
+
+namespace ifhd
+{
+namespace v201_v301
+{
+
+LiveTapReader::LiveTapReader() :
+    _chunk_header{},
+    _file_header{}
+{
+    // the writer publishes the chunks of the local platform
+    _file_header.header_byte_order = PLATFORM_BYTEORDER_UINT8;
+}
+
+LiveTapReader::~LiveTapReader()
+{
+    close();
+}
+
+void LiveTapReader::open(const std::string& name)
+{
+    _ring.open(name);
+}
+
+void LiveTapReader::close()
+{
+    _ring.close();
+}
+
+bool LiveTapReader::readNextChunk(ChunkHeader** chunk_header, void** data)
+{
+    if (!_ring.isOpen())
+    {
+        throw std::runtime_error("live tap not opened");
+    }
+
+    if (!_ring.pop(_record))
+    {
+        return false;
+    }
+
+    if (_record.size() < sizeof(ChunkHeader))
+    {
+        throw std::runtime_error("invalid chunk in live tap");
+    }
+
+    a_util::memory::copy(&_chunk_header, sizeof(_chunk_header), _record.data(), sizeof(ChunkHeader));
+    uint8_t* chunk_data = _record.data() + sizeof(ChunkHeader);
+    const uint32_t data_size = static_cast<uint32_t>(_record.size() - sizeof(ChunkHeader));
+
+    if ((_chunk_header.flags & ct_compressed) != 0)
+    {
+        _decompressed.resize(getUncompressedChunkDataSize(_file_header, chunk_data, data_size));
+
+        // the header describes the decompressed chunk from now on
+        _chunk_header.size = sizeof(ChunkHeader) +
+                             decompressChunkData(_file_header,
+                                                 chunk_data,
+                                                 data_size,
+                                                 _decompressed.data(),
+                                                 _decompressed.size());
+        _chunk_header.flags &= static_cast<uint16_t>(~ct_compressed);
+        chunk_data = _decompressed.data();
+    }
+
+    *chunk_header = &_chunk_header;
+    *data = chunk_data;
+    return true;
+}
+
+uint64_t LiveTapReader::getLostChunkCount() const
+{
+    return _ring.getLostRecordCount();
+}
+
+} // namespace
+} // namespace
@@ -20,6 +20,7 @@
 
 #include "gtest/gtest.h"
 #include <ifhd/ifhd.h> 
+#include <fstream>
 #include <iostream>
 #include "../../test_helper/test_helper.h"
 
@@ -990,3 +991,346 @@ DEFINE_TEST(TesterIndexedFileReader,
         }
     }
 }
+
+DEFINE_TEST(TesterIndexedFileReader,
+            TestMemoryMappedHistoryPlayback,
+            "1.13",
+            "TestMemoryMappedHistoryPlayback",
+            "Test continous playback and seeking of history files in memory mapped mode",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    IndexedFileReader reader;
+    A_UTILS_TEST_RESULT(reader.open(TEST_FILES_DIR "/test_history.dat", -1, OpenMode::om_memory_mapped));
+    A_UTILS_TEST(reader.isMemoryMapped());
+
+    auto view = reader.pinMappedView();
+    A_UTILS_TEST(view);
+
+    uint64_t chunk_count = reader.getChunkCount();
+    A_UTILS_TEST(chunk_count == 520);
+
+    int compare = 409;
+    void* last_data = nullptr;
+    std::string last_string;
+    for (uint64_t it_chunk = 0; it_chunk < chunk_count; ++it_chunk)
+    {
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+
+        // the data has to point into the mapped view
+        A_UTILS_TEST(static_cast<const uint8_t*>(data) >= view->getData());
+        A_UTILS_TEST(static_cast<const uint8_t*>(data) < view->getData() + view->getSize());
+
+        if (chunk->stream_id == 1)
+        {
+            ++compare;
+        }
+
+        std::string compare_string = a_util::strings::format("@%d|%d", chunk->stream_id, compare);
+        std::string helper(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader));
+        A_UTILS_TEST(compare_string == helper);
+        last_data = data;
+        last_string = helper;
+    }
+
+    // external buffers are still filled
+    A_UTILS_TEST(reader.seek(0, chunk_count - 1, TimeFormat::tf_chunk_index) == static_cast<int64_t>(chunk_count - 1));
+    {
+        ChunkHeader* chunk;
+        std::vector<uint8_t> buffer(1024);
+        void* data = buffer.data();
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data, ReadFlags::rf_use_external_buffer));
+        A_UTILS_TEST(data == buffer.data());
+        std::string helper(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader));
+        A_UTILS_TEST(helper == last_string);
+    }
+
+    // the pinned view survives closing the reader
+    A_UTILS_TEST_RESULT(reader.close());
+    A_UTILS_TEST(!reader.isMemoryMapped());
+    A_UTILS_TEST(std::string(static_cast<char*>(last_data), last_string.size()) == last_string);
+}
+
+DEFINE_TEST(TesterIndexedFileReader,
+            TestStreamFilter,
+            "1.14",
+            "TestStreamFilter",
+            "Test that the stream filter skips chunks of other streams, also across the ring buffer wrap",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+
+    for (uint32_t open_mode: {0u, static_cast<uint32_t>(OpenMode::om_memory_mapped)})
+    {
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(TEST_FILES_DIR "/test_history.dat", -1, open_mode));
+        uint64_t chunk_count = reader.getChunkCount();
+
+        std::vector<std::string> expected;
+        for (uint64_t it_chunk = 0; it_chunk < chunk_count; ++it_chunk)
+        {
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            if (chunk->stream_id == 2)
+            {
+                expected.push_back(std::string(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader)));
+            }
+        }
+        A_UTILS_TEST(!expected.empty());
+
+        std::set<uint16_t> filter;
+        filter.insert(2);
+        A_UTILS_TEST_RESULT(reader.setStreamFilter(filter));
+        A_UTILS_TEST(reader.isStreamSelected(2));
+        A_UTILS_TEST(!reader.isStreamSelected(1));
+        A_UTILS_TEST_RESULT(reader.reset());
+
+        for (const auto& expected_string: expected)
+        {
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            A_UTILS_TEST(chunk->stream_id == 2);
+            A_UTILS_TEST(std::string(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader)) == expected_string);
+        }
+
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_ERR_RESULT(reader.readNextChunk(&chunk, &data));
+
+        // an empty filter selects all streams again
+        A_UTILS_TEST_RESULT(reader.setStreamFilter(std::set<uint16_t>()));
+        A_UTILS_TEST(reader.isStreamSelected(1));
+        A_UTILS_TEST_RESULT(reader.reset());
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+        A_UTILS_TEST(reader.getCurrentPos(TimeFormat::tf_chunk_index) == 1);
+    }
+}
+
+DEFINE_TEST(TesterIndexedFileReader,
+            TestDenseIndexSeek,
+            "1.15",
+            "TestDenseIndexSeek",
+            "Test seeking with a dense index",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const std::string dense_index_file = IndexedFileReader::getDenseIndexFileName(TEST_FILES_DIR "/test_history.dat");
+    a_util::filesystem::remove(dense_index_file);
+
+    IndexedFileReader reader;
+    A_UTILS_TEST_RESULT(reader.open(TEST_FILES_DIR "/test_history.dat"));
+    A_UTILS_TEST(!reader.hasDenseIndex());
+
+    struct Chunk
+    {
+        uint16_t stream_id;
+        timestamp_t time_stamp;
+        std::string data;
+    };
+
+    std::vector<Chunk> chunks;
+    for (uint64_t it_chunk = 0; it_chunk < reader.getChunkCount(); ++it_chunk)
+    {
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+        chunks.push_back({chunk->stream_id, chunk->time_stamp,
+                          std::string(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader))});
+    }
+
+    A_UTILS_TEST_RESULT(reader.close());
+    A_UTILS_TEST(!a_util::filesystem::exists(dense_index_file));
+
+    auto check_seek = [&](uint16_t stream_id, int64_t position, TimeFormat time_format, uint32_t flags, int64_t expected_index)
+    {
+        ASSERT_EQ(reader.seek(stream_id, position, time_format, flags), expected_index);
+
+        ChunkHeader* chunk;
+        void* data;
+        ASSERT_NO_THROW(reader.readNextChunk(&chunk, &data));
+        ASSERT_EQ(chunk->stream_id, chunks[expected_index].stream_id);
+        ASSERT_EQ(chunk->time_stamp, chunks[expected_index].time_stamp);
+        ASSERT_EQ(std::string(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader)), chunks[expected_index].data);
+        ASSERT_EQ(reader.getCurrentPos(TimeFormat::tf_chunk_index), expected_index + 1);
+    };
+
+    // the first chunk of the stream at or after the given time
+    auto find_after = [&](uint16_t stream_id, timestamp_t time_stamp) -> int64_t
+    {
+        for (size_t it_chunk = 0; it_chunk < chunks.size(); ++it_chunk)
+        {
+            if (chunks[it_chunk].stream_id == stream_id && chunks[it_chunk].time_stamp >= time_stamp)
+            {
+                return static_cast<int64_t>(it_chunk);
+            }
+        }
+        return -1;
+    };
+
+    // the last chunk of the stream before the given time
+    auto find_before = [&](uint16_t stream_id, timestamp_t time_stamp) -> int64_t
+    {
+        int64_t found = -1;
+        for (size_t it_chunk = 0; it_chunk < chunks.size(); ++it_chunk)
+        {
+            if (chunks[it_chunk].stream_id == stream_id && chunks[it_chunk].time_stamp < time_stamp)
+            {
+                found = static_cast<int64_t>(it_chunk);
+            }
+        }
+        return found;
+    };
+
+    // the first reader scans the file and stores the index, the second one loads it
+    for (int it_open = 0; it_open < 2; ++it_open)
+    {
+        A_UTILS_TEST_RESULT(reader.open(TEST_FILES_DIR "/test_history.dat", -1, OpenMode::om_dense_index));
+        A_UTILS_TEST(reader.hasDenseIndex());
+        A_UTILS_TEST(a_util::filesystem::exists(dense_index_file));
+
+        // building the index leaves the reader at the beginning of data
+        A_UTILS_TEST(reader.getCurrentPos(TimeFormat::tf_chunk_index) == 0);
+
+        std::map<uint16_t, int64_t> stream_counts;
+        for (int64_t it_chunk = 0; it_chunk < static_cast<int64_t>(chunks.size()); ++it_chunk)
+        {
+            const Chunk& chunk = chunks[it_chunk];
+
+            check_seek(0, it_chunk, TimeFormat::tf_chunk_index, 0, it_chunk);
+            check_seek(chunk.stream_id, chunk.time_stamp, TimeFormat::tf_chunk_time, 0,
+                       find_after(chunk.stream_id, chunk.time_stamp));
+            check_seek(chunk.stream_id, stream_counts[chunk.stream_id]++, TimeFormat::tf_stream_index, 0, it_chunk);
+
+            int64_t before_index = find_before(chunk.stream_id, chunk.time_stamp);
+            if (before_index >= 0)
+            {
+                check_seek(chunk.stream_id, chunk.time_stamp - 1, TimeFormat::tf_chunk_time, SeekFlags::sf_before, before_index);
+            }
+        }
+
+        A_UTILS_TEST_ERR_RESULT(reader.seek(1, chunks.back().time_stamp + 1, TimeFormat::tf_chunk_time));
+        A_UTILS_TEST_RESULT(reader.close());
+    }
+
+    // the stored index of another file is not used
+    const std::string other_file = TEST_FILES_DIR "/reader_test_file.dat";
+    const std::string other_dense_index_file = IndexedFileReader::getDenseIndexFileName(other_file);
+    {
+        std::ifstream source(dense_index_file, std::ios::binary);
+        std::ofstream destination(other_dense_index_file, std::ios::binary | std::ios::trunc);
+        destination << source.rdbuf();
+    }
+    A_UTILS_TEST_RESULT(reader.open(other_file, -1, OpenMode::om_dense_index));
+    A_UTILS_TEST(reader.hasDenseIndex());
+    for (int64_t it_chunk = static_cast<int64_t>(reader.getChunkCount()) - 1; it_chunk >= 0; --it_chunk)
+    {
+        A_UTILS_TEST(reader.seek(0, it_chunk, TimeFormat::tf_chunk_index) == it_chunk);
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+    }
+    A_UTILS_TEST_RESULT(reader.close());
+
+    // a truncated index is not used, it is replaced by a complete one
+    std::string dense_index;
+    {
+        std::ifstream source(dense_index_file, std::ios::binary);
+        dense_index.assign(std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>());
+        std::ofstream destination(dense_index_file, std::ios::binary | std::ios::trunc);
+        destination.write(dense_index.data(), dense_index.size() - sizeof(uint64_t));
+    }
+    A_UTILS_TEST_RESULT(reader.open(TEST_FILES_DIR "/test_history.dat", -1, OpenMode::om_dense_index));
+    A_UTILS_TEST(reader.hasDenseIndex());
+    A_UTILS_TEST_RESULT(reader.close());
+    {
+        std::ifstream source(dense_index_file, std::ios::binary);
+        A_UTILS_TEST(std::string(std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>()) == dense_index);
+    }
+    A_UTILS_TEST(!a_util::filesystem::exists(dense_index_file + ".tmp"));
+
+    a_util::filesystem::remove(dense_index_file);
+    a_util::filesystem::remove(other_dense_index_file);
+}
+
+DEFINE_TEST(TesterIndexedFileReader,
+            TestReadAhead,
+            "1.16",
+            "TestReadAhead",
+            "Test reading with a read-ahead thread, also across the ring buffer wrap and after seeking",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+
+    for (const char* filename: {TEST_FILES_DIR "/reader_test_file.dat",
+                                TEST_FILES_DIR "/reader_test_file_two_streams.dat",
+                                TEST_FILES_DIR "/test_history.dat"})
+    {
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(filename));
+        A_UTILS_TEST(!reader.isReadingAhead());
+
+        std::vector<std::string> chunks;
+        for (uint64_t it_chunk = 0; it_chunk < reader.getChunkCount(); ++it_chunk)
+        {
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            chunks.push_back(std::string(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader)));
+        }
+        A_UTILS_TEST_RESULT(reader.close());
+
+        // a small window, so that the read-ahead thread has to wait for the reader
+        for (size_t window_size: {static_cast<size_t>(4 * 1024), static_cast<size_t>(64 * 1024 * 1024)})
+        {
+            reader.setReadAheadWindow(window_size);
+            A_UTILS_TEST_RESULT(reader.open(filename, -1, OpenMode::om_read_ahead | OpenMode::om_dense_index));
+            A_UTILS_TEST(reader.isReadingAhead());
+
+            for (const auto& expected_data: chunks)
+            {
+                ChunkHeader* chunk;
+                void* data;
+                A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+                A_UTILS_TEST(std::string(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader)) == expected_data);
+            }
+
+            // seeking invalidates the prefetched data
+            for (int64_t it_chunk = static_cast<int64_t>(chunks.size()) - 1; it_chunk >= 0; it_chunk -= 3)
+            {
+                A_UTILS_TEST(reader.seek(0, it_chunk, TimeFormat::tf_chunk_index) == it_chunk);
+                for (int64_t it_read = it_chunk; it_read < std::min<int64_t>(it_chunk + 2, chunks.size()); ++it_read)
+                {
+                    ChunkHeader* chunk;
+                    void* data;
+                    A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+                    A_UTILS_TEST(std::string(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader)) == chunks[it_read]);
+                }
+            }
+
+            A_UTILS_TEST_RESULT(reader.close());
+            A_UTILS_TEST(!reader.isReadingAhead());
+        }
+
+        a_util::filesystem::remove(IndexedFileReader::getDenseIndexFileName(filename));
+    }
+}
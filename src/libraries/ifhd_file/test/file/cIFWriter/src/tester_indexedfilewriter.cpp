@@ -22,10 +22,15 @@
 #include "gtest/gtest.h"
 #include <ifhd/ifhd.h> 
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <fstream>
 #include "../../test_helper/test_helper.h"
 
 #define TESTFILE TEST_FILES_DIR "/test_dat_file.dat"
 #define TESTFILEHISTORY TEST_FILES_DIR "/test_history_dat_file.dat"
+#define TESTFILECRASHED TEST_FILES_DIR "/test_crashed_dat_file.dat"
 
 
 DEFINE_TEST(TesterIndexedFileWriter,
@@ -82,6 +87,10 @@ DEFINE_TEST(TesterIndexedFileWriter,
     A_UTILS_TEST_RESULT(writer.writeChunk(11,data,255,56,ChunkType::ct_data));
     A_UTILS_TEST_RESULT(writer.writeChunk(12,data,255,57, ChunkType::ct_data));
     A_UTILS_TEST_RESULT(writer.writeChunk(13,data,255,59, ChunkType::ct_data));
+    A_UTILS_TEST_ERR_RESULT_EXT(writer.writeChunk(0,data,255,60, ChunkType::ct_data),
+        "a chunk needs a stream id");
+    A_UTILS_TEST_ERR_RESULT_EXT(writer.writeChunk(MAX_INDEXED_STREAMS + 1,data,255,60, ChunkType::ct_data),
+        "accepted a stream id out of range");
     writer.close();
     IndexedFileReader reader;
     ChunkHeader *chunk_header;
@@ -350,3 +359,1264 @@ DEFINE_TEST(TesterIndexedFileWriter,
     }
 }
 
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestConcurrentWrite,
+            "1.6",
+            "TestConcurrentWrite",
+            "Test that chunks of concurrent producers are all written in order.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint16_t stream_count = 8;
+    const size_t chunk_count = 5000;
+
+    {
+        IndexedFileWriter writer;
+        A_UTILS_TEST_RESULT(writer.create(TESTFILE, 0, OpenMode::om_concurrent_write));
+
+        std::vector<std::thread> threads;
+        for (uint16_t stream = 1; stream <= stream_count; ++stream)
+        {
+            // a small queue to make sure that producers have to wait every now and then
+            auto& producer = writer.createProducer(4096);
+            threads.emplace_back([&producer, stream, chunk_count]
+            {
+                for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+                {
+                    std::string helper = a_util::strings::format("@%d|%d", stream, chunk);
+                    producer.writeChunk(stream, helper.c_str(), static_cast<uint32_t>(helper.length()),
+                                        static_cast<timestamp_t>(chunk), ChunkType::ct_data);
+                }
+
+                // chunks that do not fit into the queue are written directly
+                std::vector<uint8_t> large_chunk(8192, static_cast<uint8_t>(stream));
+                producer.writeChunk(stream, large_chunk.data(), static_cast<uint32_t>(large_chunk.size()),
+                                    static_cast<timestamp_t>(chunk_count), ChunkType::ct_data);
+            });
+        }
+
+        for (auto& thread: threads)
+        {
+            thread.join();
+        }
+
+        A_UTILS_TEST_RESULT(writer.close());
+    }
+
+    IndexedFileReader reader;
+    A_UTILS_TEST_RESULT(reader.open(TESTFILE));
+    A_UTILS_TEST(reader.getChunkCount() == stream_count * (chunk_count + 1));
+
+    std::vector<size_t> next_chunk(stream_count + 1, 0);
+    for (uint64_t it_chunk = 0; it_chunk < reader.getChunkCount(); ++it_chunk)
+    {
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+        A_UTILS_TEST(chunk->stream_id >= 1 && chunk->stream_id <= stream_count);
+
+        size_t& expected_chunk = next_chunk[chunk->stream_id];
+        A_UTILS_TEST(chunk->stream_index == expected_chunk);
+        if (expected_chunk < chunk_count)
+        {
+            std::string helper(static_cast<char*>(data), chunk->size - sizeof(ChunkHeader));
+            A_UTILS_TEST(helper == a_util::strings::format("@%d|%d", chunk->stream_id, expected_chunk));
+
+            A_UTILS_TEST(chunk->time_stamp == expected_chunk);
+        }
+        else
+        {
+            A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == 8192);
+            A_UTILS_TEST(*static_cast<uint8_t*>(data) == chunk->stream_id);
+        }
+        ++expected_chunk;
+    }
+
+    // chunks that the merge thread fails to write are reported by close
+    {
+        IndexedFileWriter writer;
+        A_UTILS_TEST_RESULT(writer.create(TESTFILE, 64 * 1024,
+                                          OpenMode::om_concurrent_write | OpenMode::om_fail_if_cache_full));
+        auto& producer = writer.createProducer();
+        std::vector<uint8_t> chunk_larger_than_cache(128 * 1024, 0);
+        A_UTILS_TEST_RESULT(producer.writeChunk(1, chunk_larger_than_cache.data(),
+                                                static_cast<uint32_t>(chunk_larger_than_cache.size()),
+                                                0, ChunkType::ct_data));
+        A_UTILS_TEST_ERR_RESULT(writer.close());
+        A_UTILS_TEST_RESULT(writer.close());
+    }
+}
+
+// a benchmark, run it explicitly with --gtest_also_run_disabled_tests, the results are
+// recorded as test properties
+DEFINE_TEST(TesterIndexedFileWriter,
+            DISABLED_TestConcurrentWriteScaling,
+            "1.7",
+            "TestConcurrentWriteScaling",
+            "Benchmark of 1 to 32 producer threads, with producers and with a shared mutex.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const size_t total_chunk_count = 256 * 1024;
+    const std::vector<uint8_t> payload(256, 0xAB);
+
+    for (size_t thread_count = 1; thread_count <= 32; thread_count *= 2)
+    {
+        const size_t chunk_count = total_chunk_count / thread_count;
+        double chunks_per_second[2];
+
+        for (int use_producers = 0; use_producers < 2; ++use_producers)
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_RESULT(writer.create(TESTFILE, 0, use_producers ? OpenMode::om_concurrent_write : 0));
+
+            std::mutex writer_mutex;
+            std::vector<IndexedFileWriter::ChunkProducer*> producers;
+            for (size_t thread = 0; thread < thread_count && use_producers; ++thread)
+            {
+                producers.push_back(&writer.createProducer());
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<std::thread> threads;
+            for (size_t thread = 0; thread < thread_count; ++thread)
+            {
+                threads.emplace_back([&, thread]
+                {
+                    uint16_t stream = static_cast<uint16_t>(thread + 1);
+                    for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+                    {
+                        timestamp_t time_stamp = static_cast<timestamp_t>(chunk);
+                        if (use_producers)
+                        {
+                            producers[thread]->writeChunk(stream, payload.data(), static_cast<uint32_t>(payload.size()),
+                                                          time_stamp, ChunkType::ct_data);
+                        }
+                        else
+                        {
+                            std::lock_guard<std::mutex> lock(writer_mutex);
+                            writer.writeChunk(stream, payload.data(), static_cast<uint32_t>(payload.size()),
+                                              time_stamp, ChunkType::ct_data);
+                        }
+                    }
+                });
+            }
+
+            for (auto& thread: threads)
+            {
+                thread.join();
+            }
+
+            A_UTILS_TEST_RESULT(writer.close());
+
+            std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+            chunks_per_second[use_producers] = (chunk_count * thread_count) / duration.count();
+
+            IndexedFileReader reader;
+            A_UTILS_TEST_RESULT(reader.open(TESTFILE));
+            A_UTILS_TEST(reader.getChunkCount() == chunk_count * thread_count);
+        }
+
+        RecordProperty(a_util::strings::format("chunks_per_second_%d_threads_mutex", static_cast<int>(thread_count)),
+                       static_cast<int>(chunks_per_second[0]));
+        RecordProperty(a_util::strings::format("chunks_per_second_%d_threads_producers", static_cast<int>(thread_count)),
+                       static_cast<int>(chunks_per_second[1]));
+    }
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestCacheFullPolicies,
+            "1.8",
+            "TestCacheFullPolicies",
+            "Test the behaviour of the internal cache if a chunk does not fit into it.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const size_t cache_size = 64 * 1024;
+    const std::vector<uint8_t> large_chunk(2 * cache_size, 0xFF);
+
+    for (uint32_t policy: {0, static_cast<int>(OpenMode::om_drop_chunks_if_cache_full),
+                           static_cast<int>(OpenMode::om_fail_if_cache_full)})
+    {
+        IndexedFileWriter writer;
+        A_UTILS_TEST_RESULT(writer.create(TESTFILE, cache_size, policy));
+
+        std::vector<uint8_t> written_chunks;
+        for (uint8_t idx = 0; idx < 16; ++idx)
+        {
+            std::vector<uint8_t> data(2048, idx);
+            A_UTILS_TEST_RESULT(writer.writeChunk(1, data.data(), static_cast<uint32_t>(data.size()), idx, ChunkType::ct_data));
+            written_chunks.push_back(idx);
+
+            if (idx == 7)
+            {
+                if (policy & OpenMode::om_fail_if_cache_full)
+                {
+                    A_UTILS_TEST_ERR_RESULT(writer.writeChunk(1, large_chunk.data(), static_cast<uint32_t>(large_chunk.size()),
+                                                              idx, ChunkType::ct_data));
+                }
+                else
+                {
+                    // blocks until the chunk has been written piecewise or drops it
+                    A_UTILS_TEST_RESULT(writer.writeChunk(1, large_chunk.data(), static_cast<uint32_t>(large_chunk.size()),
+                                                          idx, ChunkType::ct_data));
+                    if (policy == 0)
+                    {
+                        written_chunks.push_back(0xFF);
+                    }
+                }
+            }
+        }
+
+        IndexedFileWriter::CacheStatistics statistics = writer.getCacheStatistics();
+        A_UTILS_TEST(statistics.high_water_mark > 0);
+        A_UTILS_TEST(statistics.high_water_mark <= static_cast<int>(cache_size));
+        A_UTILS_TEST(statistics.dropped_chunks == ((policy & OpenMode::om_drop_chunks_if_cache_full) ? 1 : 0));
+        if (policy == 0)
+        {
+            // the large chunk does not fit into the cache at once
+            A_UTILS_TEST(statistics.stall_count > 0);
+        }
+
+        A_UTILS_TEST_RESULT(writer.close());
+
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(TESTFILE));
+        A_UTILS_TEST(reader.getChunkCount() == written_chunks.size());
+
+        for (size_t idx = 0; idx < written_chunks.size(); ++idx)
+        {
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            A_UTILS_TEST(chunk->stream_index == idx);
+            A_UTILS_TEST(*static_cast<uint8_t*>(data) == written_chunks[idx]);
+        }
+    }
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestDisabledFileSystemCache,
+            "1.9",
+            "TestDisabledFileSystemCache",
+            "Test writing and reading with unbuffered (direct) file access.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint32_t chunk_count = 500;
+
+    for (uint32_t flags: {static_cast<uint32_t>(OpenMode::om_disable_file_system_cache),
+                          static_cast<uint32_t>(OpenMode::om_disable_file_system_cache | OpenMode::om_sync_write)})
+    {
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_RESULT(writer.create(TESTFILE, 256 * 1024, flags));
+            A_UTILS_TEST_RESULT(writer.setStreamName(1, "direct"));
+            for (uint32_t idx = 0; idx < chunk_count; ++idx)
+            {
+                // odd sizes, so that chunks are not aligned to sectors
+                std::vector<uint8_t> data(idx * 37 % 5000 + 1, static_cast<uint8_t>(idx));
+                A_UTILS_TEST_RESULT(writer.writeChunk(1, data.data(), static_cast<uint32_t>(data.size()),
+                                                      idx, ChunkType::ct_data));
+            }
+            A_UTILS_TEST_RESULT(writer.close());
+        }
+
+        for (uint32_t read_flags: {0u, static_cast<uint32_t>(OpenMode::om_disable_file_system_cache)})
+        {
+            IndexedFileReader reader;
+            A_UTILS_TEST_RESULT(reader.open(TESTFILE, -1, read_flags));
+            A_UTILS_TEST(reader.getChunkCount() == chunk_count);
+            A_UTILS_TEST(std::string("direct") == reader.getStreamName(1));
+
+            for (uint32_t idx = 0; idx < chunk_count; ++idx)
+            {
+                ChunkHeader* chunk;
+                void* data;
+                A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+                A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == idx * 37 % 5000 + 1);
+                A_UTILS_TEST(static_cast<uint8_t*>(data)[0] == static_cast<uint8_t>(idx));
+                A_UTILS_TEST(static_cast<uint8_t*>(data)[chunk->size - sizeof(ChunkHeader) - 1] == static_cast<uint8_t>(idx));
+            }
+        }
+    }
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestReserveChunk,
+            "1.10",
+            "TestReserveChunk",
+            "Test writing chunks in place via reserveChunk and commitChunk.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const size_t cache_size = 64 * 1024;
+    const uint32_t chunk_count = 200;
+
+    auto get_chunk_size = [](uint32_t idx) -> uint32_t
+    {
+        // some of the chunks wrap around the end of the cache
+        return (idx * 797) % 9000 + 1;
+    };
+
+    for (uint32_t flags: {0u,
+                          static_cast<uint32_t>(OpenMode::om_sync_write),
+                          static_cast<uint32_t>(OpenMode::om_concurrent_write)})
+    {
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_RESULT(writer.create(TESTFILE, cache_size, flags));
+
+            A_UTILS_TEST_ERR_RESULT(writer.commitChunk(1, 0, ChunkType::ct_data));
+
+            for (uint32_t idx = 0; idx < chunk_count; ++idx)
+            {
+                IndexedFileWriter::ChunkReservation reservation;
+                if (idx % 10 == 0)
+                {
+                    // an abandoned reservation
+                    A_UTILS_TEST_RESULT(writer.reserveChunk(get_chunk_size(idx + 1), reservation));
+                    memset(reservation.data[0], 0xFF, reservation.data_size[0]);
+                }
+
+                A_UTILS_TEST_RESULT(writer.reserveChunk(get_chunk_size(idx), reservation));
+                A_UTILS_TEST(reservation.data_size[0] + reservation.data_size[1] == get_chunk_size(idx));
+                for (size_t piece = 0; piece < 2; ++piece)
+                {
+                    memset(reservation.data[piece], static_cast<uint8_t>(idx), reservation.data_size[piece]);
+                }
+                A_UTILS_TEST_RESULT(writer.commitChunk(1, idx, ChunkType::ct_data));
+            }
+
+            A_UTILS_TEST_ERR_RESULT(writer.commitChunk(1, chunk_count, ChunkType::ct_data));
+            A_UTILS_TEST_RESULT(writer.close());
+        }
+
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(TESTFILE));
+        A_UTILS_TEST(reader.getChunkCount() == chunk_count);
+
+        for (uint32_t idx = 0; idx < chunk_count; ++idx)
+        {
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            A_UTILS_TEST(chunk->time_stamp == idx);
+            A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == get_chunk_size(idx));
+            const std::vector<uint8_t> expected_data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+            A_UTILS_TEST(memcmp(data, expected_data.data(), expected_data.size()) == 0);
+        }
+    }
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestChunkCompression,
+            "1.11",
+            "TestChunkCompression",
+            "Test compressed chunks and their transparent decompression.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint32_t chunk_count = 300;
+
+    auto get_chunk_data = [](uint32_t idx) -> std::vector<uint8_t>
+    {
+        std::vector<uint8_t> data((idx * 797) % 20000 + 1);
+        uint32_t random = idx + 1;
+        for (size_t pos = 0; pos < data.size(); ++pos)
+        {
+            // every fifth chunk is not compressible
+            random = random * 1103515245 + 12345;
+            data[pos] = idx % 5 == 0 ? static_cast<uint8_t>(random >> 24) :
+                                       static_cast<uint8_t>(pos / 64 + idx);
+        }
+        return data;
+    };
+
+    for (CompressionCodec codec: {CompressionCodec::cc_lz4, CompressionCodec::cc_zstd})
+    {
+        if (!isCompressionCodecAvailable(codec))
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_RESULT(writer.create(TESTFILE));
+            A_UTILS_TEST_ERR_RESULT(writer.setStreamCompression(1, codec));
+            continue;
+        }
+
+        for (uint32_t flags: {0u, static_cast<uint32_t>(OpenMode::om_concurrent_write)})
+        {
+            uint64_t uncompressed_size = 0;
+            size_t max_data_size = 0;
+            {
+                IndexedFileWriter writer;
+                A_UTILS_TEST_RESULT(writer.create(TESTFILE, 0, flags));
+                // not supported by the default version
+                A_UTILS_TEST_ERR_RESULT(writer.setStreamCompression(1, codec));
+
+                FileHeader* header;
+                writer.getHeaderRef(&header);
+                header->version_id = version_id;
+                A_UTILS_TEST_RESULT(writer.setStreamCompression(1, codec));
+
+                IndexedFileWriter::ChunkProducer* producer = nullptr;
+                if (flags & OpenMode::om_concurrent_write)
+                {
+                    producer = &writer.createProducer(16 * 1024);
+                }
+
+                for (uint32_t idx = 0; idx < chunk_count; ++idx)
+                {
+                    auto data = get_chunk_data(idx);
+                    uncompressed_size += data.size();
+                    max_data_size = std::max(max_data_size, data.size());
+                    const uint16_t stream_id = idx % 3 == 0 ? 2 : 1;
+                    if (producer)
+                    {
+                        A_UTILS_TEST_RESULT(producer->writeChunk(stream_id, data.data(), static_cast<uint32_t>(data.size()), idx, ChunkType::ct_data));
+                    }
+                    else
+                    {
+                        A_UTILS_TEST_RESULT(writer.writeChunk(stream_id, data.data(), static_cast<uint32_t>(data.size()), idx, ChunkType::ct_data));
+                    }
+                }
+
+                A_UTILS_TEST_ERR_RESULT(writer.writeChunk(1, "x", 1, chunk_count, ChunkType::ct_compressed));
+                A_UTILS_TEST_RESULT(writer.close());
+            }
+
+            {
+                // readers that do not support compressed chunks reject the file
+                ifhd::v201_v301::IndexedFileReader reader;
+                A_UTILS_TEST_ERR_RESULT(reader.open(TESTFILE));
+            }
+
+            IndexedFileReader reader;
+            A_UTILS_TEST_RESULT(reader.open(TESTFILE));
+            A_UTILS_TEST(reader.getVersionId() == version_id_with_compression);
+            A_UTILS_TEST(reader.getChunkCount() == chunk_count);
+
+            FileHeader* header;
+            reader.getHeaderRef(&header);
+            // readers need to be able to hold the decompressed chunks
+            A_UTILS_TEST(header->max_chunk_size == max_data_size + sizeof(ChunkHeader));
+            // the chunks of the second stream and every fifth chunk are stored uncompressed
+            A_UTILS_TEST(header->data_size < uncompressed_size * 3 / 5);
+
+            std::vector<uint8_t> external_buffer(static_cast<size_t>(header->max_chunk_size));
+            for (uint32_t idx = 0; idx < chunk_count; ++idx)
+            {
+                const auto expected_data = get_chunk_data(idx);
+
+                ChunkHeader* chunk;
+                A_UTILS_TEST_RESULT(reader.queryChunkInfo(&chunk));
+                A_UTILS_TEST(((chunk->flags & ChunkType::ct_compressed) != 0) == (idx % 3 != 0 && idx % 5 != 0));
+
+                void* data = external_buffer.data();
+                A_UTILS_TEST_RESULT(reader.readChunk(&data, idx % 2 ? ReadFlags::rf_use_external_buffer : 0));
+                A_UTILS_TEST((chunk->flags & ChunkType::ct_compressed) == 0);
+                A_UTILS_TEST(chunk->time_stamp == idx);
+                A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == expected_data.size());
+                A_UTILS_TEST(memcmp(data, expected_data.data(), expected_data.size()) == 0);
+            }
+
+            // the chunk has been prefetched by seeking
+            A_UTILS_TEST(reader.seek(0, 101, TimeFormat::tf_chunk_time) == 101);
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            const auto expected_data = get_chunk_data(101);
+            A_UTILS_TEST(chunk->time_stamp == 101);
+            A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == expected_data.size());
+            A_UTILS_TEST(memcmp(data, expected_data.data(), expected_data.size()) == 0);
+        }
+    }
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestIndexJournal,
+            "1.12",
+            "TestIndexJournal",
+            "Test the recovery of files that have not been closed via the index journal.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint32_t chunk_count = 200;
+
+    auto get_chunk_size = [](uint32_t idx) -> uint32_t
+    {
+        return (idx * 37) % 500 + 1;
+    };
+
+    // copies the open files as they would be found after a crash
+    auto copy_file = [](const std::string& source, const std::string& destination, std::streamoff cut_off)
+    {
+        std::ifstream input(source, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        data.resize(static_cast<size_t>(std::max<std::streamoff>(0, static_cast<std::streamoff>(data.size()) - cut_off)));
+        std::ofstream output(destination, std::ios::binary | std::ios::trunc);
+        output.write(data.data(), static_cast<std::streamsize>(data.size()));
+    };
+
+    // a short interval stores all chunks in checkpoints, a long one requires scanning the chunks
+    for (timestamp_t interval: {timestamp_t(0), timestamp_t(1000000000)})
+    {
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_ERR_RESULT(writer.create(TESTFILE, 0, OpenMode::om_index_journal, 0, 1000));
+            A_UTILS_TEST_RESULT(writer.create(TESTFILE, 0, OpenMode::om_sync_write | OpenMode::om_index_journal));
+            writer.setIndexJournalInterval(interval);
+            A_UTILS_TEST(a_util::filesystem::exists(IndexedFileWriter::getIndexJournalFileName(TESTFILE)));
+
+            writer.setStreamName(1, "first");
+            writer.setStreamName(2, "second");
+            const std::string info = "additional info";
+            writer.setAdditionalStreamInfo(2, info.c_str(), info.size() + 1, false);
+
+            for (uint32_t idx = 0; idx < chunk_count; ++idx)
+            {
+                const std::vector<uint8_t> data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+                A_UTILS_TEST_RESULT(writer.writeChunk(idx % 4 == 0 ? 2 : 1, data.data(), static_cast<uint32_t>(data.size()), idx,
+                                                      idx % 10 == 0 ? ChunkType::ct_keydata : ChunkType::ct_data));
+            }
+
+            // the last chunk is incomplete
+            copy_file(TESTFILE, TESTFILECRASHED, 7);
+            copy_file(IndexedFileWriter::getIndexJournalFileName(TESTFILE),
+                      IndexedFileWriter::getIndexJournalFileName(TESTFILECRASHED), 0);
+
+            A_UTILS_TEST_RESULT(writer.close());
+            A_UTILS_TEST(!a_util::filesystem::exists(IndexedFileWriter::getIndexJournalFileName(TESTFILE)));
+        }
+
+        {
+            IndexedFileReader reader;
+            A_UTILS_TEST_ERR_RESULT(reader.open(TESTFILECRASHED));
+        }
+
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_ERR_RESULT(writer.recover(TESTFILE));
+            A_UTILS_TEST_RESULT(writer.recover(TESTFILECRASHED));
+            A_UTILS_TEST(!a_util::filesystem::exists(IndexedFileWriter::getIndexJournalFileName(TESTFILECRASHED)));
+        }
+
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(TESTFILECRASHED));
+        A_UTILS_TEST(reader.getChunkCount() == chunk_count - 1);
+        A_UTILS_TEST(reader.getStreamName(1) == "first");
+        A_UTILS_TEST(reader.getStreamName(2) == "second");
+        const void* info_data;
+        size_t info_size;
+        reader.getAdditionalStreamInfo(2, &info_data, &info_size);
+        A_UTILS_TEST(info_size == 16 && std::string(static_cast<const char*>(info_data)) == "additional info");
+
+        for (uint32_t idx = 0; idx < chunk_count - 1; ++idx)
+        {
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            A_UTILS_TEST(chunk->time_stamp == idx);
+            A_UTILS_TEST(chunk->stream_id == (idx % 4 == 0 ? 2 : 1));
+            A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == get_chunk_size(idx));
+            const std::vector<uint8_t> expected_data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+            A_UTILS_TEST(memcmp(data, expected_data.data(), expected_data.size()) == 0);
+        }
+
+        // seeking uses the recovered index
+        A_UTILS_TEST(reader.seek(0, 151, TimeFormat::tf_chunk_time) == 151);
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+        A_UTILS_TEST(chunk->time_stamp == 151);
+    }
+
+    // with the cache writing thread the checkpoints of the journal run ahead of a truncated file
+    {
+        IndexedFileWriter writer;
+        A_UTILS_TEST_RESULT(writer.create(TESTFILE, 16 * 1024, OpenMode::om_index_journal, 0, 0, 0, 4096));
+        writer.setIndexJournalInterval(0);
+
+        // the cache is smaller than the chunks, so most of them are on disk
+        for (uint32_t idx = 0; idx < chunk_count; ++idx)
+        {
+            const std::vector<uint8_t> data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+            A_UTILS_TEST_RESULT(writer.writeChunk(1, data.data(), static_cast<uint32_t>(data.size()), idx, ChunkType::ct_data));
+        }
+
+        std::ifstream written_file(TESTFILE, std::ios::binary | std::ios::ate);
+        copy_file(TESTFILE, TESTFILECRASHED, static_cast<std::streamoff>(written_file.tellg()) / 2);
+        copy_file(IndexedFileWriter::getIndexJournalFileName(TESTFILE),
+                  IndexedFileWriter::getIndexJournalFileName(TESTFILECRASHED), 0);
+        A_UTILS_TEST_RESULT(writer.close());
+    }
+
+    {
+        IndexedFileWriter writer;
+        A_UTILS_TEST_RESULT(writer.recover(TESTFILECRASHED));
+    }
+
+    A_UTILS_TEST(a_util::filesystem::exists(IndexedFileWriter::getBackupFileName(TESTFILECRASHED)));
+    a_util::filesystem::remove(IndexedFileWriter::getBackupFileName(TESTFILECRASHED));
+
+    IndexedFileReader reader;
+    A_UTILS_TEST_RESULT(reader.open(TESTFILECRASHED));
+    A_UTILS_TEST(reader.getChunkCount() > 0 && reader.getChunkCount() < chunk_count);
+    for (uint32_t idx = 0; idx < reader.getChunkCount(); ++idx)
+    {
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+        A_UTILS_TEST(chunk->time_stamp == idx);
+        A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == get_chunk_size(idx));
+        const std::vector<uint8_t> expected_data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+        A_UTILS_TEST(memcmp(data, expected_data.data(), expected_data.size()) == 0);
+    }
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestRepair,
+            "1.13",
+            "TestRepair",
+            "Test rebuilding the index of unclosed and truncated files.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint32_t chunk_count = 30000;
+
+    auto get_chunk_size = [](uint32_t idx) -> uint32_t
+    {
+        return (idx * 131) % 400 + 1;
+    };
+
+    auto copy_file = [](const std::string& source, const std::string& destination, uint64_t size)
+    {
+        std::ifstream input(source, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        data.resize(std::min<size_t>(data.size(), static_cast<size_t>(size)));
+        std::ofstream output(destination, std::ios::binary | std::ios::trunc);
+        output.write(data.data(), static_cast<std::streamsize>(data.size()));
+    };
+
+    auto check_file = [&](uint32_t expected_chunk_count, uint32_t damaged_chunk)
+    {
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(TESTFILECRASHED));
+        A_UTILS_TEST(reader.getChunkCount() == expected_chunk_count);
+        uint64_t stream_index_count[3] = {0, 0, 0};
+        for (uint32_t idx = 0; idx < expected_chunk_count + (damaged_chunk < expected_chunk_count ? 1 : 0); ++idx)
+        {
+            if (idx == damaged_chunk)
+            {
+                continue;
+            }
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            A_UTILS_TEST(chunk->time_stamp == idx);
+            A_UTILS_TEST(chunk->stream_id == idx % 3 + 1);
+            A_UTILS_TEST(chunk->stream_index == stream_index_count[idx % 3]++);
+            A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == get_chunk_size(idx));
+            const std::vector<uint8_t> expected_data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+            A_UTILS_TEST(memcmp(data, expected_data.data(), expected_data.size()) == 0);
+        }
+
+        // seek returns the chunk index
+        A_UTILS_TEST(reader.seek(0, 20000, TimeFormat::tf_chunk_time) == (damaged_chunk < 20000 ? 19999 : 20000));
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+        A_UTILS_TEST(chunk->time_stamp == 20000);
+    };
+
+    uint64_t data_end = 0;
+    {
+        IndexedFileWriter writer;
+        A_UTILS_TEST_RESULT(writer.create(TESTFILE, 0, OpenMode::om_sync_write));
+        for (uint32_t idx = 0; idx < chunk_count; ++idx)
+        {
+            const std::vector<uint8_t> data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+            A_UTILS_TEST_RESULT(writer.writeChunk(idx % 3 + 1, data.data(), static_cast<uint32_t>(data.size()), idx,
+                                                  ChunkType::ct_data));
+        }
+
+        // a file that has not been closed
+        copy_file(TESTFILE, TESTFILECRASHED, UINT64_MAX);
+        A_UTILS_TEST_RESULT(writer.close());
+    }
+
+    {
+        IndexedFileReader reader;
+        A_UTILS_TEST_ERR_RESULT(reader.open(TESTFILECRASHED));
+    }
+
+    IndexedFileWriter writer;
+    A_UTILS_TEST_RESULT(writer.repair(TESTFILECRASHED, 4));
+    check_file(chunk_count, UINT32_MAX);
+
+    // a closed file whose index and last chunk have been cut off
+    {
+        FileHeader header;
+        getHeader(TESTFILE, header);
+        data_end = header.data_offset + header.data_size;
+    }
+    copy_file(TESTFILE, TESTFILECRASHED, data_end - 5);
+    A_UTILS_TEST_RESULT(writer.repair(TESTFILECRASHED, 4));
+    check_file(chunk_count - 1, UINT32_MAX);
+
+    // a single thread finds the same chunks
+    copy_file(TESTFILE, TESTFILECRASHED, data_end);
+    A_UTILS_TEST_RESULT(writer.repair(TESTFILECRASHED, 1));
+    check_file(chunk_count, UINT32_MAX);
+
+    // the chunks behind a damaged chunk header are kept
+    const uint32_t damaged_chunk = 15000;
+    uint64_t damaged_chunk_pos = 0;
+    {
+        FileHeader header;
+        getHeader(TESTFILE, header);
+        damaged_chunk_pos = header.data_offset;
+        for (uint32_t idx = 0; idx < damaged_chunk; ++idx)
+        {
+            damaged_chunk_pos += (sizeof(ChunkHeader) + get_chunk_size(idx) + 0xF) & ~0xF;
+        }
+    }
+    copy_file(TESTFILE, TESTFILECRASHED, data_end);
+    {
+        std::fstream file(TESTFILECRASHED, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(damaged_chunk_pos));
+        const std::vector<char> garbage(sizeof(ChunkHeader), static_cast<char>(0xFF));
+        file.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+    }
+    auto read_file = [](const std::string& file_name)
+    {
+        std::ifstream input(file_name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    };
+    const std::string damaged_file = read_file(TESTFILECRASHED);
+    A_UTILS_TEST_RESULT(writer.repair(TESTFILECRASHED, 4));
+    check_file(chunk_count - 1, damaged_chunk);
+
+    // the file is kept as it was found
+    const std::string backup_file_name = IndexedFileWriter::getBackupFileName(TESTFILECRASHED);
+    A_UTILS_TEST(read_file(backup_file_name) == damaged_file);
+    a_util::filesystem::remove(backup_file_name);
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestIndexMemoryLimit,
+            "1.14",
+            "TestIndexMemoryLimit",
+            "Test spilling the index of long recordings to a temporary file.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint32_t chunk_count = 5000;
+    const std::string spill_file_name = std::string(TESTFILE) + ".ifhd_index";
+
+    {
+        IndexedFileWriter writer;
+        writer.setIndexMemoryLimit(100);
+        A_UTILS_TEST_ERR_RESULT(writer.create(TESTFILE, 0, 0, 0, 1000));
+        A_UTILS_TEST_RESULT(writer.create(TESTFILE));
+        writer.setStreamName(1, "first");
+        writer.setStreamName(2, "second");
+
+        for (uint32_t idx = 0; idx < chunk_count; ++idx)
+        {
+            A_UTILS_TEST_RESULT(writer.writeChunk(idx % 2 + 1, &idx, sizeof(idx), idx, ChunkType::ct_keydata));
+        }
+
+        A_UTILS_TEST(a_util::filesystem::exists(spill_file_name));
+        A_UTILS_TEST_RESULT(writer.close());
+        A_UTILS_TEST(!a_util::filesystem::exists(spill_file_name));
+    }
+
+    IndexedFileReader reader;
+    A_UTILS_TEST_RESULT(reader.open(TESTFILE));
+    A_UTILS_TEST(reader.getChunkCount() == chunk_count);
+    A_UTILS_TEST(reader.getStreamTableIndexCount(0) == chunk_count);
+
+    for (uint32_t idx: {0u, 1u, 49u, 50u, 2500u, 4999u})
+    {
+        A_UTILS_TEST(reader.seek(0, idx, TimeFormat::tf_chunk_index) == idx);
+        ChunkHeader* chunk;
+        void* data;
+        A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+        A_UTILS_TEST(chunk->time_stamp == idx);
+        A_UTILS_TEST(*static_cast<uint32_t*>(data) == idx);
+    }
+
+    A_UTILS_TEST(reader.seek(2, 1200, TimeFormat::tf_stream_index) == 2401);
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestIndexExtensions,
+            "1.15",
+            "TestIndexExtensions",
+            "Test the index extensions that are written at close, with and without the file system cache.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    // the master index exceeds a single write block
+    const uint32_t chunk_count = 200000;
+    const uint16_t stream_count = 3;
+
+    for (uint32_t flags: {0u, static_cast<uint32_t>(OpenMode::om_disable_file_system_cache)})
+    {
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_RESULT(writer.create(TESTFILE, 0, flags, 0, 0));
+            for (uint16_t stream_id = 1; stream_id <= stream_count; ++stream_id)
+            {
+                A_UTILS_TEST_RESULT(writer.setStreamName(stream_id, ("stream" + std::to_string(stream_id)).c_str()));
+                // odd sizes, so that the extensions are not aligned to sectors
+                std::vector<uint8_t> info(stream_id * 333, static_cast<uint8_t>(stream_id));
+                writer.setAdditionalStreamInfo(stream_id, info.data(), static_cast<uint32_t>(info.size()));
+            }
+
+            for (uint32_t idx = 0; idx < chunk_count; ++idx)
+            {
+                A_UTILS_TEST_RESULT(writer.writeChunk(idx % stream_count + 1, &idx, sizeof(idx), idx,
+                                                      ChunkType::ct_keydata));
+            }
+            A_UTILS_TEST_RESULT(writer.close());
+        }
+
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(TESTFILE));
+        A_UTILS_TEST(reader.getChunkCount() == chunk_count);
+
+        for (uint16_t stream_id = 1; stream_id <= stream_count; ++stream_id)
+        {
+            A_UTILS_TEST(reader.getStreamName(stream_id) == "stream" + std::to_string(stream_id));
+            const void* info_data = nullptr;
+            size_t info_size = 0;
+            reader.getAdditionalStreamInfo(stream_id, &info_data, &info_size);
+            A_UTILS_TEST(info_size == stream_id * 333u);
+            A_UTILS_TEST(static_cast<const uint8_t*>(info_data)[info_size - 1] == stream_id);
+        }
+
+        for (uint32_t idx: {0u, 1u, 100000u, chunk_count - 1})
+        {
+            A_UTILS_TEST(reader.seek(0, idx, TimeFormat::tf_chunk_index) == idx);
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            A_UTILS_TEST(*static_cast<uint32_t*>(data) == idx);
+        }
+
+        A_UTILS_TEST(reader.seek(3, 1000, TimeFormat::tf_stream_index) == 3002);
+    }
+}
+
+class DroppedChunks: public ifhd::v400::IndexedFileWriter::ChunkDroppedCallback
+{
+    public:
+        std::vector<uint64_t> indices;
+
+        void onChunkDropped(uint64_t index, uint16_t /*stream_id*/, uint16_t /*flags*/, timestamp_t /*time*/) override
+        {
+            indices.push_back(index);
+        }
+};
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestCachedHistory,
+            "1.16",
+            "TestCachedHistory",
+            "Test writing a history via the cache writing thread.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint32_t chunk_count = 3000;
+    const uint32_t quit_history_chunk = 2500;
+
+    // the same chunks are written synchronously and via a small cache, which wraps around often
+    std::vector<std::vector<uint8_t>> chunk_data[2];
+    std::vector<uint64_t> dropped[2];
+    for (size_t cache_size: {size_t(0), size_t(64 * 1024)})
+    {
+        DroppedChunks drop_callback;
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_RESULT(writer.create(TESTFILEHISTORY, cache_size, 0, 0, 1000000, 0, 0, 0, &drop_callback));
+            A_UTILS_TEST_RESULT(writer.setStreamName(1, "stream1"));
+            A_UTILS_TEST_RESULT(writer.setStreamName(2, "stream2"));
+
+            for (uint32_t idx = 0; idx < chunk_count; ++idx)
+            {
+                if (idx == quit_history_chunk)
+                {
+                    A_UTILS_TEST_RESULT(writer.quitHistory());
+                }
+
+                std::vector<uint8_t> data(idx * 37 % 3000 + 1, static_cast<uint8_t>(idx));
+                A_UTILS_TEST_RESULT(writer.writeChunk(idx % 2 + 1, data.data(), static_cast<uint32_t>(data.size()),
+                                                      idx * 1000, ChunkType::ct_data));
+            }
+            A_UTILS_TEST_RESULT(writer.close());
+        }
+
+        const size_t run = cache_size == 0 ? 0 : 1;
+        dropped[run] = drop_callback.indices;
+
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(TESTFILEHISTORY));
+        const int64_t read_count = reader.getChunkCount();
+        for (int64_t idx = 0; idx < read_count; ++idx)
+        {
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            chunk_data[run].emplace_back(static_cast<uint8_t*>(data),
+                                         static_cast<uint8_t*>(data) + chunk->size - sizeof(ChunkHeader));
+        }
+    }
+
+    A_UTILS_TEST(!dropped[0].empty());
+    A_UTILS_TEST(dropped[0] == dropped[1]);
+    A_UTILS_TEST(chunk_data[0].size() == chunk_count - dropped[0].size());
+    A_UTILS_TEST(chunk_data[0] == chunk_data[1]);
+
+    // a disabled file system cache is only supported if the history is written synchronously
+    IndexedFileWriter writer;
+    A_UTILS_TEST_ERR_RESULT(writer.create(TESTFILEHISTORY, 64 * 1024, OpenMode::om_disable_file_system_cache, 0, 1000000));
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestPreallocatedHistory,
+            "1.17",
+            "TestPreallocatedHistory",
+            "Test a history whose disk space is reserved up front.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint32_t chunk_count = 3000;
+    const uint32_t quit_history_chunk = 2500;
+    const utils5ext::FileSize history_size = 256 * 1024;
+
+    for (size_t cache_size: {size_t(0), size_t(64 * 1024)})
+    {
+        DroppedChunks drop_callback;
+        {
+            IndexedFileWriter writer;
+            A_UTILS_TEST_ERR_RESULT(writer.create(TESTFILEHISTORY, cache_size, OpenMode::om_preallocate_history,
+                                                  0, 1000000));
+            A_UTILS_TEST_RESULT(writer.create(TESTFILEHISTORY, cache_size, OpenMode::om_preallocate_history,
+                                              0, 0, history_size, 0, 0, &drop_callback));
+
+            int64_t file_size = 0;
+            for (uint32_t idx = 0; idx < chunk_count; ++idx)
+            {
+                if (idx == quit_history_chunk)
+                {
+                    A_UTILS_TEST_RESULT(writer.quitHistory());
+                }
+
+                std::vector<uint8_t> data(idx * 37 % 3000 + 1, static_cast<uint8_t>(idx));
+                A_UTILS_TEST_RESULT(writer.writeChunk(1, data.data(), static_cast<uint32_t>(data.size()),
+                                                      idx * 1000, ChunkType::ct_data));
+
+                if (cache_size == 0 && idx < quit_history_chunk)
+                {
+                    // the file is never truncated and does not grow beyond the history
+                    std::ifstream file(TESTFILEHISTORY, std::ios::binary | std::ios::ate);
+                    const int64_t current_file_size = static_cast<int64_t>(file.tellg());
+                    A_UTILS_TEST(current_file_size >= file_size);
+                    A_UTILS_TEST(current_file_size <= static_cast<int64_t>(sizeof(FileHeader) + history_size));
+                    file_size = current_file_size;
+                }
+            }
+            A_UTILS_TEST_RESULT(writer.close());
+        }
+
+        // the oldest chunks have been dropped in order, the rest is read in order
+        A_UTILS_TEST(!drop_callback.indices.empty());
+        for (size_t idx = 0; idx < drop_callback.indices.size(); ++idx)
+        {
+            A_UTILS_TEST(drop_callback.indices[idx] == idx);
+        }
+
+        IndexedFileReader reader;
+        A_UTILS_TEST_RESULT(reader.open(TESTFILEHISTORY));
+        A_UTILS_TEST(reader.getChunkCount() == chunk_count - drop_callback.indices.size());
+        for (uint32_t idx = static_cast<uint32_t>(drop_callback.indices.size()); idx < chunk_count; ++idx)
+        {
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+            A_UTILS_TEST(chunk->time_stamp == idx * 1000);
+            A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == idx * 37 % 3000 + 1);
+            A_UTILS_TEST(static_cast<uint8_t*>(data)[0] == static_cast<uint8_t>(idx));
+        }
+    }
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestFollowWhileWriting,
+            "1.18",
+            "TestFollowWhileWriting",
+            "Test a reader that follows a file while it is written.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const uint32_t chunk_count = 3000;
+    auto get_chunk_size = [](uint32_t idx) -> uint32_t { return idx * 37 % 3000 + 1; };
+
+    {
+        IndexedFileWriter writer;
+        A_UTILS_TEST_ERR_RESULT(writer.create(TESTFILE, 0, OpenMode::om_sync_write | OpenMode::om_publish_progress));
+        A_UTILS_TEST_ERR_RESULT(writer.create(TESTFILE, 64 * 1024, OpenMode::om_publish_progress, 0, 1000000));
+        A_UTILS_TEST_ERR_RESULT(writer.create(TESTFILE, 64 * 1024, OpenMode::om_publish_progress | OpenMode::om_disable_file_system_cache));
+    }
+
+    IndexedFileWriter writer;
+    A_UTILS_TEST_RESULT(writer.create(TESTFILE, 64 * 1024, OpenMode::om_publish_progress));
+    writer.setProgressInterval(1000);
+    A_UTILS_TEST(a_util::filesystem::exists(IndexedFileWriter::getProgressFileName(TESTFILE)));
+
+    {
+        IndexedFileReader reader;
+        A_UTILS_TEST_ERR_RESULT(reader.open(TESTFILE, -1, OpenMode::om_follow | OpenMode::om_memory_mapped));
+    }
+
+    // the follower reads the chunks as soon as they are published
+    uint32_t chunks_read = 0;
+    uint32_t chunks_read_while_writing = 0;
+    std::thread follower([&]()
+    {
+        IndexedFileReader reader;
+        reader.setFollowInterval(1000);
+        A_UTILS_TEST_RESULT(reader.open(TESTFILE, -1, OpenMode::om_follow));
+        for (;;)
+        {
+            while (reader.getFilePos() < reader.getChunkCount())
+            {
+                ChunkHeader* chunk;
+                void* data;
+                A_UTILS_TEST_RESULT(reader.readNextChunk(&chunk, &data));
+                A_UTILS_TEST(chunk->time_stamp == chunks_read * 1000);
+                A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == get_chunk_size(chunks_read));
+                A_UTILS_TEST(static_cast<uint8_t*>(data)[0] == static_cast<uint8_t>(chunks_read));
+                ++chunks_read;
+            }
+
+            // reading beyond the published chunks continues once there are new ones
+            ChunkHeader* chunk;
+            void* data;
+            A_UTILS_TEST_ERR_RESULT(reader.readNextChunk(&chunk, &data));
+
+            if (!reader.isComplete())
+            {
+                chunks_read_while_writing = chunks_read;
+            }
+            if (!reader.waitForChunks(1000000) && reader.isComplete())
+            {
+                break;
+            }
+        }
+        A_UTILS_TEST(reader.getChunkCount() == chunk_count);
+        A_UTILS_TEST_ERR_RESULT(reader.seek(0, 0, TimeFormat::tf_chunk_index));
+    });
+
+    for (uint32_t idx = 0; idx < chunk_count; ++idx)
+    {
+        const std::vector<uint8_t> data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+        A_UTILS_TEST_RESULT(writer.writeChunk(1, data.data(), static_cast<uint32_t>(data.size()),
+                                              idx * 1000, ChunkType::ct_data));
+        if (idx % 100 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    A_UTILS_TEST_RESULT(writer.close());
+    A_UTILS_TEST(!a_util::filesystem::exists(IndexedFileWriter::getProgressFileName(TESTFILE)));
+
+    follower.join();
+    A_UTILS_TEST(chunks_read_while_writing > 0);
+    A_UTILS_TEST(chunks_read == chunk_count);
+
+    // a complete file is opened as usual
+    IndexedFileReader reader;
+    A_UTILS_TEST_RESULT(reader.open(TESTFILE, -1, OpenMode::om_follow));
+    A_UTILS_TEST(reader.isComplete());
+    A_UTILS_TEST(!reader.waitForChunks(0));
+    A_UTILS_TEST(reader.seek(0, 10, TimeFormat::tf_chunk_index) == 10);
+}
+
+DEFINE_TEST(TesterIndexedFileWriter,
+            TestLiveTap,
+            "1.19",
+            "TestLiveTap",
+            "Test reading the chunks published to the live tap of a writer.",
+            "",
+            "",
+            "none",
+            "",
+            "Automatic")
+{
+    using namespace ifhd::v400;
+    const std::string tap_name = "ifhd_test_live_tap";
+    const size_t tap_size = 64 * 1024;
+    auto get_chunk_size = [](uint32_t idx) -> uint32_t { return idx * 37 % 1000 + 1; };
+
+    {
+        LiveTapReader reader;
+        A_UTILS_TEST_ERR_RESULT(reader.open(tap_name));
+    }
+
+    IndexedFileWriter writer;
+    writer.setLiveTap(tap_name, tap_size);
+    A_UTILS_TEST_RESULT(writer.create(TESTFILE, 16 * 1024, 0));
+
+    LiveTapReader reader;
+    A_UTILS_TEST_RESULT(reader.open(tap_name));
+
+    // a second writer must not take over the tap of a running writer
+    {
+        const std::string second_file = "test_live_tap_second.dat";
+        IndexedFileWriter second_writer;
+        second_writer.setLiveTap(tap_name, tap_size);
+        A_UTILS_TEST_ERR_RESULT(second_writer.create(second_file, 16 * 1024, 0));
+        A_UTILS_TEST(!a_util::filesystem::exists(second_file));
+    }
+
+    auto write_chunk = [&](uint32_t idx)
+    {
+        const std::vector<uint8_t> data(get_chunk_size(idx), static_cast<uint8_t>(idx));
+        if (idx % 2 == 0)
+        {
+            A_UTILS_TEST_RESULT(writer.writeChunk(1, data.data(), static_cast<uint32_t>(data.size()),
+                                                  idx * 1000, ChunkType::ct_data));
+        }
+        else
+        {
+            // reserved chunks are published from the cache
+            IndexedFileWriter::ChunkReservation reservation;
+            A_UTILS_TEST_RESULT(writer.reserveChunk(static_cast<uint32_t>(data.size()), reservation));
+            a_util::memory::copy(reservation.data[0], reservation.data_size[0], data.data(), reservation.data_size[0]);
+            if (reservation.data_size[1] > 0)
+            {
+                a_util::memory::copy(reservation.data[1], reservation.data_size[1],
+                                     data.data() + reservation.data_size[0], reservation.data_size[1]);
+            }
+            A_UTILS_TEST_RESULT(writer.commitChunk(1, idx * 1000, ChunkType::ct_data));
+        }
+    };
+
+    auto check_chunk = [&](ChunkHeader* chunk, void* data, uint32_t idx)
+    {
+        A_UTILS_TEST(chunk->time_stamp == idx * 1000);
+        A_UTILS_TEST(chunk->stream_id == 1);
+        A_UTILS_TEST(chunk->size - sizeof(ChunkHeader) == get_chunk_size(idx));
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        A_UTILS_TEST(std::all_of(bytes, bytes + get_chunk_size(idx),
+                                 [idx](uint8_t value) { return value == static_cast<uint8_t>(idx); }));
+    };
+
+    // a consumer that keeps up reads every chunk
+    ChunkHeader* chunk;
+    void* data;
+    uint32_t idx = 0;
+    for (; idx < 100; ++idx)
+    {
+        write_chunk(idx);
+        A_UTILS_TEST(reader.readNextChunk(&chunk, &data));
+        check_chunk(chunk, data, idx);
+        A_UTILS_TEST(!reader.readNextChunk(&chunk, &data));
+    }
+    A_UTILS_TEST(reader.getLostChunkCount() == 0);
+
+    // a slow consumer loses the oldest chunks, the writer does not wait for it
+    const uint32_t first_unread = idx;
+    for (; idx < 1000; ++idx)
+    {
+        write_chunk(idx);
+    }
+
+    A_UTILS_TEST(reader.readNextChunk(&chunk, &data));
+    const uint32_t first_read = static_cast<uint32_t>(chunk->time_stamp / 1000);
+    A_UTILS_TEST(first_read > first_unread);
+    check_chunk(chunk, data, first_read);
+    for (uint32_t next = first_read + 1; next < idx; ++next)
+    {
+        A_UTILS_TEST(reader.readNextChunk(&chunk, &data));
+        check_chunk(chunk, data, next);
+    }
+    A_UTILS_TEST(!reader.readNextChunk(&chunk, &data));
+    A_UTILS_TEST(reader.getLostChunkCount() == first_read - first_unread);
+
+    // chunks that do not fit into the tap are only written to the file
+    const std::vector<uint8_t> large_chunk(tap_size, 0);
+    A_UTILS_TEST_RESULT(writer.writeChunk(1, large_chunk.data(), static_cast<uint32_t>(large_chunk.size()),
+                                          idx * 1000, ChunkType::ct_data));
+    A_UTILS_TEST(!reader.readNextChunk(&chunk, &data));
+    A_UTILS_TEST(reader.getLostChunkCount() == first_read - first_unread);
+
+    // the remaining chunks can be read after the writer has removed the tap
+    write_chunk(++idx);
+    A_UTILS_TEST_RESULT(writer.close());
+    A_UTILS_TEST(reader.readNextChunk(&chunk, &data));
+    check_chunk(chunk, data, idx);
+
+    LiveTapReader late_reader;
+    A_UTILS_TEST_ERR_RESULT(late_reader.open(tap_name));
+
+    IndexedFileReader file_reader;
+    A_UTILS_TEST_RESULT(file_reader.open(TESTFILE));
+    A_UTILS_TEST(file_reader.getChunkCount() == 1002);
+}
@@ -364,6 +364,23 @@ class DOEXPORT File
          */
         void truncate(FilePos size);
 
+        /**
+         * Reserves disk space for a region of the file without changing the file size, so that
+         * later writes to the region do not have to allocate blocks. This is only a hint and
+         * has no effect if the file system does not support it.
+         * @param offset The start of the region.
+         * @param size The size of the region.
+         * @throw std::runtime_error if there is not enough space on the disk.
+         */
+        void allocate(FilePos offset, FileSize size);
+
+        /**
+         * Writes the data of the file that is still held by the operating system to the disk,
+         * so that it survives a power loss.
+         * @throw std::system_error if the data could not be written.
+         */
+        void syncData();
+
     protected:
         /**
          * Initialization.
@@ -0,0 +1,172 @@
+/**
+ * @file
+ * Asynchronous read-ahead of a file.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef FILE_PREFETCHER_CLASS_EXT_HEADER
+#define FILE_PREFETCHER_CLASS_EXT_HEADER
+
+namespace utils5ext
+{
+
+/**
+ *
+ * Sequential read access to a file that is filled by a background thread.
+ *
+ * The thread reads blocks ahead of the current read position into a window of fixed size.
+ * Reading or skipping only blocks if the thread has not caught up yet. Positioning within the
+ * window keeps the prefetched data, any other position restarts the read-ahead.
+ *
+ * Files with a non-contiguous layout can be followed by registering jumps via @ref addJump.
+ *
+ * All methods besides the constructor and destructor have to be called by the same thread.
+ *
+**/
+class DOEXPORT FilePrefetcher
+{
+    public:
+        /// Constructor
+        FilePrefetcher();
+
+        /// Destructor. Stops the read-ahead thread.
+        ~FilePrefetcher();
+
+        /**
+         * Opens the file (shared) and starts the read-ahead thread at position 0.
+         *
+         * @param filename [in] The file to read.
+         * @param window_size [in] The amount of data that is read ahead.
+         * @param block_size [in] The size of a single read operation.
+         * @throw std::runtime_error if the file could not be opened.
+         */
+        void open(const a_util::filesystem::Path& filename,
+                  size_t window_size,
+                  size_t block_size = 1024 * 1024);
+
+        /**
+         * Stops the read-ahead thread and closes the file.
+         */
+        void close();
+
+        /**
+         * Checks whether a file is currently opened.
+         * @return Whether a file is opened.
+         * @rtsafe
+         */
+        bool isOpen() const;
+
+        /**
+         * Registers a jump of the read position. Whenever reading reaches @a from it continues
+         * at @a to. Jumps are not chained, reading continues at @a to even if another jump starts
+         * there. The first jump registered for a position wins. Discards the data prefetched
+         * so far.
+         *
+         * @param from [in] The position at which to jump.
+         * @param to [in] The position to continue at.
+         */
+        void addJump(FilePos from, FilePos to);
+
+        /**
+         * Sets the read position.
+         *
+         * @param offset [in] The new position.
+         */
+        void setFilePos(FilePos offset);
+
+        /**
+         * Returns the read position.
+         * @return The current position.
+         */
+        FilePos getFilePos() const;
+
+        /**
+         * Reads data at the current position.
+         *
+         * @param buffer [out] The destination buffer.
+         * @param buffer_size [in] The amount of data to read.
+         * @return The amount of data read, less than @a buffer_size only at the end of the file.
+         * @throw std::runtime_error if the read-ahead thread failed to read the file.
+         */
+        size_t read(void* buffer, size_t buffer_size);
+
+        /**
+         * Reads exactly the given amount of data.
+         *
+         * @param buffer [out] The destination buffer.
+         * @param buffer_size [in] The amount of data to read.
+         * @throw std::runtime_error if the end of the file is reached before all data has been read
+         *                           (like File::readAll) or if the read-ahead thread failed to
+         *                           read the file. Use @ref read to tell the end of the file apart.
+         */
+        void readAll(void* buffer, size_t buffer_size);
+
+        /**
+         * Skips data at the current position.
+         *
+         * @param size [in] The amount of data to skip.
+         * @return The amount of data skipped, less than @a size only at the end of the file.
+         * @throw std::runtime_error if the read-ahead thread failed to read the file.
+         */
+        size_t skip(size_t size);
+
+    private:
+        /// A block of the window
+        struct Block
+        {
+            FilePos              file_pos;  //!< Position of the data within the file
+            size_t               size;      //!< Amount of valid data
+            std::vector<uint8_t> data;      //!< The data
+        };
+
+        FilePrefetcher(const FilePrefetcher&) = delete;
+        FilePrefetcher& operator=(const FilePrefetcher&) = delete;
+
+        /// Consumes data, copies it to @a buffer if it is not nullptr.
+        size_t consume(void* buffer, size_t size);
+
+        /// Follows the jump that starts at the given position, if any.
+        FilePos resolveJump(FilePos offset) const;
+
+        /// Restarts the read-ahead at the given position, the mutex has to be locked.
+        void restart(FilePos offset);
+
+        /// The read-ahead thread
+        void prefetch();
+
+    private:
+        File                    _file;              //!< Handle used by the read-ahead thread
+        std::map<FilePos, FilePos> _jumps;          //!< Jumps of the read position
+        std::vector<Block>      _blocks;            //!< The window
+        size_t                  _head;              //!< Block that is read next
+        size_t                  _head_offset;       //!< Offset within the head block
+        size_t                  _filled;            //!< Number of blocks ready to be read
+        FilePos                 _file_pos;          //!< The read position
+        FilePos                 _prefetch_pos;      //!< Position of the next block to prefetch
+        uint64_t                _generation;        //!< Incremented on every restart
+        bool                    _end_of_file;       //!< The read-ahead thread reached the end
+        bool                    _failed;            //!< The read-ahead thread failed
+        bool                    _stop;              //!< Stops the read-ahead thread
+        std::mutex              _mutex;
+        std::condition_variable _cond_filled;       //!< Signaled when a block is ready
+        std::condition_variable _cond_freed;        //!< Signaled when a block has been consumed
+        std::thread             _thread;
+};
+
+} // namespace utils5ext
+
+#endif // FILE_PREFETCHER_CLASS_EXT_HEADER
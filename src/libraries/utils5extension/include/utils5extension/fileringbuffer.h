@@ -37,6 +37,13 @@ namespace utils5ext
  * AppendItem() method. When you want to start wrapping around, call StartWrappingAround(). This will
  * limit the ring buffer size by the current size. When you want to continue writing past the end
  * of the ringbuffer, call StartAppending() and the file will then grow indefinitly.
+ *
+ * With preallocate() the buffer is limited to a region of the file that is reserved up front.
+ * The file is not truncated while wrapping around in this case, only once by StartAppending().
+ *
+ * Instead of a file, the buffer can be given a FileAccess implementation. In this case it only
+ * manages the layout of the items and passes the writes and file position changes on, so that
+ * they can be applied later on, e.g. by a different thread.
  */
 template <typename ADDITIONAL_DATA = uint8_t, uint8_t alignment = 1>
 class FileRingBuffer
@@ -68,6 +75,40 @@ class FileRingBuffer
                 virtual void onDrop(const Item& dropped_item, const Item& next_item) = 0;
         };
 
+        /**
+         * Interface that receives the file operations of the buffer, see the constructor.
+         * The operations have to be applied to the file in the order they are received.
+         */
+        class FileAccess
+        {
+            public:
+                /**
+                 * Called to write data at the current file position.
+                 * @param [in] data The data.
+                 * @param [in] dataSize The size of the data.
+                 */
+                virtual void write(const void* data, size_t data_size) = 0;
+
+                /**
+                 * Called to move the current file position.
+                 * @param [in] filePos The new file position.
+                 */
+                virtual void setFilePos(FilePos file_pos) = 0;
+
+                /**
+                 * Called to truncate the file, the file position is not changed.
+                 * @param [in] fileSize The new size of the file.
+                 */
+                virtual void truncate(FilePos file_size) = 0;
+
+                /**
+                 * Called to reserve disk space for a region of the file, see File::allocate.
+                 * @param [in] offset The start of the region.
+                 * @param [in] size The size of the region.
+                 */
+                virtual void allocate(FilePos offset, FileSize size) = 0;
+        };
+
         /**
          * Helper struct to store an item that is made up by multiple data buffers.
          */
@@ -77,19 +118,107 @@ class FileRingBuffer
             size_t data_size; ///< The size of the piece.
         };
 
-        /// Typedef for convienient access.
-        typedef std::deque<Item> Items;
+        /**
+         * Circular array of the items. It only grows when it is full, so that no memory is
+         * allocated while appending as long as the items fit into its capacity.
+         */
+        class Items
+        {
+            public:
+                /// A const iterator from the oldest to the newest item.
+                class const_iterator
+                {
+                    public:
+                        const_iterator(const Items* items, size_t index): _items(items), _index(index) {}
+                        const Item& operator*() const { return (*_items)[_index]; }
+                        const Item* operator->() const { return &(*_items)[_index]; }
+                        const_iterator& operator++() { ++_index; return *this; }
+                        bool operator==(const const_iterator& other) const { return _index == other._index; }
+                        bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+                    private:
+                        const Items* _items;
+                        size_t _index;
+                };
+
+            public:
+                Items(): _first(0), _count(0) {}
+
+                /**
+                 * Makes sure that the given amount of items fits into the array.
+                 * @param [in] capacity The amount of items.
+                 */
+                void reserve(size_t capacity)
+                {
+                    if (capacity <= _storage.size())
+                    {
+                        return;
+                    }
+
+                    std::vector<Item> storage(capacity);
+                    for (size_t index = 0; index < _count; ++index)
+                    {
+                        storage[index] = (*this)[index];
+                    }
+                    _storage.swap(storage);
+                    _first = 0;
+                }
+
+                bool empty() const { return _count == 0; }
+                size_t size() const { return _count; }
+                size_t capacity() const { return _storage.size(); }
+
+                Item& front() { return (*this)[0]; }
+                Item& back() { return (*this)[_count - 1]; }
+
+                Item& operator[](size_t index)
+                {
+                    return _storage[(_first + index) % _storage.size()];
+                }
+
+                const Item& operator[](size_t index) const
+                {
+                    return _storage[(_first + index) % _storage.size()];
+                }
+
+                void push_back(const Item& item)
+                {
+                    if (_count == _storage.size())
+                    {
+                        reserve(std::max<size_t>(16, 2 * _storage.size()));
+                    }
+                    ++_count;
+                    back() = item;
+                }
+
+                void pop_front()
+                {
+                    _first = (_first + 1) % _storage.size();
+                    --_count;
+                }
+
+                const_iterator begin() const { return const_iterator(this, 0); }
+                const_iterator end() const { return const_iterator(this, _count); }
+
+            private:
+                std::vector<Item> _storage;
+                size_t _first;
+                size_t _count;
+        };
+
         /// An const iterator in the buffer.
         typedef typename Items::const_iterator const_iterator;
 
     private:
         Items                        _items;
         File*                        _file;
+        FileAccess*                  _file_access;
         FilePos                      _start_offset;
         FilePos                      _current_pos;
         FileSize                     _current_size;
         FileSize                     _max_size;
         bool                         _bookkeeping;
+        bool                         _preallocated;
         DropCallback*                _callback;
         a_util::memory::MemoryBuffer _alignment_buffer;
         Item                         _rear_item;
@@ -106,28 +235,42 @@ class FileRingBuffer
         FileRingBuffer(File* file, FilePos start_offset = 0,
             FileSize max_size = 0, DropCallback* drop_callback = nullptr) :
             _file(file),
+            _file_access(nullptr),
             _start_offset(start_offset),
             _current_size(0),
             _max_size(max_size),
             _bookkeeping(true),
+            _preallocated(false),
             _callback(drop_callback)
         {
             file->setFilePos(start_offset, File::fp_begin);
             _current_pos = start_offset;
+            initializeAlignment();
+        }
 
-#ifdef WIN32
-    __pragma(warning(push))
-    __pragma(warning(disable:4127))
-#endif
-                if (alignment > 1)
-                {
-                    _alignment_buffer.allocate(alignment - 1);
-                    utils5ext::memZero(_alignment_buffer.getPtr(), _alignment_buffer.getSize());
-                }
-#ifdef WIN32
-    __pragma(warning(pop))
-#endif
-                fillForAlignment();
+        /**
+         * Constructor for a buffer that does not access the file itself.
+         * @param [in] fileAccess Receives the file operations, the file has to be open and must
+         *             not be changed otherwise.
+         * @param [in] startOffset The offset where the ring buffer should start.
+         * @param [in] maxSize An optional size after which wrapping around will start.
+         *             automatically, if zero, use StartWrappingAround.
+         * @param [in] dropCallback A callback that will inform about dropped items.
+         */
+        FileRingBuffer(FileAccess* file_access, FilePos start_offset = 0,
+            FileSize max_size = 0, DropCallback* drop_callback = nullptr) :
+            _file(nullptr),
+            _file_access(file_access),
+            _start_offset(start_offset),
+            _current_size(0),
+            _max_size(max_size),
+            _bookkeeping(true),
+            _preallocated(false),
+            _callback(drop_callback)
+        {
+            file_access->setFilePos(start_offset);
+            _current_pos = start_offset;
+            initializeAlignment();
         }
 
         /**
@@ -139,6 +282,35 @@ class FileRingBuffer
             return _current_size;
         }
 
+        /**
+         * Reserves the disk space of the buffer up front and limits the buffer to it. From now on
+         * the file is not truncated when the buffer wraps around, so that its size and its
+         * allocated blocks do not change until StartAppending() is called.
+         * @param [in] size The size of the buffer, starting at the start offset.
+         * @param [in] itemCapacity The amount of items that is expected to fit into the buffer,
+         *             more items are managed as well but require memory allocations.
+         */
+        void preallocate(FileSize size, size_t item_capacity)
+        {
+            if (!_bookkeeping || !_items.empty())
+            {
+                throw std::runtime_error("the buffer has to be preallocated before appending items");
+            }
+
+            if (_file)
+            {
+                _file->allocate(_start_offset, size);
+            }
+            else
+            {
+                _file_access->allocate(_start_offset, size);
+            }
+
+            _items.reserve(item_capacity);
+            _max_size = _start_offset + size;
+            _preallocated = true;
+        }
+
         /**
          * Limits the size of the buffer by the current size.
          */
@@ -167,8 +339,24 @@ class FileRingBuffer
             }
 
             _max_size = 0;
-            _file->setFilePos(0, File::fp_end);
-            _current_pos = _file->getFilePos();
+            if (_preallocated)
+            {
+                // the file is truncated once after the last item that is part of the buffer
+                _current_pos = std::max<FilePos>(_current_pos, _current_size);
+                truncateFile(_current_pos);
+                setFilePos(_current_pos);
+            }
+            else if (_file)
+            {
+                _file->setFilePos(0, File::fp_end);
+                _current_pos = _file->getFilePos();
+            }
+            else
+            {
+                // the file ends after the last write or where it has been truncated
+                _current_pos = std::max<FilePos>(_current_pos, _current_size);
+                _file_access->setFilePos(_current_pos);
+            }
             _bookkeeping = false;
 
             if (_rear_item.file_pos == -1 && !_items.empty())
@@ -232,7 +420,10 @@ class FileRingBuffer
                 if (_current_pos + static_cast<FileSize>(data_size) > _max_size)
                 {
                     // in this case we need to wrap around
-                    _file->truncate(_current_pos);
+                    if (!_preallocated)
+                    {
+                        truncateFile(_current_pos);
+                    }
                     _current_size = _current_pos;
 
                     _rear_item = _items.back();
@@ -244,7 +435,7 @@ class FileRingBuffer
                     }
 
                     _current_pos = _items.front().file_pos; // this should be equal to the data offset
-                    _file->setFilePos(_current_pos, File::fp_begin);
+                    setFilePos(_current_pos);
                 }
             }
 
@@ -257,7 +448,7 @@ class FileRingBuffer
 
             for (size_t piece = 0; piece < count; ++piece)
             {
-                _file->writeAll(pieces[piece].data, static_cast<int>(pieces[piece].data_size));
+                write(pieces[piece].data, pieces[piece].data_size);
             }
 
             _current_pos += data_size;
@@ -299,7 +490,10 @@ class FileRingBuffer
                         // so the current item is the new rear item.
                         _rear_item = _items.back();
                         // make sure that the file ends after the current item
-                        _file->truncate(_current_pos);
+                        if (!_preallocated)
+                        {
+                            truncateFile(_current_pos);
+                        }
                         _current_size = _current_pos;
                     }
                 }
@@ -325,6 +519,71 @@ class FileRingBuffer
         }
 
     protected:
+        /**
+         * Allocates the fill data and fills the file up to the first aligned position.
+         */
+        void initializeAlignment()
+        {
+#ifdef WIN32
+    __pragma(warning(push))
+    __pragma(warning(disable:4127))
+#endif
+            if (alignment > 1)
+            {
+                _alignment_buffer.allocate(alignment - 1);
+                utils5ext::memZero(_alignment_buffer.getPtr(), _alignment_buffer.getSize());
+            }
+#ifdef WIN32
+    __pragma(warning(pop))
+#endif
+            fillForAlignment();
+        }
+
+        /**
+         * Writes data at the current file position.
+         */
+        void write(const void* data, size_t data_size)
+        {
+            if (_file)
+            {
+                _file->writeAll(data, data_size);
+            }
+            else
+            {
+                _file_access->write(data, data_size);
+            }
+        }
+
+        /**
+         * Moves the current file position.
+         */
+        void setFilePos(FilePos file_pos)
+        {
+            if (_file)
+            {
+                _file->setFilePos(file_pos, File::fp_begin);
+            }
+            else
+            {
+                _file_access->setFilePos(file_pos);
+            }
+        }
+
+        /**
+         * Truncates the file.
+         */
+        void truncateFile(FilePos file_size)
+        {
+            if (_file)
+            {
+                _file->truncate(file_size);
+            }
+            else
+            {
+                _file_access->truncate(file_size);
+            }
+        }
+
         /**
          * Writes data to the file until a field position is reached that satisfies the alignment
          * requirement.
@@ -335,8 +594,7 @@ class FileRingBuffer
             if (mod)
             {
                 FilePos fill = alignment - mod;
-                _file->writeAll(_alignment_buffer.getPtr(),
-                                  static_cast<size_t>(fill));
+                write(_alignment_buffer.getPtr(), static_cast<size_t>(fill));
                 _current_pos += fill;
             }
         }
@@ -0,0 +1,124 @@
+/**
+ * @file
+ * Lock-free single producer single consumer ring buffer.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef LOCK_FREE_RING_BUFFER_CLASS_EXT_HEADER
+#define LOCK_FREE_RING_BUFFER_CLASS_EXT_HEADER
+
+namespace utils5ext
+{
+
+/**
+ *
+ * Memory ring buffer for variable sized records that is shared by exactly one producer thread
+ * and exactly one consumer thread without any locks.
+ *
+ * Every record is stored contiguously (prefixed by its size and aligned to 8 bytes), so the
+ * consumer can access it in place via @ref front until it calls @ref pop.
+ *
+**/
+class DOEXPORT LockFreeRingBuffer
+{
+    public:
+        /// Constructor
+        LockFreeRingBuffer();
+
+        /// Destructor
+        ~LockFreeRingBuffer();
+
+        /**
+         * Allocates the buffer. This is not thread safe.
+         *
+         * @param capacity [in] The size of the buffer in bytes, rounded up to the record alignment.
+         */
+        void allocate(size_t capacity);
+
+        /**
+         * Frees the buffer. This is not thread safe.
+         */
+        void free();
+
+        /**
+         * Returns the size of the buffer.
+         * @return The size of the buffer in bytes.
+         * @rtsafe
+         */
+        size_t getCapacity() const;
+
+        /**
+         * Returns the size of the largest record that fits into the buffer. Records are never
+         * split, so this is limited to half of the buffer, otherwise a record might never fit
+         * behind the current position.
+         * @return The maximum size of header and data of a record.
+         * @rtsafe
+         */
+        size_t getMaxRecordSize() const;
+
+        /**
+         * Appends a record that is made up of a header and its data. Only to be called by the
+         * producer.
+         *
+         * @param header [in] The record header.
+         * @param header_size [in] The size of the header.
+         * @param data [in] The record data.
+         * @param data_size [in] The size of the data.
+         * @return false if there is currently not enough space left.
+         * @throw std::invalid_argument if the record is larger than @ref getMaxRecordSize.
+         * @rtsafe
+         */
+        bool tryPush(const void* header, size_t header_size, const void* data, size_t data_size);
+
+        /**
+         * Returns the oldest record. Only to be called by the consumer.
+         *
+         * @param size [out] The size of the record.
+         * @return The start of the record, nullptr if the buffer is empty.
+         * @rtsafe
+         */
+        const void* front(size_t* size);
+
+        /**
+         * Removes the record returned by @ref front. Only to be called by the consumer.
+         * @rtsafe
+         */
+        void pop();
+
+        /**
+         * Checks whether the buffer is empty. Can be called by both sides.
+         * @return Whether the consumer has read all records.
+         * @rtsafe
+         */
+        bool isEmpty() const;
+
+    private:
+        LockFreeRingBuffer(const LockFreeRingBuffer&) = delete;
+        LockFreeRingBuffer& operator=(const LockFreeRingBuffer&) = delete;
+
+    private:
+        uint8_t*            _buffer;        //!< The memory of the ring
+        size_t              _capacity;      //!< The size of the memory
+        uint8_t             _padding_head[64];
+        std::atomic<size_t> _head;          //!< Read position of the consumer (not wrapped)
+        uint8_t             _padding_tail[64];
+        std::atomic<size_t> _tail;          //!< Write position of the producer (not wrapped)
+};
+
+} // namespace utils5ext
+
+#endif // LOCK_FREE_RING_BUFFER_CLASS_EXT_HEADER
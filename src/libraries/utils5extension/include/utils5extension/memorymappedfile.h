@@ -0,0 +1,103 @@
+/**
+ * @file
+ * Read-only memory mapping of a file.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef MEMORY_MAPPED_FILE_CLASS_EXT_HEADER
+#define MEMORY_MAPPED_FILE_CLASS_EXT_HEADER
+
+namespace utils5ext
+{
+
+/**
+ *
+ * Read-only view of a whole file mapped into the address space of the process.
+ *
+ * The view covers the file as it was at the time of mapping. Pointers into the view stay
+ * valid until the object is destroyed, so sharing ownership of it (i.e. via std::shared_ptr)
+ * pins the mapping for as long as any data pointer is in use.
+ *
+**/
+class DOEXPORT MemoryMappedFile
+{
+    public:
+        /// Constructor
+        MemoryMappedFile();
+
+        /// Destructor. Unmaps the view if it is still mapped.
+        ~MemoryMappedFile();
+
+        /**
+         * Maps the given file read-only.
+         *
+         * @param filename [in] The file to map.
+         * @throw std::runtime_error if the file could not be opened or mapped.
+         */
+        void map(const a_util::filesystem::Path& filename);
+
+        /**
+         * Unmaps the view. All pointers retrieved via @ref getData become invalid.
+         */
+        void unmap();
+
+        /**
+         * Checks whether a file is currently mapped.
+         * @return Whether a file is mapped.
+         * @rtsafe
+         */
+        bool isMapped() const;
+
+        /**
+         * Returns the start address of the view.
+         * @return The start address or nullptr if nothing is mapped.
+         * @rtsafe
+         */
+        const uint8_t* getData() const;
+
+        /**
+         * Returns the size of the view.
+         * @return The size of the mapped region in bytes.
+         * @rtsafe
+         */
+        FileSize getSize() const;
+
+        /**
+         * Advises the operating system that the given region will be accessed sequentially
+         * in the near future. This is a hint only, errors are ignored.
+         *
+         * @param offset [in] The start of the region.
+         * @param size [in] The size of the region.
+         */
+        void adviseSequential(FilePos offset, FileSize size) const;
+
+    private:
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    private:
+        const uint8_t* _data;       //!< Start address of the view
+        FileSize       _size;       //!< Size of the view
+#ifdef WIN32
+        void*          _file;       //!< File handle
+        void*          _mapping;    //!< File mapping handle
+#endif
+};
+
+} // namespace utils5ext
+
+#endif // MEMORY_MAPPED_FILE_CLASS_EXT_HEADER
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * Ring buffer in shared memory for local consumers of live data.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef SHARED_RING_BUFFER_CLASS_EXT_HEADER
+#define SHARED_RING_BUFFER_CLASS_EXT_HEADER
+
+namespace utils5ext
+{
+
+/**
+ *
+ * Ring buffer for variable sized records in named shared memory, written by exactly one
+ * producer and read by any number of consumers in other processes.
+ *
+ * The producer never waits for the consumers. If the buffer is full, the oldest records are
+ * overwritten, consumers that fall behind skip them and count them as lost. Consumers only
+ * map the memory read-only, so they cannot disturb the producer or each other.
+ *
+**/
+class DOEXPORT SharedRingBuffer
+{
+    public:
+        /// A part of a record, see @ref push
+        struct Piece
+        {
+            const void* data;
+            size_t      size;
+        };
+
+    public:
+        /// Constructor
+        SharedRingBuffer();
+
+        /// Destructor. Closes the buffer.
+        ~SharedRingBuffer();
+
+        /**
+         * Creates the shared memory as producer. A buffer of the same name is only replaced if
+         * its producer is no longer running, i.e. if it crashed without removing the buffer.
+         *
+         * @param name [in] The name of the buffer, consumers open it by this name.
+         * @param capacity [in] The size of the buffer in bytes, rounded up to the record alignment.
+         * @throw std::runtime_error if the shared memory could not be created or if another
+         *                           producer uses the name.
+         */
+        void create(const std::string& name, size_t capacity);
+
+        /**
+         * Opens the shared memory of a producer as consumer. The consumer starts with the
+         * next record that is pushed.
+         *
+         * @param name [in] The name of the buffer.
+         * @throw std::runtime_error if there is no buffer of this name.
+         */
+        void open(const std::string& name);
+
+        /**
+         * Unmaps the shared memory. The producer removes the name, consumers that still have
+         * the memory mapped keep reading the remaining records.
+         */
+        void close();
+
+        /**
+         * Checks whether the buffer has been created or opened.
+         * @return Whether the buffer is open.
+         * @rtsafe
+         */
+        bool isOpen() const;
+
+        /**
+         * Returns the size of the largest record that fits into the buffer. Records are never
+         * split, so this is limited to half of the buffer.
+         * @return The maximum size of all pieces of a record.
+         * @rtsafe
+         */
+        size_t getMaxRecordSize() const;
+
+        /**
+         * Appends a record that is made up of the given pieces, overwriting the oldest records
+         * if necessary. Only to be called by the producer, it never blocks.
+         *
+         * @param pieces [in] The pieces of the record.
+         * @param piece_count [in] The amount of pieces.
+         * @return false if the record is larger than @ref getMaxRecordSize and has been skipped.
+         * @rtsafe
+         */
+        bool push(const Piece* pieces, size_t piece_count);
+
+        /**
+         * Copies the next record. Only to be called by a consumer.
+         *
+         * @param record [out] Receives the record.
+         * @return false if there is no new record.
+         */
+        bool pop(std::vector<uint8_t>& record);
+
+        /**
+         * Returns the amount of records that have been overwritten before the consumer
+         * could read them.
+         * @return The amount of lost records since @ref open.
+         * @rtsafe
+         */
+        uint64_t getLostRecordCount() const;
+
+    private:
+        SharedRingBuffer(const SharedRingBuffer&) = delete;
+        SharedRingBuffer& operator=(const SharedRingBuffer&) = delete;
+
+        /// Removes the oldest records until the range up to end is free.
+        void evict(uint64_t end);
+
+#ifndef WIN32
+        /// Checks whether the process that created the existing buffer of this name still runs.
+        static bool isProducerRunning(const std::string& shm_name);
+#endif
+
+    private:
+        struct Header;
+
+        std::string _name;          //!< The name of the shared memory
+        bool        _producer;      //!< Whether the buffer has been created
+        uint8_t*    _memory;        //!< Start of the mapping
+        size_t      _memory_size;   //!< Size of the mapping
+        Header*     _header;        //!< The shared positions at the start of the mapping
+        uint8_t*    _buffer;        //!< The ring behind the header
+        size_t      _capacity;      //!< The size of the ring
+        uint64_t    _begin;         //!< Position of the oldest record (producer, not wrapped)
+        uint64_t    _end;           //!< Write position (producer), read position (consumer)
+        uint64_t    _sequence;      //!< Number of the next record (producer and consumer)
+        uint64_t    _lost;          //!< Amount of lost records (consumer)
+#ifdef WIN32
+        void*       _mapping;       //!< File mapping handle
+#endif
+};
+
+} // namespace utils5ext
+
+#endif // SHARED_RING_BUFFER_CLASS_EXT_HEADER
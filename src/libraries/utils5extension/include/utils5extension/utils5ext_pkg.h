@@ -22,6 +22,10 @@
 #define UTILS5_EXT_PACKAGE_HEADER
 
    #include "file.h"
+   #include "fileprefetcher.h"
    #include "fileringbuffer.h"
+   #include "lockfreeringbuffer.h"
+   #include "memorymappedfile.h"
+   #include "sharedringbuffer.h"
 
 #endif // _UTILS5_EXT_PACKAGE_HEADER_
@@ -35,8 +35,15 @@
 #include <a_util/datetime.h>
 #include <a_util/memory.h>
 #include <a_util/xml.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <limits>
+#include <map>
+#include <mutex>
 #include <queue>
+#include <thread>
+#include <vector>
 
 #ifndef DOEXPORT
     #define DOEXPORT  /* */
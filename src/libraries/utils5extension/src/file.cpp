@@ -30,8 +30,14 @@
     #include <unistd.h>
     #include <string.h>
     #include <errno.h>
+    #include <fstream>
+    #ifdef __linux__
+        #include <sys/sysmacros.h>
+    #endif
 #endif // WIN32
 
+#include <algorithm>
+#include <system_error>
 #include <utils5extension/utils5extension.h>
 
 namespace utils5ext
@@ -220,6 +226,55 @@ size_t getSectorSizeFor(const a_util::filesystem::Path& filename)
 
     return static_cast<size_t>(bytes_per_sector);
 
+#elif defined(__linux__)
+
+    // the file might not exist yet, so fall back to the directory it will be created in
+    a_util::filesystem::Path path = filename;
+    struct stat file_info;
+    if (::stat(path.toString().c_str(), &file_info) != 0)
+    {
+        path = filename.getParent();
+        if (path.isEmpty())
+        {
+            path = a_util::filesystem::getWorkingDirectory();
+        }
+
+        if (::stat(path.toString().c_str(), &file_info) != 0)
+        {
+            return local_get_default_sector_size();
+        }
+    }
+
+#ifdef STATX_DIOALIGN
+    // the kernel reports the required alignment for direct I/O of existing regular files
+    struct statx dio_info;
+    if (S_ISREG(file_info.st_mode) &&
+        statx(AT_FDCWD, path.toString().c_str(), 0, STATX_DIOALIGN, &dio_info) == 0 &&
+        (dio_info.stx_mask & STATX_DIOALIGN) != 0 &&
+        dio_info.stx_dio_offset_align != 0)
+    {
+        return std::max<size_t>(dio_info.stx_dio_offset_align, dio_info.stx_dio_mem_align);
+    }
+#endif
+
+    // otherwise use the logical block size of the block device, the queue information
+    // of partitions is found at their parent device
+    const std::string device = "/sys/dev/block/" + std::to_string(major(file_info.st_dev)) +
+                               ":" + std::to_string(minor(file_info.st_dev));
+    for (const char* queue: {"/queue", "/../queue"})
+    {
+        std::ifstream block_size_file(device + queue + "/logical_block_size");
+        size_t block_size = 0;
+        if (block_size_file >> block_size &&
+            block_size != 0 &&
+            (block_size & (block_size - 1)) == 0)
+        {
+            return block_size;
+        }
+    }
+
+    return local_get_default_sector_size();
+
 #else
 
     return local_get_default_sector_size();
@@ -286,7 +341,9 @@ void File::setReadCache(size_t cache_size)
     }
     else
     {
-        allocReadCache(getDefaultSectorSize());
+        // unbuffered reads have to cover at least one sector
+        allocReadCache(_system_cache_disabled ?
+                       static_cast<size_t>(_sector_size) : getDefaultSectorSize());
 
         // just enable for all operations if file system cache is disabled
         _read_cache_enabled = _system_cache_disabled;
@@ -297,6 +354,12 @@ void File::allocReadCache(size_t cache_size)
 {
     freeReadCache();
 
+    if (_system_cache_disabled)
+    {
+        // unbuffered reads are only possible in multiples of the sector size
+        cache_size = (cache_size + _sector_size - 1) & ~(static_cast<size_t>(_sector_size) - 1);
+    }
+
     if (cache_size > 0)
     {
         _read_cache = (uint8_t*) internalMalloc(cache_size, true);
@@ -471,7 +534,29 @@ void File::open(const a_util::filesystem::Path& filename, uint32_t mode)
             permissions |= S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH;
         }
 
+        if (mode & om_write_through)
+        {
+            open_mode |= O_DSYNC;
+        }
+
+    #ifdef O_DIRECT
+        if (mode & om_disable_file_system_cache)
+        {
+            open_mode |= O_DIRECT;
+        }
+    #endif
+
         int handle = _open(open_filename.toString().c_str(), open_mode, permissions);
+
+    #ifdef O_DIRECT
+        if (handle < 0 && errno == EINVAL && (open_mode & O_DIRECT) != 0)
+        {
+            // not every file system supports direct I/O (i.e. tmpfs), use the page cache there
+            open_mode &= ~O_DIRECT;
+            handle = _open(open_filename.toString().c_str(), open_mode, permissions);
+        }
+    #endif
+
         if (handle < 0)
         {
             _file = INVALID_FILE_HANDLE;
@@ -480,6 +565,23 @@ void File::open(const a_util::filesystem::Path& filename, uint32_t mode)
 
         _file = (FileHandle) handle;
 
+    #ifdef O_DIRECT
+        if (open_mode & O_DIRECT)
+        {
+            // all reads and writes have to be aligned to the logical block size from now on
+            _system_cache_disabled  = true;
+            _sector_size           = static_cast<int>(getSectorSizeFor(open_filename));
+        }
+    #endif
+
+    #ifdef POSIX_FADV_SEQUENTIAL
+        if (mode & om_sequential_access)
+        {
+            // doubles the read ahead window of the kernel, just a hint
+            posix_fadvise(handle, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+    #endif
+
         if (mode & om_append)
         {
             // make sure that a subsequent GetFilePos call returns the correct position
@@ -857,7 +959,12 @@ size_t File::write(const void* buffer, size_t buffer_size)
         throw std::system_error(std::error_code(::GetLastError(), std::system_category()));
     }
 #else
-    int bytes_written = _write(_file, buffer, buffer_size);
+    ssize_t bytes_written = _write(_file, buffer, buffer_size);
+    if (bytes_written < 0)
+    {
+        // i.e. EINVAL for a misaligned buffer, size or position with O_DIRECT
+        throw std::system_error(std::error_code(errno, std::generic_category()));
+    }
 #endif
 
     return static_cast<size_t>(bytes_written);
@@ -1189,6 +1296,56 @@ void File::truncate(FilePos size)
 }
 #endif
 
+#ifndef WIN32
+void File::allocate(FilePos offset, FileSize size)
+{
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (fallocate(_file, FALLOC_FL_KEEP_SIZE, offset, size) != 0 && errno == ENOSPC)
+    {
+        throw std::runtime_error("unable to allocate file space");
+    }
+#else
+    (void) offset;
+    (void) size;
+#endif
+}
+#else
+void File::allocate(FilePos offset, FileSize size)
+{
+    FILE_ALLOCATION_INFO allocation_info;
+    allocation_info.AllocationSize.QuadPart = offset + size;
+    if (TRUE != ::SetFileInformationByHandle(_file, FileAllocationInfo,
+                                             &allocation_info, sizeof(allocation_info)) &&
+        ERROR_DISK_FULL == ::GetLastError())
+    {
+        throw std::runtime_error("unable to allocate file space");
+    }
+}
+#endif
+
+#ifndef WIN32
+void File::syncData()
+{
+#ifdef __APPLE__
+    int result = fsync(_file);
+#else
+    int result = fdatasync(_file);
+#endif
+    if (result != 0)
+    {
+        throw std::system_error(std::error_code(errno, std::generic_category()));
+    }
+}
+#else
+void File::syncData()
+{
+    if (TRUE != ::FlushFileBuffers(_file))
+    {
+        throw std::system_error(std::error_code(::GetLastError(), std::system_category()));
+    }
+}
+#endif
+
 a_util::datetime::DateTime getTimeAccess(const a_util::filesystem::Path filename)
 {
     struct _stat buffer;
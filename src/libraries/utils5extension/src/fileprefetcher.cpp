@@ -0,0 +1,333 @@
+/**
+ * @file
+ * Asynchronous read-ahead of a file.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <utils5extension/utils5extension.h>
+
+namespace utils5ext
+{
+
+FilePrefetcher::FilePrefetcher() :
+    _head(0),
+    _head_offset(0),
+    _filled(0),
+    _file_pos(0),
+    _prefetch_pos(0),
+    _generation(0),
+    _end_of_file(false),
+    _failed(false),
+    _stop(false)
+{
+}
+
+FilePrefetcher::~FilePrefetcher()
+{
+    close();
+}
+
+void FilePrefetcher::open(const a_util::filesystem::Path& filename,
+                          size_t window_size,
+                          size_t block_size)
+{
+    close();
+
+    if (block_size == 0)
+    {
+        throw std::invalid_argument("invalid block size");
+    }
+
+    _file.open(filename, File::om_read | File::om_shared_read |
+                         File::om_shared_write | File::om_sequential_access);
+
+    _blocks.resize(std::max<size_t>(1, (window_size + block_size - 1) / block_size));
+    for (auto& block: _blocks)
+    {
+        block.file_pos = 0;
+        block.size = 0;
+        block.data.resize(block_size);
+    }
+
+    _stop = false;
+    restart(0);
+
+    _thread = std::thread(&FilePrefetcher::prefetch, this);
+}
+
+void FilePrefetcher::close()
+{
+    if (_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cond_freed.notify_all();
+        _thread.join();
+    }
+
+    _file.close();
+    _blocks.clear();
+    _jumps.clear();
+}
+
+bool FilePrefetcher::isOpen() const
+{
+    return _thread.joinable();
+}
+
+void FilePrefetcher::addJump(FilePos from, FilePos to)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _jumps.insert(std::make_pair(from, to));
+
+    // the data prefetched so far might not have followed the jump
+    restart(_file_pos);
+}
+
+void FilePrefetcher::setFilePos(FilePos offset)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (offset == _file_pos || offset == resolveJump(_file_pos))
+    {
+        _file_pos = offset;
+        return;
+    }
+
+    // keep the window if the position has already been prefetched
+    for (size_t block_index = 0; block_index < _filled; ++block_index)
+    {
+        const Block& block = _blocks[(_head + block_index) % _blocks.size()];
+        if (offset >= block.file_pos && offset < block.file_pos + static_cast<FilePos>(block.size))
+        {
+            _head = (_head + block_index) % _blocks.size();
+            _filled -= block_index;
+            _head_offset = static_cast<size_t>(offset - block.file_pos);
+            _file_pos = offset;
+            _cond_freed.notify_one();
+            return;
+        }
+    }
+
+    // or if it is the position that is prefetched next
+    if (!_end_of_file && offset == _prefetch_pos)
+    {
+        _head = (_head + _filled) % _blocks.size();
+        _filled = 0;
+        _head_offset = 0;
+        _file_pos = offset;
+        _cond_freed.notify_one();
+        return;
+    }
+
+    restart(offset);
+}
+
+FilePos FilePrefetcher::getFilePos() const
+{
+    return _file_pos;
+}
+
+size_t FilePrefetcher::read(void* buffer, size_t buffer_size)
+{
+    if (nullptr == buffer)
+    {
+        throw std::invalid_argument("invalid buffer pointer");
+    }
+
+    return consume(buffer, buffer_size);
+}
+
+void FilePrefetcher::readAll(void* buffer, size_t buffer_size)
+{
+    if (read(buffer, buffer_size) != buffer_size)
+    {
+        throw std::runtime_error("end of file");
+    }
+}
+
+size_t FilePrefetcher::skip(size_t size)
+{
+    return consume(nullptr, size);
+}
+
+size_t FilePrefetcher::consume(void* buffer, size_t size)
+{
+    if (!isOpen())
+    {
+        throw std::runtime_error("file not opened");
+    }
+
+    uint8_t* destination = static_cast<uint8_t*>(buffer);
+    size_t consumed = 0;
+    while (consumed < size)
+    {
+        const uint8_t* source = nullptr;
+        size_t available = 0;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cond_filled.wait(lock, [&]() -> bool
+            {
+                return _filled > 0 || _end_of_file || _failed;
+            });
+
+            if (_filled == 0)
+            {
+                if (_failed)
+                {
+                    throw std::runtime_error("unable to read ahead");
+                }
+                break;
+            }
+
+            const Block& block = _blocks[_head];
+            source = block.data.data() + _head_offset;
+            available = std::min(block.size - _head_offset, size - consumed);
+        }
+
+        // the block is not touched by the read-ahead thread until we release it
+        if (destination)
+        {
+            a_util::memory::copy(destination + consumed, available, source, available);
+        }
+        consumed += available;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        const Block& block = _blocks[_head];
+        _head_offset += available;
+        _file_pos = block.file_pos + static_cast<FilePos>(_head_offset);
+        if (_head_offset == block.size)
+        {
+            _head = (_head + 1) % _blocks.size();
+            _head_offset = 0;
+            --_filled;
+            _cond_freed.notify_one();
+        }
+    }
+
+    return consumed;
+}
+
+FilePos FilePrefetcher::resolveJump(FilePos offset) const
+{
+    // jump targets are never resolved again, a target may well be the start of another jump
+    auto jump = _jumps.find(offset);
+    return jump == _jumps.end() ? offset : jump->second;
+}
+
+void FilePrefetcher::restart(FilePos offset)
+{
+    ++_generation;
+    _head = 0;
+    _head_offset = 0;
+    _filled = 0;
+    _file_pos = offset;
+    _prefetch_pos = offset;
+    _end_of_file = false;
+    _failed = false;
+    _cond_freed.notify_one();
+}
+
+void FilePrefetcher::prefetch()
+{
+    // position of the file handle, only used by this thread
+    FilePos handle_pos = 0;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;)
+    {
+        _cond_freed.wait(lock, [&]() -> bool
+        {
+            return _stop || (_filled < _blocks.size() && !_end_of_file && !_failed);
+        });
+
+        if (_stop)
+        {
+            break;
+        }
+
+        const uint64_t generation = _generation;
+        Block& block = _blocks[(_head + _filled) % _blocks.size()];
+        const FilePos read_pos = _prefetch_pos;
+
+        // do not read across a jump
+        size_t read_size = block.data.size();
+        auto next_jump = _jumps.upper_bound(read_pos);
+        if (next_jump != _jumps.end() && next_jump->first - read_pos < static_cast<FilePos>(read_size))
+        {
+            read_size = static_cast<size_t>(next_jump->first - read_pos);
+        }
+
+        lock.unlock();
+
+        size_t bytes_read = 0;
+        bool failed = false;
+        try
+        {
+            if (handle_pos != read_pos)
+            {
+                _file.setFilePos(read_pos, File::fp_begin);
+            }
+
+            while (bytes_read < read_size)
+            {
+                size_t bytes = _file.read(block.data.data() + bytes_read, read_size - bytes_read);
+                if (bytes == 0)
+                {
+                    break;
+                }
+                bytes_read += bytes;
+            }
+            handle_pos = read_pos + static_cast<FilePos>(bytes_read);
+        }
+        catch (...)
+        {
+            failed = true;
+            handle_pos = -1;
+        }
+
+        lock.lock();
+
+        if (generation != _generation)
+        {
+            // the reader has been repositioned in the meantime
+            continue;
+        }
+
+        if (failed)
+        {
+            _failed = true;
+        }
+        else if (bytes_read == 0)
+        {
+            _end_of_file = true;
+        }
+        else
+        {
+            block.file_pos = read_pos;
+            block.size = bytes_read;
+            _prefetch_pos = resolveJump(read_pos + static_cast<FilePos>(bytes_read));
+            ++_filled;
+        }
+
+        _cond_filled.notify_one();
+    }
+}
+
+} // namespace utils5ext
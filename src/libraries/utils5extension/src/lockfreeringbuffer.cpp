@@ -0,0 +1,168 @@
+/**
+ * @file
+ * Lock-free single producer single consumer ring buffer.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <utils5extension/utils5extension.h>
+
+namespace utils5ext
+{
+
+/// Every record starts with its size
+typedef uint64_t RecordSize;
+
+/// Marks the unused space at the end of the buffer in front of a wrapped record
+static const RecordSize wrap_marker = static_cast<RecordSize>(-1);
+
+static const size_t record_alignment = sizeof(RecordSize);
+
+static size_t alignRecord(size_t size)
+{
+    return (size + record_alignment - 1) & ~(record_alignment - 1);
+}
+
+LockFreeRingBuffer::LockFreeRingBuffer() :
+    _buffer(nullptr),
+    _capacity(0),
+    _head(0),
+    _tail(0)
+{
+}
+
+LockFreeRingBuffer::~LockFreeRingBuffer()
+{
+    free();
+}
+
+void LockFreeRingBuffer::allocate(size_t capacity)
+{
+    free();
+
+    _capacity = alignRecord(capacity);
+    if (_capacity < 2 * record_alignment)
+    {
+        throw std::invalid_argument("ring buffer capacity too small");
+    }
+
+    _buffer = new uint8_t[_capacity];
+    _head = 0;
+    _tail = 0;
+}
+
+void LockFreeRingBuffer::free()
+{
+    delete [] _buffer;
+    _buffer = nullptr;
+    _capacity = 0;
+    _head = 0;
+    _tail = 0;
+}
+
+size_t LockFreeRingBuffer::getCapacity() const
+{
+    return _capacity;
+}
+
+size_t LockFreeRingBuffer::getMaxRecordSize() const
+{
+    // an unallocated buffer does not take any records
+    return _capacity / 2 > sizeof(RecordSize) ? _capacity / 2 - sizeof(RecordSize) : 0;
+}
+
+bool LockFreeRingBuffer::tryPush(const void* header, size_t header_size, const void* data, size_t data_size)
+{
+    size_t record_size = alignRecord(sizeof(RecordSize) + header_size + data_size);
+    if (header_size + data_size > getMaxRecordSize())
+    {
+        throw std::invalid_argument("record does not fit into the ring buffer");
+    }
+
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    size_t head = _head.load(std::memory_order_acquire);
+
+    size_t offset = tail % _capacity;
+    size_t contiguous = _capacity - offset;
+
+    // records are never split, so we might have to skip the rest of the buffer
+    size_t required = record_size <= contiguous ? record_size : contiguous + record_size;
+    if (_capacity - (tail - head) < required)
+    {
+        return false;
+    }
+
+    if (record_size > contiguous)
+    {
+        *reinterpret_cast<RecordSize*>(_buffer + offset) = wrap_marker;
+        tail += contiguous;
+        offset = 0;
+    }
+
+    uint8_t* record = _buffer + offset;
+    *reinterpret_cast<RecordSize*>(record) = header_size + data_size;
+    a_util::memory::copy(record + sizeof(RecordSize), header_size, header, header_size);
+    if (data_size > 0)
+    {
+        a_util::memory::copy(record + sizeof(RecordSize) + header_size, data_size, data, data_size);
+    }
+
+    _tail.store(tail + record_size, std::memory_order_release);
+    return true;
+}
+
+const void* LockFreeRingBuffer::front(size_t* size)
+{
+    size_t head = _head.load(std::memory_order_relaxed);
+    size_t tail = _tail.load(std::memory_order_acquire);
+
+    if (head == tail)
+    {
+        return nullptr;
+    }
+
+    size_t offset = head % _capacity;
+    RecordSize record_size = *reinterpret_cast<const RecordSize*>(_buffer + offset);
+    if (record_size == wrap_marker)
+    {
+        // the producer has already written the wrapped record, so it is safe to skip
+        head += _capacity - offset;
+        _head.store(head, std::memory_order_release);
+        offset = 0;
+        record_size = *reinterpret_cast<const RecordSize*>(_buffer);
+    }
+
+    *size = static_cast<size_t>(record_size);
+    return _buffer + offset + sizeof(RecordSize);
+}
+
+void LockFreeRingBuffer::pop()
+{
+    size_t head = _head.load(std::memory_order_relaxed);
+    size_t offset = head % _capacity;
+    // front() has already skipped a wrap marker
+    RecordSize record_size = *reinterpret_cast<const RecordSize*>(_buffer + offset);
+
+    _head.store(head + alignRecord(sizeof(RecordSize) + static_cast<size_t>(record_size)),
+                std::memory_order_release);
+}
+
+bool LockFreeRingBuffer::isEmpty() const
+{
+    return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+}
+
+} // namespace utils5ext
@@ -0,0 +1,199 @@
+/**
+ * @file
+ * Read-only memory mapping of a file.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif // WIN32
+
+#include <utils5extension/utils5extension.h>
+
+namespace utils5ext
+{
+
+MemoryMappedFile::MemoryMappedFile() :
+    _data(nullptr),
+    _size(0)
+#ifdef WIN32
+    , _file(INVALID_HANDLE_VALUE),
+    _mapping(nullptr)
+#endif
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    unmap();
+}
+
+void MemoryMappedFile::map(const a_util::filesystem::Path& filename)
+{
+    unmap();
+
+#ifdef WIN32
+
+    _file = CreateFile(filename.toString().c_str(),
+                       GENERIC_READ,
+                       FILE_SHARE_READ | FILE_SHARE_WRITE,
+                       nullptr,
+                       OPEN_EXISTING,
+                       FILE_FLAG_SEQUENTIAL_SCAN,
+                       nullptr);
+    if (_file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("unable to open file " + filename.toString());
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(_file, &file_size) || file_size.QuadPart == 0)
+    {
+        unmap();
+        throw std::runtime_error("unable to map empty file " + filename.toString());
+    }
+
+    _mapping = CreateFileMapping(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping == nullptr)
+    {
+        unmap();
+        throw std::runtime_error("unable to map file " + filename.toString());
+    }
+
+    _data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr)
+    {
+        unmap();
+        throw std::runtime_error("unable to map file " + filename.toString());
+    }
+
+    _size = static_cast<FileSize>(file_size.QuadPart);
+
+#else // WIN32
+
+    int handle = ::open(filename.toString().c_str(), O_RDONLY);
+    if (handle < 0)
+    {
+        throw std::runtime_error("unable to open file " + filename.toString());
+    }
+
+    struct stat file_info;
+    if (fstat(handle, &file_info) != 0 || file_info.st_size == 0)
+    {
+        ::close(handle);
+        throw std::runtime_error("unable to map empty file " + filename.toString());
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(file_info.st_size), PROT_READ, MAP_SHARED, handle, 0);
+
+    // the mapping keeps its own reference to the file
+    ::close(handle);
+
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error("unable to map file " + filename.toString());
+    }
+
+    _data = static_cast<const uint8_t*>(data);
+    _size = static_cast<FileSize>(file_info.st_size);
+
+    adviseSequential(0, _size);
+
+#endif // WIN32
+}
+
+void MemoryMappedFile::unmap()
+{
+#ifdef WIN32
+
+    if (_data != nullptr)
+    {
+        UnmapViewOfFile(_data);
+    }
+
+    if (_mapping != nullptr)
+    {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+
+    if (_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+    }
+
+#else
+
+    if (_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(_data), static_cast<size_t>(_size));
+    }
+
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
+
+bool MemoryMappedFile::isMapped() const
+{
+    return _data != nullptr;
+}
+
+const uint8_t* MemoryMappedFile::getData() const
+{
+    return _data;
+}
+
+FileSize MemoryMappedFile::getSize() const
+{
+    return _size;
+}
+
+void MemoryMappedFile::adviseSequential(FilePos offset, FileSize size) const
+{
+#ifndef WIN32
+    if (_data == nullptr || offset >= _size)
+    {
+        return;
+    }
+
+    // madvise requires a page aligned start address
+    const FilePos page_size = static_cast<FilePos>(sysconf(_SC_PAGESIZE));
+    const FilePos aligned_offset = offset & ~(page_size - 1);
+    if (offset + size > _size)
+    {
+        size = _size - offset;
+    }
+
+    madvise(const_cast<uint8_t*>(_data) + aligned_offset,
+            static_cast<size_t>(size + (offset - aligned_offset)),
+            MADV_SEQUENTIAL);
+#else
+    (void) offset;
+    (void) size;
+#endif
+}
+
+} // namespace utils5ext
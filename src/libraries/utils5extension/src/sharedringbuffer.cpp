@@ -0,0 +1,500 @@
+/**
+ * @file
+ * Ring buffer in shared memory for local consumers of live data.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2017 Audi Electronics Venture GmbH. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <signal.h>
+#endif // WIN32
+
+#include <cerrno>
+#include <new>
+#include <utils5extension/utils5extension.h>
+
+namespace utils5ext
+{
+
+/// Every record starts with its size and its sequence number
+struct RecordPrefix
+{
+    uint64_t size;
+    uint64_t sequence;
+};
+
+/// Marks the unused space at the end of the buffer in front of a wrapped record
+static const uint64_t wrap_marker = static_cast<uint64_t>(-1);
+
+static const size_t record_alignment = sizeof(RecordPrefix);
+
+static const uint32_t shared_ring_buffer_id = 0x42525355; // "USRB"
+static const uint32_t shared_ring_buffer_version = 1;
+
+static size_t alignRecord(size_t size)
+{
+    return (size + record_alignment - 1) & ~(record_alignment - 1);
+}
+
+/**
+ * The start of the shared memory. The producer moves begin forward before it overwrites a
+ * record, so consumers detect overwritten data by checking begin after they have copied it.
+ */
+struct SharedRingBuffer::Header
+{
+    uint32_t              id;
+    uint32_t              version;
+    uint64_t              capacity;
+    uint64_t              producer_process_id;
+    uint8_t               padding_begin[40];
+    std::atomic<uint64_t> begin;            //!< Position of the oldest record (not wrapped)
+    uint8_t               padding_end[56];
+    std::atomic<uint64_t> end;              //!< Position behind the newest record (not wrapped)
+    uint8_t               padding_data[56];
+};
+
+SharedRingBuffer::SharedRingBuffer() :
+    _producer(false),
+    _memory(nullptr),
+    _memory_size(0),
+    _header(nullptr),
+    _buffer(nullptr),
+    _capacity(0),
+    _begin(0),
+    _end(0),
+    _sequence(0),
+    _lost(0)
+#ifdef WIN32
+    , _mapping(nullptr)
+#endif
+{
+}
+
+SharedRingBuffer::~SharedRingBuffer()
+{
+    close();
+}
+
+void SharedRingBuffer::create(const std::string& name, size_t capacity)
+{
+    close();
+
+    if (!std::atomic<uint64_t>().is_lock_free())
+    {
+        throw std::runtime_error("shared ring buffers are not supported on this platform");
+    }
+
+    const size_t aligned_capacity = alignRecord(capacity);
+    if (aligned_capacity < 4 * record_alignment)
+    {
+        throw std::invalid_argument("ring buffer capacity too small");
+    }
+    const size_t memory_size = alignRecord(sizeof(Header)) + aligned_capacity;
+
+#ifdef WIN32
+
+    _mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(static_cast<uint64_t>(memory_size) >> 32),
+                                  static_cast<DWORD>(memory_size & 0xFFFFFFFF),
+                                  ("Local\\" + name).c_str());
+    if (_mapping == nullptr || GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        close();
+        throw std::runtime_error("unable to create shared memory " + name);
+    }
+
+    _memory = static_cast<uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, memory_size));
+    if (_memory == nullptr)
+    {
+        close();
+        throw std::runtime_error("unable to map shared memory " + name);
+    }
+
+#else // WIN32
+
+    const std::string shm_name = "/" + name;
+    int handle = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (handle < 0 && errno == EEXIST)
+    {
+        if (isProducerRunning(shm_name))
+        {
+            throw std::runtime_error("shared memory " + name + " is in use by another producer");
+        }
+
+        // the previous producer crashed without removing its buffer
+        shm_unlink(shm_name.c_str());
+        handle = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (handle < 0)
+    {
+        throw std::runtime_error("unable to create shared memory " + name);
+    }
+
+    if (ftruncate(handle, static_cast<off_t>(memory_size)) != 0)
+    {
+        ::close(handle);
+        shm_unlink(shm_name.c_str());
+        throw std::runtime_error("unable to create shared memory " + name);
+    }
+
+    void* memory = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+
+    // the mapping keeps its own reference to the memory
+    ::close(handle);
+
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(shm_name.c_str());
+        throw std::runtime_error("unable to map shared memory " + name);
+    }
+
+    _memory = static_cast<uint8_t*>(memory);
+
+#endif // WIN32
+
+    _name = name;
+    _producer = true;
+    _memory_size = memory_size;
+    _header = new (_memory) Header();
+    _header->version = shared_ring_buffer_version;
+    _header->capacity = aligned_capacity;
+#ifdef WIN32
+    _header->producer_process_id = GetCurrentProcessId();
+#else
+    _header->producer_process_id = static_cast<uint64_t>(getpid());
+#endif
+    _buffer = _memory + alignRecord(sizeof(Header));
+    _capacity = aligned_capacity;
+
+    // consumers accept the buffer once the id is visible
+    std::atomic_thread_fence(std::memory_order_release);
+    _header->id = shared_ring_buffer_id;
+}
+
+#ifndef WIN32
+
+bool SharedRingBuffer::isProducerRunning(const std::string& shm_name)
+{
+    int handle = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (handle < 0)
+    {
+        // removed in the meantime
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(handle, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header))
+    {
+        // the producer crashed before it could initialize the header
+        ::close(handle);
+        return false;
+    }
+
+    void* memory = mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, handle, 0);
+    ::close(handle);
+    if (memory == MAP_FAILED)
+    {
+        // keep a buffer that we cannot inspect
+        return true;
+    }
+
+    const Header* header = static_cast<const Header*>(memory);
+    const bool valid = header->id == shared_ring_buffer_id;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const pid_t process_id = static_cast<pid_t>(header->producer_process_id);
+    munmap(memory, sizeof(Header));
+
+    if (!valid || process_id <= 0)
+    {
+        return false;
+    }
+
+    // EPERM means that the process exists but belongs to another user
+    return kill(process_id, 0) == 0 || errno == EPERM;
+}
+
+#endif // WIN32
+
+void SharedRingBuffer::open(const std::string& name)
+{
+    close();
+
+#ifdef WIN32
+
+    _mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, ("Local\\" + name).c_str());
+    if (_mapping == nullptr)
+    {
+        throw std::runtime_error("unable to open shared memory " + name);
+    }
+
+    _memory = static_cast<uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    MEMORY_BASIC_INFORMATION info;
+    if (_memory == nullptr || VirtualQuery(_memory, &info, sizeof(info)) == 0)
+    {
+        close();
+        throw std::runtime_error("unable to map shared memory " + name);
+    }
+    _memory_size = info.RegionSize;
+
+#else // WIN32
+
+    int handle = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+    if (handle < 0)
+    {
+        throw std::runtime_error("unable to open shared memory " + name);
+    }
+
+    struct stat info;
+    if (fstat(handle, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header))
+    {
+        ::close(handle);
+        throw std::runtime_error("unable to open shared memory " + name);
+    }
+
+    void* memory = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, handle, 0);
+    ::close(handle);
+
+    if (memory == MAP_FAILED)
+    {
+        throw std::runtime_error("unable to map shared memory " + name);
+    }
+
+    _memory = static_cast<uint8_t*>(memory);
+    _memory_size = static_cast<size_t>(info.st_size);
+
+#endif // WIN32
+
+    _header = reinterpret_cast<Header*>(_memory);
+    const bool valid = _header->id == shared_ring_buffer_id;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!valid ||
+        _header->version != shared_ring_buffer_version ||
+        _header->capacity > _memory_size - alignRecord(sizeof(Header)))
+    {
+        close();
+        throw std::runtime_error("invalid shared ring buffer " + name);
+    }
+
+    _name = name;
+    _buffer = _memory + alignRecord(sizeof(Header));
+    _capacity = static_cast<size_t>(_header->capacity);
+    _end = _header->end.load(std::memory_order_acquire);
+    // the sequence is unknown until the first record has been read
+    _sequence = std::numeric_limits<uint64_t>::max();
+}
+
+void SharedRingBuffer::close()
+{
+#ifdef WIN32
+
+    if (_memory != nullptr)
+    {
+        UnmapViewOfFile(_memory);
+    }
+
+    if (_mapping != nullptr)
+    {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+
+#else
+
+    if (_memory != nullptr)
+    {
+        munmap(_memory, _memory_size);
+    }
+
+    if (_producer)
+    {
+        shm_unlink(("/" + _name).c_str());
+    }
+
+#endif
+
+    _name.clear();
+    _producer = false;
+    _memory = nullptr;
+    _memory_size = 0;
+    _header = nullptr;
+    _buffer = nullptr;
+    _capacity = 0;
+    _begin = 0;
+    _end = 0;
+    _sequence = 0;
+    _lost = 0;
+}
+
+bool SharedRingBuffer::isOpen() const
+{
+    return _memory != nullptr;
+}
+
+size_t SharedRingBuffer::getMaxRecordSize() const
+{
+    return _capacity / 2 - sizeof(RecordPrefix);
+}
+
+void SharedRingBuffer::evict(uint64_t end)
+{
+    while (_begin < _end && end - _begin > _capacity)
+    {
+        const size_t offset = static_cast<size_t>(_begin % _capacity);
+        const uint64_t record_size = *reinterpret_cast<const uint64_t*>(_buffer + offset);
+        if (record_size == wrap_marker)
+        {
+            _begin += _capacity - offset;
+        }
+        else
+        {
+            _begin += alignRecord(sizeof(RecordPrefix) + static_cast<size_t>(record_size));
+        }
+    }
+}
+
+bool SharedRingBuffer::push(const Piece* pieces, size_t piece_count)
+{
+    size_t data_size = 0;
+    for (size_t piece = 0; piece < piece_count; ++piece)
+    {
+        data_size += pieces[piece].size;
+    }
+
+    if (data_size > getMaxRecordSize())
+    {
+        return false;
+    }
+
+    const size_t record_size = alignRecord(sizeof(RecordPrefix) + data_size);
+    const size_t offset = static_cast<size_t>(_end % _capacity);
+    const size_t contiguous = _capacity - offset;
+
+    // records are never split, so we might have to skip the rest of the buffer
+    uint64_t position = _end;
+    if (record_size > contiguous)
+    {
+        position += contiguous;
+    }
+
+    evict(position + record_size);
+    if (position + record_size - _begin > _capacity)
+    {
+        // all records have been evicted, including the wrap marker
+        _begin = position;
+    }
+
+    // consumers that copy from the range we are about to overwrite see the new begin afterwards
+    _header->begin.store(_begin, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (position != _end)
+    {
+        *reinterpret_cast<uint64_t*>(_buffer + offset) = wrap_marker;
+    }
+
+    uint8_t* record = _buffer + static_cast<size_t>(position % _capacity);
+    RecordPrefix prefix = { data_size, _sequence++ };
+    a_util::memory::copy(record, sizeof(prefix), &prefix, sizeof(prefix));
+
+    uint8_t* destination = record + sizeof(prefix);
+    for (size_t piece = 0; piece < piece_count; ++piece)
+    {
+        if (pieces[piece].size > 0)
+        {
+            a_util::memory::copy(destination, pieces[piece].size, pieces[piece].data, pieces[piece].size);
+            destination += pieces[piece].size;
+        }
+    }
+
+    _end = position + record_size;
+    _header->end.store(_end, std::memory_order_release);
+    return true;
+}
+
+bool SharedRingBuffer::pop(std::vector<uint8_t>& record)
+{
+    for (;;)
+    {
+        const uint64_t end = _header->end.load(std::memory_order_acquire);
+        if (_end == end)
+        {
+            return false;
+        }
+
+        const uint64_t begin = _header->begin.load(std::memory_order_acquire);
+        if (_end < begin)
+        {
+            // the producer has overwritten the records, they are counted via the sequence
+            _end = begin;
+            continue;
+        }
+
+        const size_t offset = static_cast<size_t>(_end % _capacity);
+        RecordPrefix prefix;
+        a_util::memory::copy(&prefix, sizeof(prefix), _buffer + offset, sizeof(prefix));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_header->begin.load(std::memory_order_relaxed) > _end)
+        {
+            continue;
+        }
+
+        if (prefix.size == wrap_marker)
+        {
+            _end += _capacity - offset;
+            continue;
+        }
+
+        if (prefix.size > getMaxRecordSize())
+        {
+            throw std::runtime_error("corrupt shared ring buffer " + _name);
+        }
+
+        record.resize(static_cast<size_t>(prefix.size));
+        if (!record.empty())
+        {
+            a_util::memory::copy(record.data(), record.size(), _buffer + offset + sizeof(prefix), record.size());
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_header->begin.load(std::memory_order_relaxed) > _end)
+        {
+            continue;
+        }
+
+        if (_sequence != std::numeric_limits<uint64_t>::max() && prefix.sequence > _sequence)
+        {
+            _lost += prefix.sequence - _sequence;
+        }
+        _sequence = prefix.sequence + 1;
+        _end += alignRecord(sizeof(RecordPrefix) + record.size());
+        return true;
+    }
+}
+
+uint64_t SharedRingBuffer::getLostRecordCount() const
+{
+    return _lost;
+}
+
+} // namespace utils5ext
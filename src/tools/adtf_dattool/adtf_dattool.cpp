@@ -234,6 +234,21 @@ or use:
 adtf_dattool --export source.adtfdat --extension attached_files | adtf_dattool --modify destination.adtfdat --extension attached_files
 
 to copy a explicit file extension of an existing ADTF DAT file to another.
+
+------------------------
+  REPAIRING:
+------------------------
+To rebuild the index of an ADTF DAT File that has not been closed or that has been truncated
+use the --repair argument. The file is modified in place, everything behind the last complete
+chunk is discarded. Before that, a copy of the file is stored next to it with the additional
+extension .bak, e.g. unclosed.adtfdat.bak, which replaces the copy of an earlier repair. Remove
+it once the repaired file has been checked. If the file has been written with an index journal,
+the index, the stream names and stream types are restored from it. Otherwise stream names, stream
+types and extensions are lost.
+
+Examples:
+---------
+adtf_dattool --repair unclosed.adtfdat
 )";
 
 std::string reformatHelpText(std::string text)
@@ -409,12 +424,14 @@ adtf_file::Extension find_required_extension(std::vector<adtf_file::Extension> e
 
 void processExportJob(const ExportJob& export_job,
                       std::function<bool(double)> progress_handler,
+                      size_t worker_queue_size,
                       const adtf::dat::ProcessorFactories& processor_factories)
 {
     auto reader = std::make_shared<adtf::dat::AdtfDatReader>();
     reader->open(export_job.file_name);
 
     adtf::dat::Demultiplexer demultiplexer(reader, processor_factories);
+    demultiplexer.setWorkerQueueSize(worker_queue_size);
 
     if (export_job.streams.empty() && export_job.extensions.empty())
     {
@@ -604,6 +621,19 @@ void processModificationJob(const ModificationJob& modification_job)
     }
 }
 
+void processRepairJob(const std::string& file_name)
+{
+    ifhd::v400::IndexedFileWriter writer;
+    if (a_util::filesystem::exists(ifhd::v400::IndexedFileWriter::getIndexJournalFileName(file_name)))
+    {
+        writer.recover(file_name);
+    }
+    else
+    {
+        writer.repair(file_name);
+    }
+}
+
 template<typename CONTAINER>
 void check_order(const CONTAINER& container, const std::string& argument, const std::string& required_argument)
 {
@@ -640,6 +670,7 @@ int main(int argc, char** argv) try
     bool show_usage = false;
     bool show_progress = false;
     bool skip_stream_types_and_triggers = false;
+    size_t worker_queue_size = 0;
     std::vector<std::string> plugins;
     std::vector<std::string> list_stream_sources;
     std::string extension_name;
@@ -647,6 +678,7 @@ int main(int argc, char** argv) try
     std::vector<ExportJob> export_jobs;
     std::vector<CreateJob> create_jobs;
     std::vector<ModificationJob> modification_jobs;
+    std::vector<std::string> repair_files;
 
     enum class Target
     {
@@ -668,8 +700,10 @@ int main(int argc, char** argv) try
         clara::Help(show_usage)|
         clara::Opt(show_progress)["--progress"]("Show progress.")|
         clara::Opt(skip_stream_types_and_triggers)["--skipstreamtypesandtriggers"]("Do not process stream types and triggers.")|
+        clara::Opt(worker_queue_size, "item count")["--workerqueuesize"]("Export every stream in its own thread, queueing up to the given number of items per stream.")|
         clara::Opt(plugins, "plugin")["--plugin"]("Load an additional plugin.")|
         clara::Opt(list_stream_sources, "file name")["--liststreams"]("List all available information about the given file.")|
+        clara::Opt(repair_files, "file name")["--repair"]("Rebuild the index of a file that has not been closed or that has been truncated, a copy of the original file is kept as <file name>.bak.")|
 
         MultiLambdaOpt([&](std::string file_name)
         {
@@ -970,6 +1004,11 @@ int main(int argc, char** argv) try
         adtf_file::getFactories<adtf_file::SampleSerializerFactories,
                                  adtf_file::SampleSerializerFactory>();
 
+    for (const auto& file_name: repair_files)
+    {
+        processRepairJob(file_name);
+    }
+
     for (const auto& source: list_stream_sources)
     {
         listSourceStreams(source, reader_factories, processor_factories);
@@ -979,6 +1018,7 @@ int main(int argc, char** argv) try
     {
         processExportJob(export_job,
                          progress_handler,
+                         worker_queue_size,
                          processor_factories);
     }
 
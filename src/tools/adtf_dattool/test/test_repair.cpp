@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include "dattool_helper.h"
+
+GTEST_TEST(dattool, repairTruncatedFile)
+{
+    using namespace ifhd::v400;
+    using namespace std::experimental::filesystem;
+
+    path source_file_path{TEST_SOURCE_DIR "/test_modify_extension.adtfdat"};
+    path temp_file_path{TEST_BUILD_DIR "/test_repair.adtfdat"};
+
+    // cut off the index and the extensions
+    FileHeader header;
+    getHeader(source_file_path.string(), header);
+    copy_file(source_file_path, temp_file_path, copy_options::overwrite_existing);
+    resize_file(temp_file_path, header.data_offset + header.data_size);
+
+    {
+        IndexedFileReader reader;
+        ASSERT_ANY_THROW(reader.open(temp_file_path.string()));
+    }
+
+    auto dattool_results = launchDatTool("--repair " + temp_file_path.string());
+    ASSERT_TRUE(dattool_results.second == 0 && dattool_results.first.empty());
+
+    IndexedFileReader source_reader;
+    source_reader.open(source_file_path.string());
+    IndexedFileReader repaired_reader;
+    repaired_reader.open(temp_file_path.string());
+    ASSERT_EQ(source_reader.getChunkCount(), repaired_reader.getChunkCount());
+
+    for (int64_t chunk_index = 0; chunk_index < source_reader.getChunkCount(); ++chunk_index)
+    {
+        ChunkHeader* source_chunk;
+        void* source_data;
+        source_reader.readNextChunk(&source_chunk, &source_data);
+        ChunkHeader* repaired_chunk;
+        void* repaired_data;
+        repaired_reader.readNextChunk(&repaired_chunk, &repaired_data);
+        ASSERT_EQ(source_chunk->time_stamp, repaired_chunk->time_stamp);
+        ASSERT_EQ(source_chunk->stream_id, repaired_chunk->stream_id);
+        ASSERT_EQ(source_chunk->size, repaired_chunk->size);
+        ASSERT_EQ(0, memcmp(source_data, repaired_data, source_chunk->size - sizeof(ChunkHeader)));
+    }
+}